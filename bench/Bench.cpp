@@ -0,0 +1,146 @@
+/// @file Bench.cpp
+#include "Bench.hpp"
+#include "Profiler/Profiler.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace ae2::bench {
+
+namespace {
+
+double nowNs() {
+    using namespace std::chrono;
+    return (double)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/// Значение числового поля "key": … в строке JSON; false — поля нет.
+bool field(const char* line, const char* key, double& out) {
+    char pat[48];
+    std::snprintf(pat, sizeof(pat), "\"%s\":", key);
+    const char* p = std::strstr(line, pat);
+    return p && std::sscanf(p + std::strlen(pat), "%lf", &out) == 1;
+}
+
+} // namespace
+
+Result measure(const std::string& name, const Case& fn, const Options& opt) {
+    Result r;
+    r.name = name;
+    fn();  /* прогрев: кэши, page cache фикстуры */
+
+    double best = 0;
+    for (uint32_t t = 0; t < opt.trials; ++t) {
+        uint64_t samples = 0;
+        Run last;
+        double t0 = nowNs();
+        double el = 0;
+        do {
+            last = fn();
+            samples += last.samples;
+            el = nowNs() - t0;
+        } while (el < opt.minMs * 1e6);
+
+        double ns = samples ? el / (double)samples : el;
+        if (t == 0 || ns < best) {
+            best = ns;
+            r.samples   = last.samples;
+            r.bytesRead = last.bytes;
+            r.xRealtime = last.rate ? (samples / (double)last.rate) / (el * 1e-9) : 0;
+        }
+    }
+    r.nsPerSample = best;
+    return r;
+}
+
+void printHeader() {
+    std::printf("%-44s %12s %12s %10s %10s\n", "case", "ns/sample", "x-realtime", "samples", "bytes");
+}
+
+void printResult(const Result& r) {
+    if (r.xRealtime > 0)
+        std::printf("%-44s %12.3f %12.1f %10llu %10llu\n", r.name.c_str(), r.nsPerSample,
+                    r.xRealtime, (unsigned long long)r.samples, (unsigned long long)r.bytesRead);
+    else
+        std::printf("%-44s %12.3f %12s %10llu %10llu\n", r.name.c_str(), r.nsPerSample, "-",
+                    (unsigned long long)r.samples, (unsigned long long)r.bytesRead);
+    std::fflush(stdout);
+}
+
+void printProfile() {
+    if (!Profiler::kEnabled) return;
+    const double us = 1e6 / Profiler::tickHz();
+    std::printf("   %-12s %9s %10s %10s %10s %10s %10s  (us)\n",
+                "scope", "count", "mean", "min", "p50<=", "p99<=", "max");
+    for (uint32_t i = 0; i < Profiler::kScopes; ++i) {
+        Profiler::Stats s = Profiler::stats((Profiler::Id)i);
+        if (s.count == 0) continue;
+        std::printf("   %-12s %9u %10.2f %10.2f %10.2f %10.2f %10.2f\n", s.name, s.count,
+                    s.mean() * us, s.min * us, s.percentileBound(50) * us,
+                    s.percentileBound(99) * us, s.max * us);
+    }
+}
+
+bool saveJson(const char* path, const std::vector<Result>& results) {
+    FILE* f = std::fopen(path, "w");
+    if (!f) return false;
+    std::fprintf(f, "[\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(f, "  {\"name\": \"%s\", \"ns_per_sample\": %.4f, \"x_realtime\": %.2f, "
+                        "\"samples\": %llu, \"bytes_read\": %llu}%s\n",
+                     r.name.c_str(), r.nsPerSample, r.xRealtime,
+                     (unsigned long long)r.samples, (unsigned long long)r.bytesRead,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "]\n");
+    return std::fclose(f) == 0;
+}
+
+bool loadJson(const char* path, std::vector<Result>& out) {
+    FILE* f = std::fopen(path, "r");
+    if (!f) return false;
+    char line[512];
+    while (std::fgets(line, sizeof(line), f)) {
+        const char* n = std::strstr(line, "\"name\": \"");
+        if (!n) continue;
+        n += 9;
+        const char* e = std::strchr(n, '"');
+        if (!e) continue;
+        Result r;
+        r.name.assign(n, (size_t)(e - n));
+        double v = 0;
+        if (!field(line, "ns_per_sample", r.nsPerSample)) continue;
+        if (field(line, "x_realtime", v)) r.xRealtime = v;
+        if (field(line, "samples", v))    r.samples = (uint64_t)v;
+        if (field(line, "bytes_read", v)) r.bytesRead = (uint64_t)v;
+        out.push_back(r);
+    }
+    std::fclose(f);
+    return true;
+}
+
+uint32_t compare(const std::vector<Result>& baseline, const std::vector<Result>& current,
+                 double thresholdPct) {
+    uint32_t regressions = 0;
+    std::printf("\n%-44s %12s %12s %8s\n", "case", "base ns", "now ns", "delta");
+    for (const Result& c : current) {
+        const Result* b = nullptr;
+        for (const Result& x : baseline)
+            if (x.name == c.name) { b = &x; break; }
+        if (!b || b->nsPerSample <= 0) {
+            std::printf("%-44s %12s %12.3f %8s\n", c.name.c_str(), "-", c.nsPerSample, "new");
+            continue;
+        }
+        double d = (c.nsPerSample / b->nsPerSample - 1.0) * 100.0;
+        bool bad = d > thresholdPct;
+        regressions += bad ? 1 : 0;
+        std::printf("%-44s %12.3f %12.3f %+7.1f%%%s\n", c.name.c_str(), b->nsPerSample,
+                    c.nsPerSample, d, bad ? "  REGRESSION" : "");
+    }
+    std::printf("\n%u regression(s) over %.1f%%\n", regressions, thresholdPct);
+    return regressions;
+}
+
+} // namespace ae2::bench
@@ -0,0 +1,57 @@
+#pragma once
+/// @file Bench.hpp
+/// @brief Хост-бенчмарки: замер кейса, таблица, JSON-базовая линия.
+///
+/// Только для хоста (std::chrono, std::string): в прошивку не линкуется.
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ae2::bench {
+
+/// Итог одного прогона кейса.
+struct Run {
+    uint64_t samples = 0;  ///< выходных сэмплов (или операций для не-аудио кейсов)
+    uint64_t bytes   = 0;  ///< байт входа, прочитанных из файла
+    uint32_t rate    = 0;  ///< частота выхода для x-realtime; 0 — не аудио
+};
+
+using Case = std::function<Run()>;
+
+struct Result {
+    std::string name;
+    double   nsPerSample = 0;  ///< нс на выходной сэмпл (на операцию, если rate == 0)
+    double   xRealtime   = 0;  ///< секунд аудио за секунду CPU; 0 — не аудио
+    uint64_t samples     = 0;  ///< за один прогон
+    uint64_t bytesRead   = 0;  ///< за один прогон
+};
+
+struct Options {
+    uint32_t    minMs  = 200;  ///< минимальное время одного замера
+    uint32_t    trials = 3;    ///< замеров; в отчёт идёт лучший
+    std::string filter;        ///< подстрока имени; пусто — все кейсы
+};
+
+/// Прогонять fn, пока не наберётся opt.minMs; из opt.trials замеров
+/// взять лучший (меньше всего шума от планировщика).
+Result measure(const std::string& name, const Case& fn, const Options& opt);
+
+void printHeader();
+void printResult(const Result& r);
+
+/// Таблица встроенного профайлера (AE2_PROFILER), пустые скоупы пропускаются.
+void printProfile();
+
+/// Записать результаты; одна запись на строку — diff базовых линий читаем.
+bool saveJson(const char* path, const std::vector<Result>& results);
+/// Прочитать файл, записанный saveJson.
+bool loadJson(const char* path, std::vector<Result>& out);
+
+/// Сравнить с базовой линией по ns/sample. Кейс медленнее больше чем на
+/// thresholdPct — регрессия. Возвращает число регрессий.
+uint32_t compare(const std::vector<Result>& baseline, const std::vector<Result>& current,
+                 double thresholdPct);
+
+} // namespace ae2::bench
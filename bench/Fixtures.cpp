@@ -0,0 +1,565 @@
+/// @file Fixtures.cpp
+#include "Fixtures.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+namespace ae2::bench {
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+void put16(Bytes& b, uint16_t v) { b.push_back((uint8_t)v); b.push_back((uint8_t)(v >> 8)); }
+void put32(Bytes& b, uint32_t v) { put16(b, (uint16_t)v); put16(b, (uint16_t)(v >> 16)); }
+void putTag(Bytes& b, const char* t) { for (int i = 0; i < 4; ++i) b.push_back((uint8_t)t[i]); }
+
+/* xorshift32: одинаковый поток на всех платформах */
+struct Rng {
+    uint32_t s = 0x9E3779B9u;
+    uint32_t next() { s ^= s << 13; s ^= s >> 17; s ^= s << 5; return s; }
+};
+
+/// Тон + немного шума: residual FLAC и PCM не вырождены.
+int32_t tone(uint32_t i, uint32_t rate, double hz, Rng& rng) {
+    constexpr double kPi = 3.14159265358979323846;
+    double v = std::sin(2.0 * kPi * hz * i / rate) * 8000.0;
+    return (int32_t)v + (int32_t)(rng.next() & 127) - 64;
+}
+
+/// RIFF/WAVE: fmt (как есть) + data.
+Bytes wav(const Bytes& fmt, const Bytes& data) {
+    Bytes b;
+    b.reserve(20 + fmt.size() + data.size());
+    putTag(b, "RIFF");
+    put32(b, (uint32_t)(4 + 8 + fmt.size() + 8 + data.size()));
+    putTag(b, "WAVE");
+    putTag(b, "fmt ");
+    put32(b, (uint32_t)fmt.size());
+    b.insert(b.end(), fmt.begin(), fmt.end());
+    putTag(b, "data");
+    put32(b, (uint32_t)data.size());
+    b.insert(b.end(), data.begin(), data.end());
+    return b;
+}
+
+Bytes fmtChunk(uint16_t tag, uint16_t ch, uint32_t rate, uint32_t byteRate,
+               uint16_t blockAlign, uint16_t bits) {
+    Bytes f;
+    put16(f, tag); put16(f, ch); put32(f, rate); put32(f, byteRate);
+    put16(f, blockAlign); put16(f, bits);
+    return f;
+}
+
+Bytes pcmWav(uint16_t ch, uint32_t rate, uint16_t bits, bool isFloat, uint32_t seconds) {
+    Rng rng;
+    const uint32_t frames = rate * seconds;
+    const uint16_t bpsmp  = bits / 8;
+    Bytes data;
+    data.reserve((size_t)frames * ch * bpsmp);
+    for (uint32_t i = 0; i < frames; ++i) {
+        for (uint16_t c = 0; c < ch; ++c) {
+            int32_t s = tone(i, rate, 440.0 * (c + 1), rng);
+            if (isFloat) {
+                float v = (float)s / 32768.0f;
+                uint32_t u;
+                std::memcpy(&u, &v, 4);
+                put32(data, u);
+            } else if (bits == 8) {
+                data.push_back((uint8_t)((s >> 8) + 128));
+            } else if (bits == 24) {
+                int32_t v = s * 256;
+                data.push_back((uint8_t)v); data.push_back((uint8_t)(v >> 8));
+                data.push_back((uint8_t)(v >> 16));
+            } else {
+                put16(data, (uint16_t)s);
+            }
+        }
+    }
+    uint16_t align = (uint16_t)(ch * bpsmp);
+    return wav(fmtChunk(isFloat ? 3 : 1, ch, rate, rate * align, align, bits), data);
+}
+
+Bytes imaWav(uint16_t ch, uint32_t rate, uint32_t seconds) {
+    Rng rng;
+    const uint16_t align = 2048;
+    const uint16_t spb   = (uint16_t)((align - 4 * ch) * 8 / (4 * ch) + 1);
+    const uint32_t blocks = (rate * seconds + spb - 1) / spb;
+    Bytes data;
+    for (uint32_t b = 0; b < blocks; ++b) {
+        for (uint16_t c = 0; c < ch; ++c) { put16(data, 0); data.push_back(20); data.push_back(0); }
+        for (uint32_t i = 4u * ch; i < align; ++i) data.push_back((uint8_t)rng.next());
+    }
+    Bytes f = fmtChunk(0x11, ch, rate, rate * align / spb, align, 4);
+    put16(f, 2);
+    put16(f, spb);
+    return wav(f, data);
+}
+
+Bytes msAdpcmWav(uint16_t ch, uint32_t rate, uint32_t seconds) {
+    static const int16_t kCoef[7][2] = {
+        {256, 0}, {512, -256}, {0, 0}, {192, 64}, {240, 0}, {460, -208}, {392, -232}};
+    Rng rng;
+    const uint16_t align = 2048;
+    const uint16_t spb   = (uint16_t)((align - 7 * ch) * 2 / ch + 2);
+    const uint32_t blocks = (rate * seconds + spb - 1) / spb;
+    Bytes data;
+    for (uint32_t b = 0; b < blocks; ++b) {
+        for (uint16_t c = 0; c < ch; ++c) data.push_back((uint8_t)(b % 7));  /* предиктор */
+        for (uint16_t c = 0; c < ch; ++c) put16(data, 64);                   /* delta */
+        for (uint16_t c = 0; c < ch; ++c) put16(data, 0);                    /* samp1 */
+        for (uint16_t c = 0; c < ch; ++c) put16(data, 0);                    /* samp2 */
+        for (uint32_t i = 7u * ch; i < align; ++i) data.push_back((uint8_t)rng.next());
+    }
+    Bytes f = fmtChunk(0x0002, ch, rate, rate * align / spb, align, 4);
+    put16(f, 32);
+    put16(f, spb);
+    put16(f, 7);
+    for (const auto& k : kCoef) { put16(f, (uint16_t)k[0]); put16(f, (uint16_t)k[1]); }
+    return wav(f, data);
+}
+
+Bytes g711Wav(uint16_t tag, uint16_t ch, uint32_t rate, uint32_t seconds) {
+    Rng rng;
+    Bytes data((size_t)rate * seconds * ch);
+    for (auto& b : data) b = (uint8_t)rng.next();
+    return wav(fmtChunk(tag, ch, rate, rate * ch, ch, 8), data);
+}
+
+struct BitWriter {
+    Bytes    out;
+    uint64_t acc  = 0;
+    uint32_t bits = 0;
+
+    void put(uint32_t v, uint32_t n) {
+        for (uint32_t i = n; i-- > 0; ) {
+            acc = (acc << 1) | ((v >> i) & 1u);
+            if (++bits == 8) { out.push_back((uint8_t)acc); acc = 0; bits = 0; }
+        }
+    }
+    void align() { if (bits) put(0, 8 - bits); }
+};
+
+/// MPEG-1 Layer III, 128 кбит/с, 44.1 кГц, стерео, без CRC.
+///
+/// Звук — по одной спектральной линии на канал (тон ~400 и ~600 Гц). Обе
+/// гранулы каждого канала: big_values = 0, scalefac_compress = 0, вся
+/// ненулевая часть — count1-область с таблицей B (quadruple vwxy — 4 бита
+/// ~vwxy, за ним знаки ненулевых). Линия 1 при global_gain g — амплитуда
+/// 2^((g - 210) / 4) до синтеза, знак чередуется по гранулам.
+/// main_data_begin = 0 (без bit reservoir), хвост кадра — нули.
+Bytes mp3(uint32_t seconds) {
+    constexpr uint32_t kLine[2] = {10, 15};   /* (k + 0.5) * 22050 / 576 Гц */
+    constexpr uint32_t kGain    = 202;
+    const uint32_t frames = seconds * 44100 / 1152;
+
+    /* Биты count1-области канала: нулевые quadruple до линии, затем её */
+    auto count1 = [](BitWriter& w, uint32_t line, uint32_t neg) {
+        for (uint32_t q = 0; q < line / 4; ++q) w.put(0xF, 4);
+        const uint32_t v = 8u >> (line % 4);
+        w.put(0xF ^ v, 4);
+        w.put(neg, 1);
+    };
+    auto count1Bits = [](uint32_t line) { return ((line / 4) * 4) + 4 + 1; };
+
+    Bytes b;
+    for (uint32_t f = 0; f < frames; ++f) {
+        /* Padding по схеме энкодера: средний размер кадра 417.96 байт */
+        bool pad = ((f + 1) * 128000u * 144u / 44100u) - (f * 128000u * 144u / 44100u) > 417;
+        uint32_t size = 417 + (pad ? 1 : 0);
+
+        BitWriter w;
+        w.put(0xFFFB, 16);
+        w.put(0x90 | (pad ? 0x02 : 0), 8);
+        w.put(0x00, 8);                 /* stereo, без emphasis */
+
+        w.put(0, 9);                    /* main_data_begin */
+        w.put(0, 3);                    /* private_bits */
+        w.put(0, 8);                    /* scfsi × 2 канала */
+        for (uint32_t gr = 0; gr < 2; ++gr) {
+            for (uint32_t ch = 0; ch < 2; ++ch) {
+                w.put(count1Bits(kLine[ch]), 12);  /* part2_3_length */
+                w.put(0, 9);            /* big_values */
+                w.put(kGain, 8);
+                w.put(0, 4);            /* scalefac_compress: slen 0/0 */
+                w.put(0, 1);            /* длинные блоки */
+                w.put(0, 15);           /* table_select × 3 */
+                w.put(0, 4);            /* region0_count */
+                w.put(0, 3);            /* region1_count */
+                w.put(0, 1);            /* preflag */
+                w.put(0, 1);            /* scalefac_scale */
+                w.put(1, 1);            /* count1table_select: таблица B */
+            }
+        }
+        for (uint32_t gr = 0; gr < 2; ++gr)
+            for (uint32_t ch = 0; ch < 2; ++ch) count1(w, kLine[ch], gr);
+        w.align();
+        w.out.resize(size, 0);
+        b.insert(b.end(), w.out.begin(), w.out.end());
+    }
+    return b;
+}
+
+/* ── FLAC ── */
+
+uint8_t crc8(const uint8_t* p, size_t n) {
+    uint32_t crc = 0;
+    while (n--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; ++i) crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) : (crc << 1);
+        crc &= 0xFF;
+    }
+    return (uint8_t)crc;
+}
+
+uint16_t crc16(const uint8_t* p, size_t n) {
+    uint32_t crc = 0;
+    while (n--) {
+        crc ^= (uint32_t)*p++ << 8;
+        for (int i = 0; i < 8; ++i) crc = (crc & 0x8000) ? ((crc << 1) ^ 0x8005) : (crc << 1);
+        crc &= 0xFFFF;
+    }
+    return (uint16_t)crc;
+}
+
+void putUtf8(BitWriter& w, uint32_t v) {
+    if (v < 0x80)       { w.put(v, 8); return; }
+    if (v < 0x800)      { w.put(0xC0 | (v >> 6), 8); w.put(0x80 | (v & 0x3F), 8); return; }
+    w.put(0xE0 | (v >> 12), 8); w.put(0x80 | ((v >> 6) & 0x3F), 8); w.put(0x80 | (v & 0x3F), 8);
+}
+
+/// Как кодировать FLAC-фикстуру. Частота — 44.1 кГц, блок — 4096.
+struct FlacSpec {
+    enum class Kind : uint8_t { Fixed2, Lpc, Verbatim };
+    uint32_t bps       = 16;
+    uint32_t chCode    = 1;      ///< каналы кадра: 0 — моно, 1 — L/R, 8/9/10 — left/right/mid-side
+    Kind     kind      = Kind::Fixed2;
+    uint32_t order     = 8;      ///< LPC: порядок
+    uint32_t precision = 12;     ///< LPC: бит на коэффициент
+    bool     escape    = false;  ///< нечётные партиции Rice — сырыми отсчётами
+    uint32_t seekEvery = 0;      ///< точка SEEKTABLE на каждые N кадров; 0 — без таблицы
+};
+
+/// Residual: Rice с разбиением на 2^po частей; параметр больше 14 — RICE2
+/// (5 бит). escape — нечётные партиции через escape-код и ширину отсчёта.
+void residual(BitWriter& w, const int32_t* r, uint32_t n, uint32_t order, bool escape) {
+    const uint32_t po   = (n % 16 == 0) ? 4 : 0;
+    const uint32_t part = n >> po;
+    auto zigzag = [](int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); };
+
+    uint32_t ks[16];
+    uint32_t kMax = 0;
+    for (uint32_t p = 0; p < (1u << po); ++p) {
+        const uint32_t from = std::max(p * part, order), to = (p + 1) * part;
+        uint64_t sum = 0;
+        for (uint32_t i = from; i < to; ++i) sum += zigzag(r[i]);
+        const uint64_t mean = to > from ? sum / (to - from) : 0;
+        uint32_t k = 0;
+        while (k < 30 && (mean >> (k + 1)) > 0) k++;
+        ks[p] = k;
+        kMax  = std::max(kMax, k);
+    }
+    const uint32_t method = kMax > 14 ? 1 : 0;
+    const uint32_t pbits  = method ? 5 : 4;
+
+    w.put(method, 2);
+    w.put(po, 4);
+    for (uint32_t p = 0; p < (1u << po); ++p) {
+        const uint32_t from = std::max(p * part, order), to = (p + 1) * part;
+        if (escape && (p & 1)) {
+            uint32_t width = 0;
+            for (uint32_t i = from; i < to; ++i) {
+                const uint32_t m = (uint32_t)(r[i] < 0 ? ~r[i] : r[i]);
+                if (r[i] != 0) width = std::max(width, 33u - (uint32_t)__builtin_clz(m | 1));
+            }
+            w.put((1u << pbits) - 1, pbits);
+            w.put(width, 5);
+            for (uint32_t i = from; i < to; ++i) w.put((uint32_t)r[i] & ((1u << width) - 1), width);
+            continue;
+        }
+        const uint32_t k = ks[p];
+        w.put(k, pbits);
+        for (uint32_t i = from; i < to; ++i) {
+            const uint32_t u = zigzag(r[i]);
+            for (uint32_t q = u >> k; q > 0; --q) w.put(0, 1);
+            w.put(1, 1);
+            if (k) w.put(u & ((1u << k) - 1), k);
+        }
+    }
+}
+
+/// LPC блока: Левинсон — Дарбин по автокорреляции, коэффициенты
+/// квантуются в precision бит со сдвигом shift (≤ 15).
+void lpcCoefs(const int32_t* x, uint32_t n, uint32_t order, uint32_t precision,
+              int32_t* qlp, uint32_t& shift) {
+    double ac[33] = {};
+    for (uint32_t lag = 0; lag <= order; ++lag)
+        for (uint32_t i = lag; i < n; ++i) ac[lag] += (double)x[i] * x[i - lag];
+    double a[33] = {}, prev[33] = {};
+    double err = ac[0];
+    for (uint32_t i = 1; i <= order && err > 0; ++i) {
+        double acc = ac[i];
+        for (uint32_t j = 1; j < i; ++j) acc -= prev[j] * ac[i - j];
+        const double k = acc / err;
+        a[i] = k;
+        for (uint32_t j = 1; j < i; ++j) a[j] = prev[j] - k * prev[i - j];
+        err *= 1.0 - k * k;
+        std::copy(a, a + i + 1, prev);
+    }
+
+    double cmax = 0;
+    for (uint32_t j = 1; j <= order; ++j) cmax = std::max(cmax, std::fabs(a[j]));
+    int e = 0;
+    std::frexp(cmax, &e);
+    shift = (uint32_t)std::min(std::max((int)precision - 1 - e, 0), 15);
+    const int32_t lim = (1 << (precision - 1)) - 1;
+    for (uint32_t j = 0; j < order; ++j)
+        qlp[j] = std::min(std::max((int32_t)std::lround(a[j + 1] * (1 << shift)), -lim), lim);
+}
+
+/// Субкадр: CONSTANT, если блок из одного значения; иначе wasted bits по
+/// общим нулевым младшим битам и FIXED order 2 / LPC / VERBATIM из spec.
+void subframe(BitWriter& w, const int32_t* x, uint32_t n, uint32_t bps, const FlacSpec& spec) {
+    if (std::all_of(x, x + n, [&](int32_t v) { return v == x[0]; })) {
+        w.put(0, 8);
+        w.put((uint32_t)x[0] & ((1u << bps) - 1), bps);
+        return;
+    }
+    uint32_t any = 0;
+    for (uint32_t i = 0; i < n; ++i) any |= (uint32_t)x[i];
+    const uint32_t wasted = (uint32_t)__builtin_ctz(any);
+    std::vector<int32_t> v(x, x + n);
+    for (auto& s : v) s >>= wasted;
+    bps -= wasted;
+    const uint32_t mask = (bps < 32) ? (1u << bps) - 1 : ~0u;
+
+    uint32_t type = 1;
+    if (spec.kind == FlacSpec::Kind::Fixed2) type = 0x08 | 2;
+    if (spec.kind == FlacSpec::Kind::Lpc)    type = 0x20 | (spec.order - 1);
+    w.put(0, 1);
+    w.put(type, 6);
+    w.put(wasted ? 1 : 0, 1);
+    if (wasted) { w.put(0, wasted - 1); w.put(1, 1); }
+
+    if (spec.kind == FlacSpec::Kind::Verbatim) {
+        for (uint32_t i = 0; i < n; ++i) w.put((uint32_t)v[i] & mask, bps);
+        return;
+    }
+    const uint32_t order = spec.kind == FlacSpec::Kind::Lpc ? spec.order : 2;
+    for (uint32_t i = 0; i < order; ++i) w.put((uint32_t)v[i] & mask, bps);
+
+    std::vector<int32_t> r(n);
+    if (spec.kind == FlacSpec::Kind::Fixed2) {
+        for (uint32_t i = 2; i < n; ++i) r[i] = v[i] - 2 * v[i - 1] + v[i - 2];
+    } else {
+        int32_t  qlp[32];
+        uint32_t shift = 0;
+        lpcCoefs(v.data(), n, order, spec.precision, qlp, shift);
+        w.put(spec.precision - 1, 4);
+        w.put(shift, 5);
+        for (uint32_t j = 0; j < order; ++j)
+            w.put((uint32_t)qlp[j] & ((1u << spec.precision) - 1), spec.precision);
+        for (uint32_t i = order; i < n; ++i) {
+            int64_t sum = 0;
+            for (uint32_t j = 0; j < order; ++j) sum += (int64_t)qlp[j] * v[i - 1 - j];
+            r[i] = v[i] - (int32_t)(sum >> shift);
+        }
+    }
+    residual(w, r.data(), n, order, spec.escape);
+}
+
+/// FLAC 44.1 кГц, блок 4096: ch — один (моно) или два канала отсчётов
+/// spec.bps бит; стерео раскладывается по spec.chCode.
+Bytes flacEncode(const std::vector<std::vector<int32_t>>& ch, const FlacSpec& spec) {
+    const uint32_t rate = 44100, block = 4096;
+    const uint32_t total = (uint32_t)ch[0].size();
+    const uint32_t nch   = (uint32_t)ch.size();
+
+    /* Кадры — отдельно: SEEKTABLE перед ними ссылается на их смещения */
+    BitWriter frames;
+    std::vector<std::pair<uint32_t, uint32_t>> points;  /* сэмпл, смещение */
+    std::vector<int32_t> a(block), b(block);
+    for (uint32_t f = 0, pos = 0; pos < total; ++f, pos += block) {
+        const uint32_t n = std::min(block, total - pos);
+        if (spec.seekEvery && f % spec.seekEvery == 0) points.push_back({pos, (uint32_t)frames.out.size()});
+        BitWriter w;
+        w.put(0xFFF8, 16);
+        w.put(7, 4);            /* размер блока: 16 бит в конце заголовка */
+        w.put(9, 4);            /* 44.1 кГц */
+        w.put(spec.chCode, 4);
+        w.put(spec.bps == 24 ? 6 : 4, 3);
+        w.put(0, 1);
+        putUtf8(w, f);
+        w.put(n - 1, 16);
+        w.put(crc8(w.out.data(), w.out.size()), 8);
+
+        const int32_t* l = ch[0].data() + pos;
+        const int32_t* r = nch > 1 ? ch[1].data() + pos : nullptr;
+        uint32_t bpsA = spec.bps, bpsB = spec.bps;
+        for (uint32_t i = 0; i < n && r; ++i) {
+            switch (spec.chCode) {
+                case 8:  a[i] = l[i];              b[i] = l[i] - r[i]; break;
+                case 9:  a[i] = l[i] - r[i];       b[i] = r[i];        break;
+                case 10: a[i] = (l[i] + r[i]) >> 1; b[i] = l[i] - r[i]; break;
+                default: a[i] = l[i];              b[i] = r[i];        break;
+            }
+        }
+        if (spec.chCode == 9) bpsA++;
+        if (spec.chCode == 8 || spec.chCode == 10) bpsB++;
+        if (!r) {
+            subframe(w, l, n, spec.bps, spec);
+        } else {
+            subframe(w, a.data(), n, bpsA, spec);
+            subframe(w, b.data(), n, bpsB, spec);
+        }
+        w.align();
+        w.put(crc16(w.out.data(), w.out.size()), 16);
+        frames.out.insert(frames.out.end(), w.out.begin(), w.out.end());
+    }
+
+    BitWriter w;
+    w.put('f', 8); w.put('L', 8); w.put('a', 8); w.put('C', 8);
+    w.put(points.empty() ? 1 : 0, 1); w.put(0, 7); w.put(34, 24);  /* STREAMINFO */
+    w.put(block, 16); w.put(block, 16);
+    w.put(0, 24); w.put(0, 24);
+    w.put(rate, 20); w.put(nch - 1, 3); w.put(spec.bps - 1, 5);
+    w.put(0, 4); w.put(total, 32);                 /* 36 бит total samples */
+    for (int i = 0; i < 16; ++i) w.put(0, 8);      /* MD5 не считаем */
+    if (!points.empty()) {
+        /* SEEKTABLE, последний блок; в конце — placeholder */
+        w.put(1, 1); w.put(3, 7); w.put((uint32_t)(points.size() + 1) * 18, 24);
+        for (const auto& p : points) {
+            w.put(0, 32); w.put(p.first, 32);
+            w.put(0, 32); w.put(p.second, 32);
+            w.put(std::min(block, total - p.first), 16);
+        }
+        for (int i = 0; i < 8; ++i) w.put(0xFF, 8);
+        for (int i = 0; i < 10; ++i) w.put(0, 8);
+    }
+    w.out.insert(w.out.end(), frames.out.begin(), frames.out.end());
+    return w.out;
+}
+
+/// FLAC 16 бит стерео 44.1 кГц, блок 4096, каналы независимые, fixed order 2.
+Bytes flac(uint32_t seconds) {
+    const uint32_t total = 44100 * seconds;
+    Rng rng;
+    std::vector<std::vector<int32_t>> ch(2, std::vector<int32_t>(total));
+    for (uint32_t i = 0; i < total; ++i) {
+        ch[0][i] = tone(i, 44100, 440.0, rng);
+        ch[1][i] = tone(i, 44100, 660.0, rng);
+    }
+    return flacEncode(ch, FlacSpec{});
+}
+
+bool writeFile(const std::string& path, const Bytes& b) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(b.data(), 1, b.size(), f) == b.size();
+    return (std::fclose(f) == 0) && ok;
+}
+
+bool isAudio(const char* name) {
+    const char* dot = std::strrchr(name, '.');
+    if (!dot) return false;
+    for (const char* e : {".mp3", ".wav", ".flac", ".alaw", ".ulaw"})
+        if (!strcasecmp(dot, e)) return true;
+    return false;
+}
+
+} // namespace
+
+std::vector<Fixture> writeSynthetic(const std::string& dir, uint32_t seconds) {
+    mkdir(dir.c_str(), 0755);
+    const std::pair<const char*, Bytes> files[] = {
+        {"pcm16-mono-44k.wav",     pcmWav(1, 44100, 16, false, seconds)},
+        {"pcm16-stereo-44k.wav",   pcmWav(2, 44100, 16, false, seconds)},
+        {"pcm8-mono-22k.wav",      pcmWav(1, 22050, 8, false, seconds)},
+        {"pcm24-stereo-48k.wav",   pcmWav(2, 48000, 24, false, seconds)},
+        {"f32-stereo-48k.wav",     pcmWav(2, 48000, 32, true, seconds)},
+        {"ima-stereo-44k.wav",     imaWav(2, 44100, seconds)},
+        {"msadpcm-stereo-44k.wav", msAdpcmWav(2, 44100, seconds)},
+        {"alaw-mono-8k.wav",       g711Wav(6, 1, 8000, seconds)},
+        {"ulaw-stereo-8k.wav",     g711Wav(7, 2, 8000, seconds)},
+        {"mp3-128k-stereo-44k.mp3", mp3(seconds)},
+        {"flac-stereo-44k.flac",   flac(seconds)},
+    };
+    std::vector<Fixture> out;
+    for (const auto& f : files) {
+        std::string path = dir + "/" + f.first;
+        if (!writeFile(path, f.second)) return {};
+        std::string name = f.first;
+        out.push_back({name.substr(0, name.rfind('.')), path});
+    }
+    return out;
+}
+
+std::vector<FlacCase> writeFlacCases(const std::string& dir) {
+    using Kind = FlacSpec::Kind;
+    struct Def {
+        const char* name;
+        uint32_t    seconds;
+        FlacSpec    spec;
+    };
+    /* bps + precision + log2(order) > 32 — сумма LPC в 64 битах */
+    const Def defs[] = {
+        {"flac-lpc-mono16",      1, {16, 0,  Kind::Lpc,      8, 12, false, 0}},
+        {"flac-lpc-wide-mono24", 1, {24, 0,  Kind::Lpc,      8, 12, false, 0}},
+        {"flac-lpc-wide-ms",     1, {16, 10, Kind::Lpc,      8, 15, false, 0}},
+        {"flac-lpc-rs",          1, {16, 9,  Kind::Lpc,      8, 12, false, 0}},
+        {"flac-fixed-ls",        1, {16, 8,  Kind::Fixed2,   8, 12, false, 0}},
+        {"flac-const-verbatim",  1, {16, 1,  Kind::Verbatim, 8, 12, false, 0}},
+        {"flac-wasted",          1, {16, 1,  Kind::Fixed2,   8, 12, false, 0}},
+        {"flac-escape",          1, {16, 0,  Kind::Fixed2,   8, 12, true,  0}},
+        {"flac-seektable",       3, {16, 1,  Kind::Fixed2,   8, 12, false, 4}},
+    };
+
+    mkdir(dir.c_str(), 0755);
+    std::vector<FlacCase> out;
+    for (const Def& d : defs) {
+        const uint32_t total = 44100 * d.seconds;
+        const uint32_t nch   = d.spec.chCode == 0 ? 1 : 2;
+        const std::string name = d.name;
+        Rng rng;
+        std::vector<std::vector<int32_t>> ch(nch, std::vector<int32_t>(total));
+        for (uint32_t i = 0; i < total; ++i) {
+            int32_t l = tone(i, 44100, 440.0, rng);
+            int32_t r = tone(i, 44100, 660.0, rng);
+            if (d.spec.bps == 24) l = (l * 256) + (int32_t)(rng.next() & 255);
+            if (name == "flac-const-verbatim") l = 1000;
+            if (name == "flac-wasted") { l &= ~3; r &= ~7; }
+            ch[0][i] = l;
+            if (nch > 1) ch[1][i] = r;
+        }
+
+        FlacCase c;
+        c.name = name;
+        c.path = dir + "/" + name + ".flac";
+        c.pcm.resize(total);
+        for (uint32_t i = 0; i < total; ++i)
+            c.pcm[i] = (int16_t)(nch > 1 ? (ch[0][i] + ch[1][i]) >> 1 : ch[0][i] >> (d.spec.bps - 16));
+        if (!writeFile(c.path, flacEncode(ch, d.spec))) return {};
+        out.push_back(std::move(c));
+    }
+    return out;
+}
+
+std::vector<Fixture> listDir(const std::string& dir) {
+    std::vector<Fixture> out;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return out;
+    while (struct dirent* de = readdir(d)) {
+        if (de->d_name[0] == '.' || !isAudio(de->d_name)) continue;
+        out.push_back({std::string("file:") + de->d_name, dir + "/" + de->d_name});
+    }
+    closedir(d);
+    std::sort(out.begin(), out.end(), [](const Fixture& a, const Fixture& b) { return a.name < b.name; });
+    return out;
+}
+
+} // namespace ae2::bench
@@ -0,0 +1,40 @@
+#pragma once
+/// @file Fixtures.hpp
+/// @brief Синтетические фикстуры для бенчмарков: по файлу на формат.
+///
+/// Содержимое детерминировано (фиксированный seed), поэтому прогоны на
+/// разных машинах сравнимы. Заголовки корректны; payload ADPCM/G.711 —
+/// псевдослучайный (скорость декодера от содержимого почти не зависит),
+/// FLAC кодируется честно (fixed order 2 + Rice), MP3 — кадры Layer III с
+/// тоном в count1-области (звук не тишина: Helix и minimp3 сравнимы).
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ae2::bench {
+
+struct Fixture {
+    std::string name;  ///< короткое имя в отчёте: "pcm16-stereo-44k"
+    std::string path;
+};
+
+/// Записать набор в dir (создаётся при необходимости). seconds — длина
+/// каждого файла. Пустой результат — не удалось записать.
+std::vector<Fixture> writeSynthetic(const std::string& dir, uint32_t seconds);
+
+/// FLAC на отдельные ветки декодера: LPC (32- и 64-битная сумма),
+/// left/right/mid-side, CONSTANT/VERBATIM, wasted bits, escaped-партиции
+/// Rice, SEEKTABLE. pcm — исходный звук в том виде, в каком его отдаёт
+/// декодер: моно (L + R) >> 1, 24 бита — старшие 16.
+struct FlacCase {
+    std::string          name;
+    std::string          path;
+    std::vector<int16_t> pcm;
+};
+std::vector<FlacCase> writeFlacCases(const std::string& dir);
+
+/// Реальные файлы из каталога (*.mp3/.wav/.flac/.alaw/.ulaw), имя — "file:<имя>".
+std::vector<Fixture> listDir(const std::string& dir);
+
+} // namespace ae2::bench
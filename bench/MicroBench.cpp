@@ -0,0 +1,253 @@
+/// @file MicroBench.cpp
+/// @brief ae2_bench: микробенчмарки декодеров, ресемплера, громкости,
+///        CodecDetect и Mp3Duration с регрессионной базовой линией.
+///
+///   ae2_bench [--fixtures DIR] [--work DIR] [--seconds N] [--filter S]
+///             [--min-ms N] [--trials N] [--save FILE]
+///             [--compare FILE] [--threshold PCT]
+///
+/// Декодеры гоняются через AudioCodecs (как в AudioMgr: тот же scratch,
+/// тот же размер порции, вызовы без виртуальной диспетчеризации). MP3
+/// дополнительно — каждым бэкендом напрямую (mp3/helix, mp3/minimp3):
+/// по ним выбирается AE2_MP3_MINIMP3 для цели. На x86-64 Helix ещё и без
+/// SSE4.1 (mp3/helix-c); перед замерами PCM обоих путей сверяется бит-в-бит,
+/// расхождение — код возврата 1. Сами ядра на случайных входах проверяет
+/// ae2_test_helix_simd.
+#include "Bench.hpp"
+#include "Fixtures.hpp"
+
+#include "AudioMgr/AudioCodecs.hpp"
+#include "AudioMgr/Volume.hpp"
+#include "CodecDetect/CodecDetect.hpp"
+#include "Decoders/DecoderMp3.hpp"
+#include "Decoders/DecoderMp3Mini.hpp"
+#include "FsAdapter/FsAdapter.hpp"
+#include "Mp3Duration/Mp3Duration.hpp"
+#include "Profiler/Profiler.hpp"
+#include "Resampler/Resampler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace ae2;
+using namespace ae2::bench;
+
+namespace {
+
+/// Порция декодирования — как AudioMgr::kDecodeChunk.
+constexpr uint32_t kChunk = 1024;
+
+AudioCodecs codecs;
+CodecSet<DecoderMp3>     helix;
+CodecSet<DecoderMp3Mini> minimp3;
+constexpr size_t kScratch = std::max({AudioCodecs::kScratchBytes, DecoderMp3::kScratchBytes,
+                                      DecoderMp3Mini::kScratchBytes});
+alignas(kScratchAlign) uint8_t scratch[kScratch];
+uint8_t fsBuf[4096];
+FsAdapter fs(fsBuf, sizeof(fsBuf));
+s16 pcm[kChunk];
+
+/// Декодировать файл целиком набором кодеков set. samples == 0 — файл не открылся
+/// или в наборе нет кодека для него. keep — сохранить PCM для сверки.
+template<typename Set>
+Run decodeWith(Set& set, const std::string& path, std::vector<s16>* keep = nullptr) {
+    Run r;
+    if (!fs.open(path.c_str())) return r;
+    DecoderEnv env;
+    env.type    = CodecDetect::detect(fs);
+    env.scratch = ScratchArena{scratch, sizeof(scratch)};
+    DecoderBase* dec = set.emplace(env);
+    if (dec && dec->open(fs)) {
+        r.rate = set.sampleRate();
+        for (;;) {
+            uint32_t n = set.decode(pcm, kChunk);
+            if (n == 0 && !dec->skipping()) break;
+            r.samples += n;
+            if (keep) keep->insert(keep->end(), pcm, pcm + n);
+        }
+        r.bytes = fs.tell();
+    }
+    set.reset();
+    fs.close();
+    return r;
+}
+
+Run decodeFile(const std::string& path) { return decodeWith(codecs, path); }
+
+/// Helix с SIMD и на C (MP3SetSimd) — один и тот же PCM.
+bool simdIdentical(const std::string& path) {
+    std::vector<s16> ref, simd;
+    MP3SetSimd(0);
+    decodeWith(helix, path, &ref);
+    MP3SetSimd(1);
+    decodeWith(helix, path, &simd);
+    return ref == simd;
+}
+
+struct Args {
+    std::string fixtures;
+    std::string work    = "bench-fixtures";
+    uint32_t    seconds = 10;
+    const char* save    = nullptr;
+    const char* compare = nullptr;
+    double      threshold = 10.0;
+    Options     opt;
+};
+
+bool parse(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; ++i) {
+        const char* k = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!v) return false;
+        if      (!std::strcmp(k, "--fixtures"))  a.fixtures = v;
+        else if (!std::strcmp(k, "--work"))      a.work = v;
+        else if (!std::strcmp(k, "--seconds"))   a.seconds = (uint32_t)std::atoi(v);
+        else if (!std::strcmp(k, "--filter"))    a.opt.filter = v;
+        else if (!std::strcmp(k, "--min-ms"))    a.opt.minMs = (uint32_t)std::atoi(v);
+        else if (!std::strcmp(k, "--trials"))    a.opt.trials = (uint32_t)std::atoi(v);
+        else if (!std::strcmp(k, "--save"))      a.save = v;
+        else if (!std::strcmp(k, "--compare"))   a.compare = v;
+        else if (!std::strcmp(k, "--threshold")) a.threshold = std::atof(v);
+        else return false;
+        ++i;
+    }
+    return a.seconds > 0 && a.opt.trials > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args a;
+    if (!parse(argc, argv, a)) {
+        std::fprintf(stderr,
+            "usage: %s [--fixtures DIR] [--work DIR] [--seconds N] [--filter S]\n"
+            "          [--min-ms N] [--trials N] [--save FILE] [--compare FILE] [--threshold PCT]\n",
+            argv[0]);
+        return 2;
+    }
+
+    std::vector<Fixture> files = writeSynthetic(a.work, a.seconds);
+    if (files.empty()) {
+        std::fprintf(stderr, "cannot write fixtures to %s\n", a.work.c_str());
+        return 2;
+    }
+    if (!a.fixtures.empty()) {
+        std::vector<Fixture> real = listDir(a.fixtures);
+        files.insert(files.end(), real.begin(), real.end());
+    }
+
+    std::vector<Result> results;
+    auto run = [&](const std::string& name, const Case& fn) {
+        if (!a.opt.filter.empty() && name.find(a.opt.filter) == std::string::npos) return;
+        results.push_back(measure(name, fn, a.opt));
+        printResult(results.back());
+    };
+
+    printHeader();
+
+    /* ── Декодеры: файл целиком через AudioCodecs ── */
+    for (const Fixture& f : files) {
+        if (decodeFile(f.path).samples == 0) {
+            std::printf("%-44s skipped (no decoder)\n", ("decode/" + f.name).c_str());
+            continue;
+        }
+        run("decode/" + f.name, [&] { return decodeFile(f.path); });
+    }
+
+    /* ── MP3: оба бэкенда, независимо от AE2_MP3_MINIMP3 ── */
+    const bool simd = MP3SetSimd(1) != 0;
+    uint32_t simdMismatch = 0;
+    for (const Fixture& f : files) {
+        if (decodeWith(helix, f.path).samples == 0) continue;  /* не MP3 */
+        if (simd && !simdIdentical(f.path)) {
+            std::printf("%-44s SIMD output differs from C\n", ("mp3/helix/" + f.name).c_str());
+            simdMismatch++;
+        }
+        run("mp3/helix/" + f.name,   [&] { return decodeWith(helix, f.path); });
+        if (simd) {
+            MP3SetSimd(0);
+            run("mp3/helix-c/" + f.name, [&] { return decodeWith(helix, f.path); });
+            MP3SetSimd(1);
+        }
+        run("mp3/minimp3/" + f.name, [&] { return decodeWith(minimp3, f.path); });
+    }
+
+    /* ── Ресемплер: каждая частота aeSetSampleRateParam × типовые входы ── */
+    static const uint32_t kIn[]  = {8000, 16000, 22050, 32000, 44100, 48000};
+    static const uint32_t kOut[] = {128000, 96000, 88200, 176400};
+    static s16 src[kChunk];
+    static s16 dst[kChunk * (176400 / 8000 + 1)];
+    for (uint32_t i = 0; i < kChunk; ++i) src[i] = (s16)((i * 2654435761u) >> 16);
+
+    for (uint32_t out : kOut) {
+        for (uint32_t in : kIn) {
+            for (auto alg : {Resampler::Algorithm::Nearest, Resampler::Algorithm::Linear}) {
+                Resampler rs;
+                rs.setAlgorithm(alg);
+                rs.setRates(in, out);
+                char name[64];
+                std::snprintf(name, sizeof(name), "resample/%u->%u/%s", in, out,
+                              alg == Resampler::Algorithm::Linear ? "linear" : "nearest");
+                run(name, [&rs, out] {
+                    Run r;
+                    r.samples = rs.process(src, kChunk, dst, (uint32_t)(sizeof(dst) / sizeof(dst[0])), nullptr, 0);
+                    r.rate    = out;
+                    return r;
+                });
+            }
+        }
+    }
+
+    /* ── Громкость: arm_scale_q15 (CMSIS-DSP или fallback из Volume.hpp) ── */
+    run("volume/arm_scale_q15", [] {
+        arm_scale_q15(src, 0x5A82, 0, dst, kChunk);
+        Run r;
+        r.samples = kChunk;
+        return r;
+    });
+
+    /* ── Разбор заголовков: на вызов, файл открыт заранее ── */
+    for (const Fixture& f : files) {
+        if (!fs.open(f.path.c_str())) continue;
+        CodecDetect::Type t = CodecDetect::detect(fs);
+        run("detect/" + f.name, [] {
+            Run r;
+            CodecDetect::detect(fs);
+            r.samples = 1;
+            return r;
+        });
+        if (t == CodecDetect::Type::Mp3) {
+            const uint32_t size = fs.size();
+            run("mp3duration/" + f.name, [size] {
+                Run r;
+                Mp3Duration::estimate(fs, size);
+                r.samples = 1;
+                return r;
+            });
+        }
+        fs.close();
+    }
+
+    if (Profiler::kEnabled) {
+        std::printf("\nprofiler, all cases:\n");
+        printProfile();
+    }
+
+    if (simdMismatch) return 1;
+
+    if (a.save && !saveJson(a.save, results)) {
+        std::fprintf(stderr, "cannot write %s\n", a.save);
+        return 2;
+    }
+    if (a.compare) {
+        std::vector<Result> base;
+        if (!loadJson(a.compare, base)) {
+            std::fprintf(stderr, "cannot read %s\n", a.compare);
+            return 2;
+        }
+        return compare(base, results, a.threshold) ? 1 : 0;
+    }
+    return 0;
+}
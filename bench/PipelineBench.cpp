@@ -0,0 +1,424 @@
+/// @file PipelineBench.cpp
+/// @brief ae2_pipebench: нагрузка всего конвейера AudioMgr на виртуальных
+///        часах (AE2_HW_SIM) и оценка бюджета Cortex-M4.
+///
+///   ae2_pipebench [--work DIR] [--seconds N] [--filter S]
+///                 [--m4-mhz MHZ] [--m4-ratio R] [--host-ghz GHZ]
+///                 [--save FILE] [--compare FILE] [--threshold PCT]
+///                 [--trace PREFIX]
+///
+/// Каждый сценарий — скрипт команд по виртуальным миллисекундам; на шаг
+/// один runOnce() (как таск с vTaskDelay(1)), его время меряется. Тики, где
+/// runOnce() вернул false (таск спал бы), в распределение не входят.
+///
+/// Дедлайн: ring AudioHw (RingSize сэмплов) при AudioHw::sampleRate() —
+/// столько тик может длиться, пока DAC доедает запас. Такты хоста
+/// переводятся в такты M4 множителем --m4-ratio: отношение тактов на одном
+/// и том же кейсе ae2_bench на целевой плате (DWT->CYCCNT) и на хосте.
+/// Ожидание свободного места в acquireWrite в симуляции — сдвиг часов,
+/// а не сон, поэтому в замер оно почти не попадает.
+///
+/// --trace (библиотека с AE2_TRACE): по окончании сценария кольцо Trace
+/// выгружается в PREFIX<сценарий>.json — последние AE2_TRACE_EVENTS событий.
+#include "Bench.hpp"
+#include "Fixtures.hpp"
+
+#include "AudioEngineV2/AudioMgr.hpp"
+#include "AudioHw/AudioHw.hpp"
+#include "Profiler/Profiler.hpp"
+#include "Trace/Trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#endif
+
+#if !AE2_HW_SIM
+#  error "ae2_pipebench requires AE2_HW_SIM=1"
+#endif
+
+using namespace ae2;
+using namespace ae2::bench;
+
+namespace {
+
+struct Args {
+    std::string work    = "bench-fixtures";
+    uint32_t    seconds = 5;
+    std::string filter;
+    double      m4Mhz   = 288.0;  ///< AT32F437
+    double      m4Ratio = 4.0;    ///< тактов M4 на такт хоста; калибруется
+    double      hostGhz = 0;      ///< 0 — по TSC (x86) или 3.0
+    const char* save    = nullptr;
+    const char* compare = nullptr;
+    double      threshold = 20.0;
+    const char* trace   = nullptr;  ///< префикс файлов Chrome trace
+};
+
+double nowNs() {
+    using namespace std::chrono;
+    return (double)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/// Частота счётчика тактов хоста; на x86 — по TSC за 100 мс.
+double hostGhz() {
+#if defined(__x86_64__) || defined(__i386__)
+    double t0 = nowNs();
+    uint64_t c0 = __rdtsc();
+    while (nowNs() - t0 < 1e8) {}
+    return (double)(__rdtsc() - c0) / (nowNs() - t0);
+#else
+    return 3.0;
+#endif
+}
+
+/* ── Сценарий ── */
+
+struct Counters {
+    uint32_t tracks    = 0;
+    uint32_t underruns = 0;  ///< Event::Underrun
+};
+
+void onEvent(const AudioMgr::Event& ev, void* ctx) {
+    auto* c = static_cast<Counters*>(ctx);
+    if (ev.type == AudioMgr::Event::TrackStarted) c->tracks++;
+    if (ev.type == AudioMgr::Event::Underrun)     c->underruns++;
+}
+
+struct Script {
+    const char* name;
+    uint32_t    maxMs;
+    void (*setup)(const Args&);
+    void (*step)(const Args&, uint32_t ms);  ///< до runOnce() на шаге ms
+};
+
+struct Report {
+    std::vector<double> tickNs;  ///< CPU на виртуальную мс; мс, где таск спал бы, не входят
+    uint32_t ms        = 0;
+    Counters ev;
+    AudioHw::SimStats hw;
+    AudioMgr::PipelineStats pipe;  ///< окно — весь сценарий
+    AudioMgr::PcmCacheStats cache;
+    uint32_t dacRate   = 0;  ///< максимальная за прогон: самый короткий дедлайн
+};
+
+std::string gM3u;
+std::string gShortM3u;
+std::vector<std::string> gPrompts;  ///< короткие сжатые файлы — «подсказки»
+
+/// Блок PcmCache для сценария prompts-cached (на плате — зона RegionAlloc)
+alignas(4) uint8_t gPcmCacheMem[2u << 20];
+
+uint32_t rng() {
+    static uint32_t s = 0x2545F491u;
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    return s;
+}
+
+/* Внешний источник с высшим приоритетом: тон 16 кГц */
+uint32_t diagFeed(void*, s16* buf, uint32_t n, uint32_t* rate) {
+    static uint32_t ph = 0;
+    for (uint32_t i = 0; i < n; ++i) buf[i] = (s16)(((ph++ / 8) & 1) ? 4000 : -4000);
+    *rate = 16000;
+    return n;
+}
+
+/* Подсказка каждые 1200 мс, по кругу; Player активен с начала */
+void promptStep(uint32_t ms) {
+    if (ms % 1200 != 0) return;
+    auto& m = AudioMgr::instance();
+    if (ms == 0) m.requestActivate(SrcId::Player);
+    m.addFile(gPrompts[(ms / 1200) % gPrompts.size()].c_str());
+}
+
+void startPlaylist(const std::string& m3u) {
+    auto& m = AudioMgr::instance();
+    m.playPlaylist(m3u.c_str());
+    m.requestActivate(SrcId::Player);
+    m.play();
+}
+
+const Script kScripts[] = {
+    /* Плейлист из всех форматов подряд, без вмешательства */
+    {"play", 0,
+     [](const Args&) { startPlaylist(gM3u); },
+     [](const Args&, uint32_t) {}},
+
+    /* Случайный seek каждые 40 мс; раз в секунду — в конец трека (смена трека) */
+    {"seek-storm", 20000,
+     [](const Args&) { startPlaylist(gM3u); },
+     [](const Args& a, uint32_t ms) {
+         if (ms % 1000 == 800) AudioMgr::instance().seek(a.seconds);
+         else if (ms % 1000 < 800 && ms % 40 == 0) AudioMgr::instance().seek(rng() % a.seconds);
+     }},
+
+    /* Короткие треки, DAC следует за частотой трека: смена трека = смена rate */
+    {"track-change", 0,
+     [](const Args&) {
+         AudioMgr::instance().setRatePolicy(AudioMgr::RatePolicy::NativeMultiple);
+         startPlaylist(gShortM3u);
+     },
+     [](const Args&, uint32_t) {}},
+
+    /* Diag вытесняет плеер каждые 300 мс и отпускает */
+    {"preempt", 20000,
+     [](const Args&) {
+         AudioMgr::instance().registerSource(SrcId::Diag, 3, {diagFeed, nullptr});
+         startPlaylist(gM3u);
+     },
+     [](const Args&, uint32_t ms) {
+         if (ms % 600 == 300) AudioMgr::instance().requestActivate(SrcId::Diag);
+         if (ms % 600 == 0)   AudioMgr::instance().requestDeactivate(SrcId::Diag);
+     }},
+
+    /* Короткие подсказки по кругу: каждый раз fopen, разбор, decode */
+    {"prompts", 24000,
+     [](const Args&) {},
+     [](const Args&, uint32_t ms) { promptStep(ms); }},
+
+    /* То же с PcmCache: с второго круга — из RAM, уже на частоте DAC */
+    {"prompts-cached", 24000,
+     [](const Args&) {
+         AudioMgr::PcmCacheConfig c;
+         c.mem          = gPcmCacheMem;
+         c.bytes        = sizeof(gPcmCacheMem);
+         c.maxFileBytes = 1u << 20;
+         c.preResample  = true;
+         AudioMgr::instance().setPcmCache(c);
+     },
+     [](const Args&, uint32_t ms) { promptStep(ms); }},
+};
+
+/* ── Нарезка CPU по виртуальным миллисекундам ──
+ * runOnce() может ждать места в ring; в симуляции ожидание двигает часы
+ * (AudioHw::waitTick_ → simAdvance), и одна итерация покрывает несколько мс.
+ * На плате таск в это время спит, поэтому тик здесь — работа между двумя
+ * шагами часов. Граница шага видна по record-колбэку AudioHw. */
+struct Slicer {
+    Report*  r       = nullptr;
+    bool     inRun   = false;
+    double   start   = 0;
+    double   acc     = 0;
+    uint64_t lastMs  = 0;
+
+    void close(double now) {
+        acc += now - start;
+        r->tickNs.push_back(acc);
+        acc = 0;
+    }
+    static void record(void* ctx, const s16*, uint32_t, uint32_t) {
+        auto* s = static_cast<Slicer*>(ctx);
+        uint64_t t = AudioHw::instance().simStats().timeMs;
+        if (!s->inRun || t == s->lastMs) return;  /* второй вызов шага — заворот ring */
+        s->lastMs = t;
+        double now = nowNs();
+        s->close(now);
+        s->start = nowNs();
+    }
+};
+
+/// Прогнать сценарий до конца плейлиста (плеер перестал играть) или maxMs.
+/// Между сценариями — стоп и пустые тики.
+Report run(const Script& s, const Args& a) {
+    auto& m  = AudioMgr::instance();
+    auto& hw = AudioHw::instance();
+    Report r;
+    Profiler::reset();
+    Trace::clear();
+    (void)m.pipelineStats(true);
+    Slicer sl;
+    sl.r = &r;
+    m.setEventCb(onEvent, &r.ev);
+    hw.simConfigure({0, &Slicer::record, &sl});
+    s.setup(a);
+
+    const uint32_t limit = s.maxMs ? s.maxMs : 3600u * 1000u;
+    bool started = false;
+    uint32_t stepped = 0;
+    while (hw.simStats().timeMs < limit) {
+        /* Ожидания внутри runOnce() сдвигают часы на несколько мс — шаги
+         * скрипта за пропущенные мс отдаём все, по порядку */
+        for (; stepped <= (uint32_t)hw.simStats().timeMs; ++stepped) s.step(a, stepped);
+        sl.inRun = true;
+        sl.start = nowNs();
+        bool active = m.runOnce();
+        sl.inRun = false;
+        if (active) sl.close(nowNs());
+        else        sl.acc = 0;
+        sl.lastMs = hw.simStats().timeMs + 1;
+        hw.simAdvance(1);
+        r.dacRate = std::max(r.dacRate, hw.sampleRate());
+        bool playing = m.playerStatus().playing;
+        started |= playing;
+        if (started && !playing && s.maxMs == 0) break;
+    }
+    r.hw   = hw.simStats();
+    r.ms   = (uint32_t)r.hw.timeMs;
+    r.pipe = m.pipelineStats(true);
+    r.cache = m.pcmCacheStats();
+    if (a.trace) {
+        std::string path = std::string(a.trace) + s.name + ".json";
+        if (!Trace::exportChromeFile(path.c_str()))
+            std::fprintf(stderr, "cannot write trace %s\n", path.c_str());
+    }
+
+    hw.simConfigure({});
+    m.setEventCb(nullptr, nullptr);
+    m.stop();
+    m.clearQueue();
+    m.requestDeactivate(SrcId::Diag);
+    m.requestDeactivate(SrcId::Player);
+    m.unregisterSource(SrcId::Diag);
+    m.setRatePolicy(AudioMgr::RatePolicy::Fixed);
+    m.setPcmCache({});
+    for (int i = 0; i < 100; ++i) { m.runOnce(); hw.simAdvance(1); }
+    return r;
+}
+
+double pct(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t i = (size_t)(p / 100.0 * (double)(sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+bool parse(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; ++i) {
+        const char* k = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!v) return false;
+        if      (!std::strcmp(k, "--work"))      a.work = v;
+        else if (!std::strcmp(k, "--seconds"))   a.seconds = (uint32_t)std::atoi(v);
+        else if (!std::strcmp(k, "--filter"))    a.filter = v;
+        else if (!std::strcmp(k, "--m4-mhz"))    a.m4Mhz = std::atof(v);
+        else if (!std::strcmp(k, "--m4-ratio"))  a.m4Ratio = std::atof(v);
+        else if (!std::strcmp(k, "--host-ghz"))  a.hostGhz = std::atof(v);
+        else if (!std::strcmp(k, "--save"))      a.save = v;
+        else if (!std::strcmp(k, "--compare"))   a.compare = v;
+        else if (!std::strcmp(k, "--threshold")) a.threshold = std::atof(v);
+        else if (!std::strcmp(k, "--trace"))     a.trace = v;
+        else return false;
+        ++i;
+    }
+    return a.seconds > 0 && a.m4Mhz > 0 && a.m4Ratio > 0;
+}
+
+bool writeM3u(const std::string& path, const std::vector<Fixture>& files) {
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    for (const Fixture& x : files) std::fprintf(f, "%s\n", x.path.c_str());
+    return std::fclose(f) == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Args a;
+    if (!parse(argc, argv, a)) {
+        std::fprintf(stderr,
+            "usage: %s [--work DIR] [--seconds N] [--filter S] [--m4-mhz MHZ] [--m4-ratio R]\n"
+            "          [--host-ghz GHZ] [--save FILE] [--compare FILE] [--threshold PCT]\n"
+            "          [--trace PREFIX]\n",
+            argv[0]);
+        return 2;
+    }
+    if (a.hostGhz <= 0) a.hostGhz = hostGhz();
+
+    std::vector<Fixture> full  = writeSynthetic(a.work, a.seconds);
+    std::vector<Fixture> brief = writeSynthetic(a.work + "/short", 1);
+    gM3u      = a.work + "/all.m3u";
+    gShortM3u = a.work + "/short.m3u";
+    for (const Fixture& x : brief) {
+        /* Подсказки обычно сжаты: декодер дороже копии */
+        if (x.name.rfind("mp3", 0) == 0 || x.name.rfind("flac", 0) == 0 || x.name.rfind("ima", 0) == 0)
+            gPrompts.push_back(x.path);
+    }
+    if (full.empty() || brief.empty() || gPrompts.empty() ||
+        !writeM3u(gM3u, full) || !writeM3u(gShortM3u, brief)) {
+        std::fprintf(stderr, "cannot write fixtures to %s\n", a.work.c_str());
+        return 2;
+    }
+
+    std::printf("host %.2f GHz, M4 %.0f MHz, ratio %.1f M4 cycles per host cycle\n\n",
+                a.hostGhz, a.m4Mhz, a.m4Ratio);
+
+    std::vector<Result> results;
+    for (const Script& s : kScripts) {
+        if (!a.filter.empty() && std::string(s.name).find(a.filter) == std::string::npos) continue;
+        Report r = run(s, a);
+        std::vector<double> t = r.tickNs;
+        std::sort(t.begin(), t.end());
+        double sum = 0;
+        for (double x : t) sum += x;
+        const double mean = t.empty() ? 0 : sum / (double)t.size();
+        const double worst = t.empty() ? 0 : t.back();
+
+        /* ns хоста → мкс M4: ns · GHz = такты хоста; · ratio = такты M4; / МГц */
+        const double toM4us   = a.hostGhz * a.m4Ratio / a.m4Mhz;
+        const double deadline = (double)AudioHw::RingSize * 1e6 / (double)(r.dacRate ? r.dacRate : 1);
+        const double load     = sum * toM4us / ((double)r.ms * 1000.0) * 100.0;
+
+        std::printf("── %s: %u ms virtual, %zu active ticks, %u tracks, DAC %u Hz\n",
+                    s.name, r.ms, t.size(), r.ev.tracks, r.dacRate);
+        std::printf("   host ns/tick   mean %.0f  p50 %.0f  p99 %.0f  p99.9 %.0f  max %.0f\n",
+                    mean, pct(t, 50), pct(t, 99), pct(t, 99.9), worst);
+        std::printf("   M4 est.        mean %.1f us  p99 %.1f us  max %.1f us  (%.0f cycles)\n",
+                    mean * toM4us, pct(t, 99) * toM4us, worst * toM4us,
+                    worst * a.hostGhz * a.m4Ratio);
+        std::printf("   deadline       %.0f us (ring %u / %u Hz)  headroom %.0f us\n",
+                    deadline, AudioHw::RingSize, r.dacRate, deadline - worst * toM4us);
+        std::printf("   CPU            %.1f%% mean, worst tick %.1f%% of the 1 ms period\n",
+                    load, worst * toM4us / 10.0);
+        std::printf("   underruns      sim %u (%llu samples), events %u\n",
+                    r.hw.underruns, (unsigned long long)r.hw.underrunSamples, r.ev.underruns);
+        std::printf("   pipeline       ring %u..%u, DMA underruns %u, timeouts %u, "
+                    "decode p50 %u us  p99 %u us  max %u us\n",
+                    r.pipe.ringMin, r.pipe.ringMax, r.pipe.underruns, r.pipe.timeouts,
+                    r.pipe.decodeP50Us, r.pipe.decodeP99Us, r.pipe.decodeMaxUs);
+        if (r.cache.capacity)
+            std::printf("   pcm cache      %u hits, %u misses, %u fills, %u aborts, "
+                        "%u evictions, %u entries, %u/%u bytes\n",
+                        r.cache.hits, r.cache.misses, r.cache.fills, r.cache.aborts,
+                        r.cache.evictions, r.cache.entries, r.cache.used, r.cache.capacity);
+
+        /* log2-гистограмма времени тика хоста */
+        uint32_t hist[40]{};
+        for (double x : t) {
+            uint32_t b = 0;
+            while (b < 39 && (double)(2ull << b) <= x) b++;
+            hist[b]++;
+        }
+        std::printf("   histogram     ");
+        for (uint32_t b = 0; b < 40; ++b)
+            if (hist[b]) std::printf(" <%lluns:%u", (unsigned long long)(2ull << b), hist[b]);
+        std::printf("\n");
+        printProfile();
+        std::printf("\n");
+
+        for (auto [suffix, ns] : {std::pair<const char*, double>{"mean", mean},
+                                  {"p99", pct(t, 99)}, {"p99.9", pct(t, 99.9)}}) {
+            Result x;
+            x.name        = std::string("pipeline/") + s.name + "/" + suffix;
+            x.nsPerSample = ns;
+            x.samples     = t.size();
+            results.push_back(x);
+        }
+    }
+    if (a.save && !saveJson(a.save, results)) {
+        std::fprintf(stderr, "cannot write %s\n", a.save);
+        return 2;
+    }
+    if (a.compare) {
+        std::vector<Result> base;
+        if (!loadJson(a.compare, base)) {
+            std::fprintf(stderr, "cannot read %s\n", a.compare);
+            return 2;
+        }
+        return compare(base, results, a.threshold) ? 1 : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+/// @file HostRtos.cpp
+/// @brief Однопоточная реализация стабов FreeRTOS и платформы для хоста.
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "RegionAllocator.h"
+#include "Statuses.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+SysState_t SysState;
+
+/* Единственный «таск» — поток теста; ненулевой handle для AllocGuard */
+struct tskTaskControlBlock {};
+
+namespace {
+
+/// Очередь и семафор — одно состояние; у семафора itemSize == 0.
+struct HostQueue {
+    uint8_t*    storage;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+static_assert(sizeof(HostQueue) <= sizeof(StaticQueue_t), "StaticQueue_t мал для HostQueue");
+
+TickType_t gTicks    = 0;
+uint32_t   gNotified = 0;
+tskTaskControlBlock gTask;
+
+HostQueue* hq(QueueHandle_t q) { return reinterpret_cast<HostQueue*>(q); }
+
+QueueHandle_t create(StaticQueue_t* buf, UBaseType_t length, UBaseType_t itemSize,
+                     uint8_t* storage, UBaseType_t initial) {
+    auto* q = reinterpret_cast<HostQueue*>(buf);
+    *q = HostQueue{storage, length, itemSize, 0, initial};
+    return reinterpret_cast<QueueHandle_t>(q);
+}
+
+} // namespace
+
+extern "C" {
+
+void vHostAssertFailed(const char* file, int line) {
+    std::fprintf(stderr, "configASSERT failed: %s:%d\n", file, line);
+    std::abort();
+}
+
+/* ── Тики ── */
+
+TickType_t xTaskGetTickCount(void) { return gTicks; }
+void vTaskDelay(TickType_t ticks) { gTicks += ticks; }
+void vTaskStepTick(TickType_t ticks) { gTicks += ticks; }
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t timeout) {
+    if (gNotified == 0) {
+        if (timeout != portMAX_DELAY) gTicks += timeout;
+        return 0;
+    }
+    uint32_t n = gNotified;
+    gNotified = clearOnExit ? 0 : n - 1;
+    return n;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t) {
+    gNotified++;
+    return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) { return &gTask; }
+
+/* ── Очереди ── */
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t itemSize,
+                                 uint8_t* storage, StaticQueue_t* buf) {
+    if (!buf || !storage || length == 0 || itemSize == 0) return nullptr;
+    return create(buf, length, itemSize, storage, 0);
+}
+
+BaseType_t xQueueSend(QueueHandle_t h, const void* item, TickType_t) {
+    HostQueue* q = hq(h);
+    if (!q || q->count == q->length) return pdFAIL;
+    std::memcpy(q->storage + ((q->head + q->count) % q->length) * q->itemSize, item, q->itemSize);
+    q->count++;
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t h, void* item, TickType_t) {
+    HostQueue* q = hq(h);
+    if (!q || q->count == 0) return pdFAIL;
+    std::memcpy(item, q->storage + q->head * q->itemSize, q->itemSize);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t h) { return hq(h) ? hq(h)->count : 0; }
+
+/* ── Семафоры ── */
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* buf) {
+    return create(buf, 1, 0, nullptr, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* buf) {
+    return create(buf, 1, 0, nullptr, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t maxCount, UBaseType_t initial,
+                                                 StaticSemaphore_t* buf) {
+    return create(buf, maxCount, 0, nullptr, initial);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t h, TickType_t) {
+    HostQueue* q = hq(h);
+    if (!q || q->count == 0) return pdFAIL;
+    q->count--;
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t h) {
+    HostQueue* q = hq(h);
+    if (!q || q->count == q->length) return pdFAIL;
+    q->count++;
+    return pdPASS;
+}
+
+} // extern "C"
+
+BaseType_t xTaskCreateInRegion(RegionAlloc::Zone, void (*)(void*), const char*,
+                               uint32_t, void*, UBaseType_t, TaskHandle_t* handle) {
+    if (handle) *handle = nullptr;
+    return pdPASS;
+}
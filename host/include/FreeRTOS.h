@@ -0,0 +1,48 @@
+#pragma once
+/// @file FreeRTOS.h
+/// @brief Хост-стаб FreeRTOS (AE2_HOST_RTOS): один поток, без планировщика.
+///
+/// Ровно то, что использует AudioEngineV2. Очереди и семафоры статические и
+/// не блокируются: ждать некого, таймаут игнорируется. Тик — счётчик,
+/// который двигают vTaskDelay/vTaskStepTick, в AE2_HW_SIM — виртуальные
+/// часы AudioHw. Таски не запускаются, поэтому AudioMgr на хосте живёт
+/// только в симуляции (тест сам крутит runOnce). Многопоточный хост —
+/// POSIX-порт FreeRTOS и -DAE2_HOST_RTOS=OFF.
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t      TickType_t;
+typedef long          BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t      StackType_t;  /* как на Cortex-M: бюджет стеков тот же */
+
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef struct QueueDefinition*     QueueHandle_t;
+typedef QueueHandle_t               SemaphoreHandle_t;
+
+/* Место под состояние очереди стаба, как у настоящего StaticQueue_t */
+typedef struct {
+    void*       pvDummy[2];
+    UBaseType_t uxDummy[5];
+} StaticQueue_t;
+typedef StaticQueue_t StaticSemaphore_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE  ((BaseType_t)1)
+#define pdFAIL  pdFALSE
+#define pdPASS  pdTRUE
+
+#define portMAX_DELAY      ((TickType_t)0xFFFFFFFFu)
+#define configTICK_RATE_HZ 1000u
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000u))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void vHostAssertFailed(const char* file, int line);
+#ifdef __cplusplus
+}
+#endif
+
+#define configASSERT(x) do { if (!(x)) vHostAssertFailed(__FILE__, __LINE__); } while (0)
@@ -0,0 +1,19 @@
+#pragma once
+/// @file PlayerSpiProtocol.hpp
+/// @brief Хост-стаб протокола SPI плеера: снэпшот очереди.
+
+#include <stdint.h>
+
+#define PLAYER_MAX_QUEUE  16
+#define PLAYER_PATH_MAX   128
+#define PLAYER_INVALID_ID 0u
+
+enum class PlayerOutput : uint8_t { Front = 0, Rear = 1 };
+
+struct PlayerQueueEntry {
+    uint32_t     trackId;
+    char         path[PLAYER_PATH_MAX];
+    uint32_t     positionSec;
+    uint32_t     durationSec;
+    PlayerOutput output;
+};
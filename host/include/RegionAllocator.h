@@ -0,0 +1,14 @@
+#pragma once
+/// @file RegionAllocator.h
+/// @brief Хост-стаб распределителя зон прошивки: только создание тасков.
+
+#include "FreeRTOS.h"
+
+namespace RegionAlloc {
+enum class Zone : uint8_t { HEAP_ZONE_FAST, HEAP_ZONE_SLOW, HEAP_ZONE_EXT };
+}
+
+/// Таск не запускается (планировщика нет); handle остаётся пустым.
+BaseType_t xTaskCreateInRegion(RegionAlloc::Zone zone, void (*entry)(void*), const char* name,
+                               uint32_t stackDepth, void* arg, UBaseType_t priority,
+                               TaskHandle_t* handle);
@@ -0,0 +1,11 @@
+#pragma once
+/// @file Statuses.hpp
+/// @brief Хост-стаб флагов состояния прошивки.
+
+struct SysState_t {
+    volatile bool RecFlasherExited = true;
+};
+extern SysState_t SysState;
+
+/// В прошивке — ожидание флага; на хосте ждать нечего.
+#define Waitfor(cond) ((void)(cond))
@@ -0,0 +1,6 @@
+#pragma once
+/// @file TaskPriorities.h
+/// @brief Хост-стаб приоритетов тасков прошивки.
+
+#define PRIO_TASK_AUDIO_MGR      5
+#define PRIO_TASK_AUDIO_HW_DRAIN 6
@@ -0,0 +1,21 @@
+#pragma once
+/// @file queue.h
+/// @brief Хост-стаб FreeRTOS: статическая очередь-кольцо без блокировок.
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t itemSize,
+                                 uint8_t* storage, StaticQueue_t* buf);
+/// Полная очередь — pdFAIL сразу (timeout некому дождаться).
+BaseType_t    xQueueSend(QueueHandle_t q, const void* item, TickType_t timeout);
+/// Пустая очередь — pdFAIL сразу.
+BaseType_t    xQueueReceive(QueueHandle_t q, void* item, TickType_t timeout);
+UBaseType_t   uxQueueMessagesWaiting(QueueHandle_t q);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,21 @@
+#pragma once
+/// @file semphr.h
+/// @brief Хост-стаб FreeRTOS: семафоры как счётчики поверх очереди стаба.
+
+#include "queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* buf);
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* buf);
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t maxCount, UBaseType_t initial,
+                                                 StaticSemaphore_t* buf);
+/// Недоступный семафор — pdFAIL сразу: отпустить его некому.
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t timeout);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s);
+
+#ifdef __cplusplus
+}
+#endif
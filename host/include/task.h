@@ -0,0 +1,28 @@
+#pragma once
+/// @file task.h
+/// @brief Хост-стаб FreeRTOS: тики и уведомления единственного «таска».
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+TickType_t   xTaskGetTickCount(void);
+/// Сон = ход часов: других тасков нет.
+void         vTaskDelay(TickType_t ticks);
+void         vTaskStepTick(TickType_t ticks);
+/// Уведомление, пришедшее раньше, снимается сразу; иначе часы идут на
+/// timeout (никто другой не уведомит) и возвращается 0.
+uint32_t     ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t timeout);
+BaseType_t   xTaskNotifyGive(TaskHandle_t task);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* Один поток — прерывать нечему */
+#define taskENTER_CRITICAL() do {} while (0)
+#define taskEXIT_CRITICAL()  do {} while (0)
+#define taskYIELD()          do {} while (0)
@@ -34,6 +34,96 @@ typedef struct {
     uint8_t  play_autostarted : 1;
 } ae2_player_status_t;
 
+typedef enum {
+    AE_EVT_TRACK_STARTED   = 0, /* track_id, arg0 = длительность (с) */
+    AE_EVT_TRACK_ENDED     = 1, /* track_id, arg0 = ae_end_reason_t */
+    AE_EVT_QUEUE_ENDED     = 2,
+    AE_EVT_SOURCE_SWITCHED = 3, /* arg0 = ae_pipe_id_t from, arg1 = ae_pipe_id_t to */
+    AE_EVT_UNDERRUN        = 4, /* arg0 = счётчик underrun */
+    AE_EVT_QUEUE_CHANGED   = 5, /* arg0 = размер очереди */
+    AE_EVT_POSITION_TICK   = 6  /* track_id, arg0 = позиция (с), arg1 = длительность (с) */
+} ae_event_type_t;
+
+typedef enum {
+    AE_END_EOF         = 0,
+    AE_END_STOPPED     = 1,
+    AE_END_INTERRUPTED = 2,
+    AE_END_OPEN_FAILED = 3
+} ae_end_reason_t;
+
+typedef struct {
+    ae_event_type_t type;
+    uint32_t        tick;      /* тик FreeRTOS момента события */
+    uint32_t        track_id;
+    uint32_t        arg0;
+    uint32_t        arg1;
+} ae_event_t;
+
+typedef enum {
+    AE_RESAMPLE_NEAREST = 0,
+    AE_RESAMPLE_LINEAR  = 1
+} ae_resample_t;
+
+/* Параметры офлайн-рендера (см. Render::Options). Заполнять
+ * aeRenderOptionsInit, затем менять нужное */
+typedef struct {
+    uint32_t      out_rate;        /* частота результата */
+    uint8_t       volume;          /* индекс громкости 0..10, 7 и выше — без изменений */
+    ae_resample_t resample;
+    uint32_t      g711_rate;       /* формат headerless .alaw/.ulaw */
+    uint8_t       g711_channels;
+} ae_render_options_t;
+
+typedef struct {
+    uint32_t tracks;       /* отрисовано файлов */
+    uint32_t failed;       /* не открылись / неизвестный кодек */
+    uint64_t in_samples;
+    uint64_t out_samples;
+    uint32_t audio_ms;     /* длительность результата */
+    uint32_t wall_ms;      /* затраченное время */
+    float    x_realtime;   /* audio_ms / wall_ms */
+} ae_render_stats_t;
+
+/* Здоровье конвейера за окно (см. AudioMgr::PipelineStats) */
+typedef struct {
+    uint32_t window_ms;
+    uint32_t loop_iter;
+    uint32_t decodes;
+    uint32_t direct;           /* decode прямо в ring */
+    uint32_t residuals;
+    uint32_t truncations;
+    uint32_t timeouts;         /* acquireWrite не дождался места */
+    uint32_t wait_ms;
+    uint32_t max_wait_ms;
+    uint32_t samples_in;
+    uint32_t samples_out;
+    uint32_t ring_min;         /* сэмплов в ring перед тиком */
+    uint32_t ring_max;
+    uint32_t ring_size;
+    uint32_t underruns;        /* опустошений ring на стороне DMA за окно */
+    uint32_t underruns_total;
+    uint32_t prebuffer_ms;     /* текущий порог предбуфера */
+    uint32_t decode_p50_us;    /* перцентили — верхние границы log2-корзин; 0 без AE2_PROFILER */
+    uint32_t decode_p90_us;
+    uint32_t decode_p99_us;
+    uint32_t decode_max_us;
+} ae_pipeline_stats_t;
+
+/* Кэш PCM (см. AudioMgr::PcmCacheStats); счётчики с aePcmCacheSetup */
+typedef struct {
+    uint32_t capacity;     /* байт блока */
+    uint32_t used;
+    uint32_t entries;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t fills;        /* файлов положено в кэш */
+    uint32_t aborts;       /* заполнений прервано (seek, стоп, не влезло) */
+    uint32_t evictions;
+} ae_pcm_cache_stats_t;
+
+/* Вызывается из таска AudioMgr — обработчик должен быть коротким */
+typedef void (*ae_event_cb_t)(const ae_event_t* ev, void* ctx);
+
 /* ── API ── */
 
 void aeInit(void);
@@ -41,6 +131,8 @@ void aeInit(void);
 /* Плеер */
 void aePlayerEnqueueFile(const char* path, bool front);
 void aePlayerPlayFileImmediately(const char* path, bool front);
+/* M3U или каталог; заменяет очередь. seed задаёт порядок shuffle */
+void aePlayerPlayList(const char* path, bool shuffle, uint32_t seed, bool front);
 void aePlayerPlay(void);
 void aePlayerPause(void);
 void aePlayerStop(void);
@@ -54,8 +146,53 @@ ae_pipe_id_t aeCurrentPipe(void);
 
 /* Настройки */
 void aeSetSampleRateParam(int param);
+/* true — частота DAC следует за треком (наибольшее кратное ≤ заданной
+ * aeSetSampleRateParam), false — всегда заданная */
+void aeSetNativeRate(bool enable);
 void aeVolumeChanged(void);
 void aeSetVolume(ae_pipe_id_t id, uint8_t vol);
+/* Предбуфер DAC: звук после старта/underrun — когда в ring набралось
+ * start_ms; повторные underrun удваивают порог до max_ms (= start_ms — без
+ * роста). По умолчанию 4 и 32 мс */
+void aeSetPrebuffer(uint32_t start_ms, uint32_t max_ms);
+/* Частота/каналы headerless .alaw/.ulaw (по умолчанию 8000 Гц моно) */
+void aeSetRawG711Format(uint32_t rate, uint8_t channels);
+
+/* Кэш PCM коротких файлов (подсказки, диагностика): повтор играет из RAM
+ * без fopen и декодирования. mem — блок из нужной зоны RegionAlloc, живёт
+ * до конца работы; NULL — выключить. Файлы крупнее max_file_bytes не
+ * кэшируются; pre_resample — хранить PCM сразу на частоте DAC */
+void aePcmCacheSetup(void* mem, uint32_t bytes, uint32_t max_file_bytes, bool pre_resample);
+/* Забыть файл (изменился на носителе); NULL — весь кэш */
+void aePcmCacheInvalidate(const char* path);
+void aePcmCacheStats(ae_pcm_cache_stats_t* st);
+
+/* События. timeout_ms = UINT32_MAX — ждать бесконечно.
+ * Пока callback установлен, aeEventWait ничего не получает */
+bool aeEventWait(ae_event_t* ev, uint32_t timeout_ms);
+void aeEventSetCallback(ae_event_cb_t cb, void* ctx);
+void aeEventSetPositionTick(uint32_t period_ms);
+uint32_t aeEventDropped(void);
+
+/* Снимок здоровья конвейера; reset — начать новое окно (сбрасывать
+ * должен один читатель) */
+void aePipelineStats(ae_pipeline_stats_t* st, bool reset);
+
+/* Трасса конвейера (сборка с AE2_TRACE). Запись идёт с самого старта;
+ * дамп — последние AE2_TRACE_EVENTS событий в Chrome trace JSON
+ * (chrome://tracing, ui.perfetto.dev). false — без AE2_TRACE или ошибка записи. */
+void aeTraceEnable(bool enable);
+void aeTraceClear(void);
+bool aeTraceDumpChrome(const char* path);
+
+/* Офлайн-рендер очереди (decode → volume → resample) без AudioHw, со
+ * скоростью CPU. Моно s16 на opt->out_rate. Не реентерабельно.
+ * opt == NULL — значения aeRenderOptionsInit; st может быть NULL. */
+void aeRenderOptionsInit(ae_render_options_t* opt);
+bool aeRenderToWav(const char* const* paths, uint32_t count, const char* wav_path,
+                   const ae_render_options_t* opt, ae_render_stats_t* st);
+bool aeRenderToMemory(const char* const* paths, uint32_t count, int16_t* buf, uint32_t cap,
+                      const ae_render_options_t* opt, uint32_t* written, ae_render_stats_t* st);
 
 #ifdef __cplusplus
 }
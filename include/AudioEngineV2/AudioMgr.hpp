@@ -13,8 +13,12 @@
 namespace ae2 {
 
 class DecoderBase;
+class AudioCodecs;
 class FsAdapter;
 class Resampler;
+class PathPool;
+class Playlist;
+class PcmCache;
 
 class AudioMgr {
 public:
@@ -37,6 +41,10 @@ public:
     void addFile(const char* path, uint32_t startSec = 0,
                  Output out = Output::FrontSpeaker, bool front = false);
     void clearQueue();
+    /// Играть M3U или каталог после очереди; список читается лениво.
+    /// Заменяет текущее воспроизведение и очередь.
+    void playPlaylist(const char* path, bool shuffle = false, uint32_t seed = 0,
+                      Output out = Output::FrontSpeaker);
     void removeFromQueue(uint32_t trackId);
     void seek(uint32_t sec);
     void forward(uint32_t sec = 10);
@@ -44,13 +52,99 @@ public:
     void requestActivate(SrcId id, Output out = Output::FrontSpeaker);
     void requestDeactivate(SrcId id);
     void setVolume(SrcId id, uint8_t vol);
+    /// Частота DAC (Fixed) или её потолок (NativeMultiple).
     void setSampleRate(uint32_t rate);
+
+    /// Как выбирать частоту DAC для плеера.
+    enum class RatePolicy : uint8_t {
+        Fixed,          ///< всегда setSampleRate(); любой трек ресемплируется
+        NativeMultiple  ///< наибольшее кратное частоты трека ≤ setSampleRate():
+                        ///< ресемплинг целочисленный или не нужен вовсе
+    };
+    void setRatePolicy(RatePolicy policy);
     void volumeChanged();
+    /// Предбуфер DAC: после старта, смены частоты и underrun звук идёт,
+    /// когда в ring набралось startMs; повторные underrun удваивают порог
+    /// до maxMs (см. AudioHw::setPrebuffer). Можно из любого таска.
+    void setPrebuffer(uint32_t startMs, uint32_t maxMs);
+    /// Формат headerless .alaw/.ulaw файлов (в них нет заголовка).
+    void setRawG711Format(uint32_t rate, uint8_t channels = 1);
+
+    /* ── Кэш декодированного PCM коротких файлов (подсказки, диагностика) ── */
+    struct PcmCacheConfig {
+        void*    mem          = nullptr;    ///< блок кэша (напр. из нужной зоны RegionAlloc); nullptr — выключить
+        uint32_t bytes        = 0;
+        uint32_t maxFileBytes = 64 * 1024;  ///< файлы крупнее не кэшируются
+        bool     preResample  = false;      ///< хранить PCM на частоте DAC: попадание идёт прямо в ring
+    };
+    /// Попадание открывает трек без fopen/CodecDetect/Mp3Duration и отдаёт
+    /// PCM из памяти; промах декодирует как обычно и в конце файла кладёт
+    /// его PCM в кэш (вытесняя давно не игравшие). Содержимое сбрасывается.
+    /// Блок принадлежит AudioMgr до конца работы (или до следующего вызова
+    /// и конца текущего трека).
+    void setPcmCache(const PcmCacheConfig& cfg);
+    /// Забыть файл (изменился на носителе); nullptr — забыть все. Запись,
+    /// которая играет сейчас, доигрывает и удаляется в конце трека.
+    void invalidatePcmCache(const char* path = nullptr);
+
+    struct PcmCacheStats {
+        uint32_t capacity  = 0;  ///< байт блока
+        uint32_t used      = 0;
+        uint32_t entries   = 0;
+        uint32_t hits      = 0;
+        uint32_t misses    = 0;
+        uint32_t fills     = 0;  ///< файлов положено в кэш
+        uint32_t aborts    = 0;  ///< заполнений прервано (seek, стоп, не влезло)
+        uint32_t evictions = 0;
+    };
+    /// Накопительные счётчики с последнего setPcmCache().
+    [[nodiscard]] PcmCacheStats pcmCacheStats() const;
 
     /* ── Callback на изменение состояния заднего выхода ── */
     using RearOutputCb = void(*)(bool active);
     void setRearOutputCb(RearOutputCb cb);
 
+    /* ── События (вместо поллинга статуса) ── */
+    struct Event {
+        enum Type : uint8_t {
+            TrackStarted,   ///< track: trackId, durationSec
+            TrackEnded,     ///< ended: trackId, reason
+            QueueEnded,     ///< очередь исчерпана, плеер остановлен
+            SourceSwitched, ///< source: from, to
+            Underrun,       ///< underrun: count (ring опустел во время воспроизведения)
+            QueueChanged,   ///< queue: count
+            PositionTick    ///< position: trackId, positionSec, durationSec
+        };
+        enum EndReason : uint8_t { EndOfFile, Stopped, Interrupted, OpenFailed };
+        Type       type;
+        TickType_t tick;
+        union {
+            struct { uint32_t trackId; uint32_t durationSec; } track;
+            struct { uint32_t trackId; uint8_t reason; } ended;
+            struct { uint8_t from; uint8_t to; } source;
+            struct { uint32_t count; } underrun;
+            struct { uint32_t count; } queue;
+            struct { uint32_t trackId; uint32_t positionSec; uint32_t durationSec; } position;
+        };
+    };
+
+    /// Callback вызывается из контекста таска AudioMgr — должен быть коротким.
+    /// Режимы взаимоисключающие: пока callback установлен, события в кольцо
+    /// waitEvent() не попадают. cb и ctx меняются атомарно; вызов, начатый
+    /// до смены, может ещё завершиться со старой парой.
+    using EventCb = void(*)(const Event& ev, void* ctx);
+    void setEventCb(EventCb cb, void* ctx);
+
+    /// Блокирующее чтение из кольца событий (только без callback).
+    /// @return false по таймауту
+    bool waitEvent(Event& out, TickType_t timeout);
+
+    /// Период PositionTick в мс (0 — выключено).
+    void setPositionTickMs(uint32_t ms) { positionTickMs_ = ms; }
+
+    /// Сколько событий потеряно из-за переполнения кольца.
+    [[nodiscard]] uint32_t droppedEvents() const { return eventsDropped_; }
+
     /* ── Статус (lock-free, один writer) ── */
     struct PlayerStatus {
         char     filename[64]{};
@@ -70,6 +164,91 @@ public:
     /// @return количество записанных элементов
     uint8_t getQueueSnapshot(PlayerQueueEntry* out, uint8_t maxEntries) const;
 
+    /* ── Бюджет памяти и контроль аллокаций (для хост-тестов и CI) ── */
+    struct MemBudget {
+        struct Codec {
+            const char* name    = nullptr;
+            uint32_t    object  = 0;  ///< sizeof декодера
+            uint32_t    scratch = 0;  ///< его kScratchBytes
+        };
+        /// Не меньше AudioCodecs::kCount — static_assert в AudioMgr.cpp.
+        static constexpr uint32_t kMaxCodecs = 8;
+
+        uint32_t audioMgr       = 0;  ///< sizeof(AudioMgr) — включает всё до audioHw
+        uint32_t decoderMem     = 0;  ///< placement под набор кодеков
+        uint32_t decoderUsed    = 0;  ///< sizeof(AudioCodecs)
+        uint32_t decoderScratch = 0;
+        uint32_t scratchUsed    = 0;  ///< максимум kScratchBytes по кодекам
+        uint32_t decodeBuf      = 0;
+        uint32_t fsBuf          = 0;
+        uint32_t fsAdapter      = 0;
+        uint32_t pathPool       = 0;
+        uint32_t playlist       = 0;
+        uint32_t resampler      = 0;
+        uint32_t queues         = 0;  ///< хранилища cmd/event очередей
+        uint32_t audioHw        = 0;  ///< sizeof(AudioHw), отдельный синглтон
+        uint32_t ring           = 0;  ///< DMA ring внутри AudioHw
+        uint32_t audioTaskStack = 0;  ///< байт
+        uint32_t decoderStack   = 0;  ///< из них — стек декодера на кадр (kCodecsStackBytes)
+        uint32_t drainTaskStack = 0;  ///< байт
+        uint32_t trace          = 0;  ///< кольцо Trace (0 без AE2_TRACE)
+        uint32_t pcmCache       = 0;  ///< метаданные PcmCache; сам блок — снаружи (setPcmCache)
+        Codec    codecs[kMaxCodecs]{};
+        uint32_t codecCount     = 0;
+    };
+    /// Статический бюджет: все значения известны при компиляции.
+    [[nodiscard]] static MemBudget memoryBudget();
+
+    /// Аллокации кучи из таска AudioMgr внутри pipelineTick_.
+    /// Считаются только в сборке с AE2_ALLOC_GUARD=1 (enabled == true).
+    struct HotAllocStats {
+        bool     enabled   = false;
+        uint32_t allocs    = 0;
+        uint32_t bytes     = 0;
+        uint32_t lastBytes = 0;
+        uint32_t ticks     = 0;  ///< вызовов pipelineTick_ под контролем
+    };
+    [[nodiscard]] static HotAllocStats hotAllocStats();
+    static void resetHotAllocStats();
+
+    /// Здоровье конвейера за окно: с прошлого чтения со сбросом (или с
+    /// инициализации). Счётчики — разности накопленных, без потерь между
+    /// окнами; экстремумы (ring, ожидание, decode) окно начинают со
+    /// следующего тика. Читать можно из любого таска, сбрасывать — одному.
+    struct PipelineStats {
+        uint32_t windowMs    = 0;
+        uint32_t loopIter    = 0;  ///< итераций главного цикла с тиком
+        uint32_t decodes     = 0;  ///< вызовов decode/feed
+        uint32_t direct      = 0;  ///< из них прямо в ring
+        uint32_t residuals   = 0;  ///< тиков на остатке прошлого decode
+        uint32_t truncations = 0;  ///< ring не вместил порцию целиком
+        uint32_t timeouts    = 0;  ///< acquireWrite не дождался места
+        uint32_t waitMs      = 0;  ///< суммарное ожидание в acquireWrite
+        uint32_t maxWaitMs   = 0;
+        uint32_t samplesIn   = 0;
+        uint32_t samplesOut  = 0;
+        uint32_t ringMin     = 0;  ///< сэмплов в ring перед тиком, минимум окна
+        uint32_t ringMax     = 0;
+        uint32_t underruns      = 0;  ///< опустошений ring на стороне DMA за окно
+        uint32_t underrunsTotal = 0;  ///< с запуска
+        uint32_t prebufferMs    = 0;  ///< текущий порог предбуфера (растёт после underrun)
+        /// Стоимость decode кодека, мкс. Перцентили — верхние границы
+        /// log2-корзин (точность ×2), max — точный. Без AE2_PROFILER — 0:
+        /// таймер вокруг decode не читается.
+        uint32_t decodeP50Us = 0;
+        uint32_t decodeP90Us = 0;
+        uint32_t decodeP99Us = 0;
+        uint32_t decodeMaxUs = 0;
+    };
+    [[nodiscard]] PipelineStats pipelineStats(bool reset = true);
+
+    /// Одна итерация главного цикла: команды, тик пайплайна, префетч.
+    /// Обычно вызывается только таском AudioMgr. В сборке AE2_HW_SIM таск
+    /// не создаётся, и цикл крутит тест: runOnce(), затем
+    /// AudioHw::simAdvance(1) вместо vTaskDelay(1).
+    /// @return false — источник не выбран, таск спал бы до уведомления
+    bool runOnce();
+
 	AudioMgr(const AudioMgr&) = delete;
     AudioMgr& operator=(const AudioMgr&) = delete;
 
@@ -81,16 +260,26 @@ public:
             Activate, Deactivate,
             SetVolume, SetSampleRate,
             VolumeChanged,
-            RemoveQueueItem
+            RemoveQueueItem,
+            PlayPlaylist,
+            SetRawFormat,
+            SetRatePolicy,
+            SetPcmCache,
+            DropPcmCache
         };
         Type type;
         union {
-            struct { char path[128]; uint32_t startSec; uint8_t output; } file;
+            struct { uint16_t pathId; uint32_t startSec; uint8_t output; } file;  ///< pathId — ссылка в PathPool
             struct { uint8_t srcId; uint8_t output; } source;
             struct { uint8_t srcId; uint8_t vol; } volume;
             struct { uint32_t sec; } seek;
             struct { uint32_t rate; } sampleRate;
+            struct { uint8_t policy; } ratePolicy;
+            struct { uint32_t rate; uint8_t channels; } rawFormat;
             struct { uint32_t trackId; } remove;
+            struct { uint16_t pathId; uint8_t output; uint8_t shuffle; uint32_t seed; } playlist;
+            struct { void* mem; uint32_t bytes; uint32_t maxFileBytes; uint8_t preResample; } pcmCache;
+            struct { uint16_t pathId; } pcmDrop;  ///< kInvalid — весь кэш
         };
     };
 
@@ -98,7 +287,7 @@ private:
     AudioMgr();
     ~AudioMgr() = default;
 
-    static void sendCmd_(QueueHandle_t q, const Cmd& cmd);
+    static bool sendCmd_(QueueHandle_t q, const Cmd& cmd);
 
     QueueHandle_t cmdQueue_ = nullptr;
     static constexpr uint32_t kCmdQueueDepth = 32;
@@ -106,6 +295,9 @@ private:
     uint8_t cmdQueueStorage_[kCmdQueueDepth * sizeof(Cmd)]{};
 
     /* ── Таск ── */
+    /// В StackType_t: 20 КБ конвейера плюс стек декодера на кадр
+    /// (minimp3 кладёт туда ~16 КБ scratch, см. kCodecsStackBytes).
+    static constexpr uint32_t kTaskStackDepth = 1024 * 5 + kCodecsStackBytes / sizeof(StackType_t);
     TaskHandle_t task_ = nullptr;
     static void taskEntry_(void* arg);
     void taskLoop_();
@@ -127,57 +319,117 @@ private:
     enum class PlayerState : uint8_t { Stopped, PlayWaiting, Playing, Paused };
     PlayerState playerState_ = PlayerState::Stopped;
 
+    /* ── Пути (интернированы, очередь хранит только Id) ── */
+    alignas(4) uint8_t pathPoolMem_[5504]{};  ///< placement-хранилище для PathPool
+    PathPool* paths_ = nullptr;
+
     struct QueueEntry {
-        char     path[128]{};
-        uint32_t startSec = 0;
+        uint16_t path     = 0;  ///< PathPool::Id, владеет одной ссылкой
         Output   output   = Output::FrontSpeaker;
         bool     used     = false;
+        uint32_t startSec = 0;
         uint32_t trackId  = 0;  ///< Стабильный ID трека (0 = невалидный)
     };
-    static constexpr uint32_t kMaxQueue = 16;
+    static constexpr uint32_t kMaxQueue = 128;
     QueueEntry queue_[kMaxQueue]{};
     uint32_t queueHead_ = 0;
     uint32_t queueTail_ = 0;
     uint32_t queueCount_ = 0;
 
     uint32_t nextTrackId_ = 1;  ///< Следующий ID трека (инкрементный)
-    bool queuePush_(const char* path, uint32_t startSec, Output out);
-    bool queuePushFront_(const char* path, uint32_t startSec, Output out);
+    /// Push забирает ссылку pathId только при успехе.
+    bool queuePush_(uint16_t pathId, uint32_t startSec, Output out);
+    bool queuePushFront_(uint16_t pathId, uint32_t startSec, Output out);
     bool queuePop_(QueueEntry& out);
     void queueClear_();
     bool queueRemoveById_(uint32_t trackId);
 
+    /* ── Плейлист (источник после queue_) ── */
+    alignas(8) uint8_t playlistMem_[1792]{};  ///< placement-хранилище для Playlist
+    Playlist* playlist_ = nullptr;
+    Output playlistOutput_ = Output::FrontSpeaker;
+    /// PlayWaiting: следующий элемент плейлиста пока недоступен (PathPool
+    /// занят очередью, подсчёт shuffle ещё ничего не нашёл) или
+    /// startNextTrack_ исчерпал kStartAttempts — runOnce повторяет.
+    static constexpr uint32_t kPlaylistRetryMs   = 100;
+    static constexpr uint32_t kPlaylistScanBudget = 8;  ///< элементов подсчёта за итерацию
+    TickType_t playlistRetryAt_ = 0;
+    /// unplayable — probeStep уже нашёл, что файл не откроется или его
+    /// кодек не в сборке.
+    bool playlistNext_(QueueEntry& out, bool& unplayable);
+    void playlistWait_();
+    [[nodiscard]] bool hasPendingTracks_() const;
+
     /* ── Текущий трек ── */
-    char   currentPath_[128]{};                 ///< Путь текущего воспроизводимого файла
+    uint16_t currentPath_ = 0;                  ///< PathPool::Id текущего воспроизводимого файла
+    char   pathBuf_[256]{};                     ///< Развёрнутый путь для fopen/логов (только таск AudioMgr)
     Output currentOutput_{Output::FrontSpeaker}; ///< Выход текущего воспроизводимого файла
 
     /* ── Декодер ── */
-    alignas(16) uint8_t decoderMem_[8192]{};
-    DecoderBase* decoder_  = nullptr;
+    alignas(16) uint8_t decoderMem_[kCodecsMemBytes]{};  ///< placement-хранилище для AudioCodecs
+    AudioCodecs* codecs_   = nullptr;         ///< активный кодек; decode/sampleRate — без vtable
+    DecoderBase* decoder_  = nullptr;         ///< он же через базу — для холодного пути
+    alignas(16) uint8_t decoderScratch_[kCodecsScratchBytes]{};  ///< общий scratch кодеков
+    uint32_t rawG711Rate_     = 8000;
+    uint32_t dacRate_         = 128000;           ///< setSampleRate(): частота или потолок
+    RatePolicy ratePolicy_    = RatePolicy::Fixed;
+    [[nodiscard]] uint32_t wantedDacRate_() const;
+    void applyDacRate_();
+    uint8_t  rawG711Channels_ = 1;
     uint8_t fsBuf_[4096]{};
     alignas(8) uint8_t fsMem_[1152]{};  ///< placement-хранилище для FsAdapter
     FsAdapter* fs_ = nullptr;
 
     /* ── Буферы пайплайна ── */
+    static constexpr uint32_t kDecodeChunk = 1024;  ///< сэмплов за один decode/feed
     s16 decodeBuf_[2048]{};
     uint32_t residualCount_{0};      ///< необработанных сэмплов с прошлого тика
     uint32_t residualOffset_{0};     ///< смещение в decodeBuf_
     uint32_t residualSampleRate_{0}; ///< частота дискретизации остатка
 
     /* ── Диагностика пайплайна ── */
+    /// Счётчики накопительные (окна — разностью в pipelineStats), кроме
+    /// экстремумов: их сбрасывает таск по pipeStatsReset_. Таск пишет
+    /// pipeStats_ и раз в итерацию публикует копию под seqlock; читатели
+    /// видят только копию, целиком из одной итерации.
+    static constexpr uint32_t kDecodeBuckets = 33;  ///< = Profiler::kBuckets
     struct PipeStats {
         uint32_t loopIter    = 0; ///< итерации главного цикла
         uint32_t decodes     = 0; ///< вызовы decode
+        uint32_t direct      = 0; ///< из них прямо в ring, без decodeBuf_
         uint32_t residuals   = 0; ///< использования остатка
         uint32_t truncations = 0; ///< раз usable < decoded
         uint32_t timeouts    = 0; ///< таймаут acquireWrite
         uint32_t waitTicks   = 0; ///< суммарное ожидание в acquireWrite (тики)
-        uint32_t maxWait     = 0; ///< макс. ожидание за период (тики)
+        uint32_t maxWait     = 0; ///< макс. ожидание за окно (тики)
         uint32_t samplesIn   = 0; ///< входных сэмплов обработано
         uint32_t samplesOut  = 0; ///< выходных сэмплов записано
+        uint32_t ringMin     = UINT32_MAX; ///< заполнение ring перед тиком, за окно
+        uint32_t ringMax     = 0;
+        uint32_t decodeMax   = 0; ///< тики Profiler::now(), за окно
+        uint32_t decodeHist[kDecodeBuckets]{};  ///< log2-корзины стоимости decode
     } pipeStats_;
+    PipeStats  pipeStatsPub_;                ///< копия для читателей
+    volatile uint32_t pipeStatsSeq_ = 0;     ///< seqlock pipeStatsPub_: нечётный — таск пишет
+    void publishPipeStats_();
+    PipeStats  pipeStatsBase_;               ///< снимок на начало окна (читатель)
+    TickType_t pipeStatsSince_ = 0;
+    uint32_t   underrunsBase_  = 0;
+    volatile bool pipeStatsReset_ = false;   ///< читатель → таск: сбросить экстремумы
+    void noteDecodeCost_(uint32_t ticks);
     TickType_t lastPipeStatsLog_ = 0;
 
+    /* ── Кэш PCM ── */
+    alignas(8) uint8_t pcmCacheMem_[448]{};  ///< placement-хранилище для PcmCache
+    PcmCache* pcmCache_ = nullptr;
+    uint32_t pcmCacheMaxFile_ = 0;
+    bool     pcmCachePreResample_ = false;
+    uint32_t fillRate_    = 0;  ///< частота декодера заполняемой записи
+    uint32_t fillOutRate_ = 0;  ///< частота самой записи (DAC при preResample)
+    void beginCacheFill_();
+    void cacheFill_(const s16* pcm, uint32_t n);
+    void finishCacheFill_();
+
     /* ── Ресемплер ── */
     alignas(4) uint8_t resamplerMem_[32]{};  ///< placement-хранилище для Resampler
     void* resampler_ = nullptr;
@@ -186,8 +438,16 @@ private:
     void processCommands_();
     void routerUpdate_();
     void switchSource_(SrcId newId);
+    /// Следующий трек из очереди/плейлиста; неоткрывшиеся пропускаются
+    /// (TrackEnded(OpenFailed)), не больше kStartAttempts за вызов.
     void startNextTrack_();
+    /// Одна попытка. false — элемент не открылся, брать следующий.
+    bool tryStartTrack_();
+    static constexpr uint32_t kStartAttempts = 8;
     void pipelineTick_();
+    bool directTick_();
+    void applyVolume_(s16* buf, uint32_t n);
+    void checkUnderrun_();
 
     /// True, если в данный момент DAC занят не-Player источником
     /// (роутер вытеснил плеер по приоритету, например AdcDirect).
@@ -205,6 +465,8 @@ private:
     PlayerQueueEntry queueSnapshot_[PLAYER_MAX_QUEUE]{};
     uint32_t currentTrackId_ = 0;  ///< trackId текущего воспроизводимого трека
     void updateStatus_();
+    void clearCurrentPath_();
+    void destroyDecoder_();
 
     bool initialized_ = false;
     TickType_t lastProgressLog_ = 0;  ///< Тик последнего лога прогресса
@@ -213,6 +475,22 @@ private:
     RearOutputCb rearOutputCb_ = nullptr;
     bool rearOutputActive_ = false;
     void notifyRearOutput_(bool active);
+
+    /* ── События ── */
+    QueueHandle_t eventQueue_ = nullptr;
+    static constexpr uint32_t kEventQueueDepth = 32;
+    StaticQueue_t eventQueueBuf_{};
+    uint8_t eventQueueStorage_[kEventQueueDepth * sizeof(Event)]{};
+    EventCb eventCb_ = nullptr;        ///< пара cb/ctx — под критической секцией
+    void*   eventCbCtx_ = nullptr;
+    volatile uint32_t eventsDropped_ = 0;
+    volatile uint32_t positionTickMs_ = 0;
+    TickType_t lastPositionTick_ = 0;
+    uint32_t queueRev_ = 0;            ///< инкремент при любом изменении очереди
+    uint32_t queueRevNotified_ = 0;    ///< последняя ревизия, о которой сообщили
+    uint32_t underrunCount_ = 0;       ///< последний AudioHw::underruns(), о котором сообщили
+    void postEvent_(Event& ev);
+    void postTrackEnded_(uint8_t reason);
 };
 
 } // namespace ae2
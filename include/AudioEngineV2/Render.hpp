@@ -0,0 +1,86 @@
+#pragma once
+/// @file Render.hpp
+/// @brief Офлайн-рендер очереди файлов: decode → volume → resample без AudioHw.
+///
+/// Тот же конвейер, что у AudioMgr, но без ring и темпа DAC — со скоростью
+/// CPU. Для golden-тестов связок декодер/ресемплер и для пререндера
+/// подсказок на частоте DAC. Объект самодостаточен (~26 КБ буферов внутри),
+/// не зависит от AudioMgr и может работать в любом таске — со стеком не
+/// меньше kCodecsStackBytes сверх своего (minimp3 берёт scratch кадра там).
+
+#include "AudioEngineV2/Types.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace ae2 {
+
+class AudioCodecs;
+class FsAdapter;
+class Resampler;
+
+class Render {
+public:
+    struct Options {
+        uint32_t outRate         = 128000;  ///< частота результата (частота DAC)
+        uint8_t  volume          = 7;       ///< индекс kVolumeTable, 7 — без изменений
+        bool     linear          = true;    ///< интерполяция ресемплера (false — nearest)
+        uint32_t rawG711Rate     = 8000;    ///< формат headerless .alaw/.ulaw
+        uint8_t  rawG711Channels = 1;
+    };
+
+    /// Приёмник моно s16 на outRate. false — остановить рендер.
+    struct Sink {
+        bool (*write)(void* ctx, const s16* pcm, uint32_t n);
+        void* ctx;
+    };
+
+    struct Stats {
+        uint32_t tracks     = 0;  ///< отрисовано файлов
+        uint32_t failed     = 0;  ///< не открылись / неизвестный кодек
+        uint64_t inSamples  = 0;  ///< сэмплов с декодеров
+        uint64_t outSamples = 0;  ///< сэмплов в sink
+        uint64_t audioUs    = 0;  ///< длительность результата
+        uint64_t wallUs     = 0;  ///< затраченное время
+        [[nodiscard]] float xRealtime() const {
+            return wallUs ? (float)audioUs / (float)wallUs : 0.0f;
+        }
+    };
+
+    Render();
+    ~Render();
+    Render(const Render&) = delete;
+    Render& operator=(const Render&) = delete;
+
+    /// Отрисовать файлы по порядку в sink.
+    /// @return true, если все файлы отрисованы и sink принял всё
+    bool renderQueue(const char* const* paths, uint32_t count, const Options& opt,
+                     Sink sink, Stats* stats = nullptr);
+
+    /// В WAV (PCM 16 бит, моно, opt.outRate).
+    bool renderToWav(const char* const* paths, uint32_t count, const char* wavPath,
+                     const Options& opt, Stats* stats = nullptr);
+
+    /// В память. Не поместившееся отбрасывается, рендер возвращает false.
+    bool renderToMemory(const char* const* paths, uint32_t count, s16* buf, uint32_t cap,
+                        uint32_t* written, const Options& opt, Stats* stats = nullptr);
+
+private:
+    static constexpr uint32_t kInChunk  = 1024;  ///< как AudioMgr::kDecodeChunk
+    static constexpr uint32_t kOutChunk = 2048;  ///< как kMaxAcquire пайплайна
+
+    bool renderTrack_(const char* path, const Options& opt, Sink sink, Stats& st);
+
+    alignas(16) uint8_t codecsMem_[kCodecsMemBytes]{};  ///< placement-хранилище для AudioCodecs
+    alignas(16) uint8_t scratch_[kCodecsScratchBytes]{};  ///< общий scratch кодеков
+    alignas(8)  uint8_t fsMem_[1152]{};       ///< placement-хранилище для FsAdapter
+    alignas(4)  uint8_t resamplerMem_[32]{};  ///< placement-хранилище для Resampler
+    uint8_t fsBuf_[4096]{};
+    s16     inBuf_[kInChunk]{};
+    s16     outBuf_[kOutChunk]{};
+
+    AudioCodecs* codecs_    = nullptr;
+    FsAdapter*   fs_        = nullptr;
+    Resampler*   resampler_ = nullptr;
+};
+
+} // namespace ae2
@@ -7,6 +7,71 @@ namespace ae2 {
 using s16 = int16_t;
 using u16 = uint16_t;
 
+/* Набор кодеков сборки (AudioMgr/AudioCodecs.hpp): -DAE2_CODEC_<NAME>=0
+ * отключает кодек. Умолчания здесь, а не в AudioCodecs.hpp: размеры ниже
+ * следуют за тем же набором. Макросы — на всю сборку, как AE2_MP3_MINIMP3. */
+#ifndef AE2_CODEC_MP3
+#  define AE2_CODEC_MP3 1
+#endif
+#ifndef AE2_MP3_MINIMP3
+#  define AE2_MP3_MINIMP3 0
+#endif
+#ifndef AE2_CODEC_FLAC
+#  define AE2_CODEC_FLAC 1
+#endif
+#ifndef AE2_CODEC_ADPCM
+#  define AE2_CODEC_ADPCM 1
+#endif
+#ifndef AE2_CODEC_MSADPCM
+#  define AE2_CODEC_MSADPCM 1
+#endif
+#ifndef AE2_CODEC_G711
+#  define AE2_CODEC_G711 1
+#endif
+
+/// sizeof кодеков на 64-битном хосте. На 32-битной цели объект меньше
+/// (короче указатели), но не больше чем на kCodecsMemSlack. AudioCodecs.hpp
+/// проверяет каждую включённую строку static_assert'ом в обе стороны:
+/// правка декодера без правки таблицы — ошибка сборки.
+namespace codec_mem {
+static constexpr uint32_t kWavPcm   = 56;
+static constexpr uint32_t kRamPcm   = 40;
+static constexpr uint32_t kMp3      = AE2_CODEC_MP3 ? (AE2_MP3_MINIMP3 ? 6752 : 4200) : 0;
+static constexpr uint32_t kFlac     = AE2_CODEC_FLAC ? 1504 : 0;
+static constexpr uint32_t kAdpcm    = AE2_CODEC_ADPCM ? 96 : 0;
+static constexpr uint32_t kMsAdpcm  = AE2_CODEC_MSADPCM ? 240 : 0;
+static constexpr uint32_t kG711     = AE2_CODEC_G711 ? 56 : 0;
+
+constexpr uint32_t max(uint32_t a, uint32_t b) { return a > b ? a : b; }
+static constexpr uint32_t kLargest =
+    max(max(max(kWavPcm, kRamPcm), max(kMp3, kFlac)), max(max(kAdpcm, kMsAdpcm), kG711));
+} // namespace codec_mem
+
+/// Допуск таблицы codec_mem: разница sizeof между 64-битным хостом и
+/// 32-битной целью.
+static constexpr uint32_t kCodecsMemSlack = 64;
+
+/// Байт placement-хранилища AudioCodecs (AudioMgr, Render): самый большой
+/// включённый кодек плюс байт индекса, с выравниванием 8 (CodecSet).
+/// Отключённый AE2_CODEC_* кодек освобождает свою память.
+///
+/// kCodecsStackBytes — стек, который декодер сверх обычного берёт у
+/// вызывающего таска на кадр: mp3dec_scratch_t minimp3 (~16 КБ, локальная
+/// переменная mp3dec_decode_frame). Helix и остальные кодеки держат всё в
+/// объекте и scratch. Проверяется static_assert в minimp3_impl.c.
+static constexpr uint32_t kCodecsMemBytes   = (codec_mem::kLargest + 1 + 7) & ~7u;
+static constexpr uint32_t kCodecsStackBytes = (AE2_CODEC_MP3 && AE2_MP3_MINIMP3) ? 16384 : 0;
+
+/// Байт общего scratch кодеков (decoderScratch_ AudioMgr, scratch_ Render) —
+/// максимум kScratchBytes включённых: кадр PCM Helix (4608), кадр и вход
+/// minimp3 (8192), блок FLAC (8192); остальным scratch не нужен, буфер — не
+/// меньше 16 байт. AudioCodecs.hpp требует точного совпадения: и нехватка,
+/// и лишняя память — ошибка сборки.
+static constexpr uint32_t kCodecsScratchBytes =
+    codec_mem::max(codec_mem::max(AE2_CODEC_MP3 ? (AE2_MP3_MINIMP3 ? 8192u : 4608u) : 0u,
+                                  AE2_CODEC_FLAC ? 8192u : 0u),
+                   16u);
+
 /// Логический аудиовыход
 enum class Output : uint8_t {
     FrontSpeaker = 0,
@@ -0,0 +1,134 @@
+/// @file AllocGuard.cpp
+#include "AllocGuard.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace ae2 {
+
+#if AE2_ALLOC_GUARD
+
+namespace {
+/* Пишет только таск-владелец Scope; читатели stats() видят слегка
+ * устаревшие значения — для диагностики достаточно. */
+TaskHandle_t      gOwner = nullptr;
+volatile uint32_t gAllocs = 0;
+volatile uint32_t gBytes  = 0;
+volatile uint32_t gLast   = 0;
+volatile uint32_t gScopes = 0;
+} // namespace
+
+void AllocGuard::enter_() {
+    gOwner = xTaskGetCurrentTaskHandle();
+    gScopes = gScopes + 1;
+}
+
+void AllocGuard::leave_() { gOwner = nullptr; }
+
+void AllocGuard::note(size_t bytes) {
+    if (!gOwner || xTaskGetCurrentTaskHandle() != gOwner) return;
+#if AE2_ALLOC_GUARD_TRAP
+#  ifdef configASSERT
+    configASSERT(!"heap allocation on audio hot path");
+#  else
+    __builtin_trap();
+#  endif
+#endif
+    gAllocs = gAllocs + 1;
+    gBytes  = gBytes + (uint32_t)bytes;
+    gLast   = (uint32_t)bytes;
+}
+
+AllocGuard::Stats AllocGuard::stats() {
+    Stats s;
+    s.allocs    = gAllocs;
+    s.bytes     = gBytes;
+    s.lastBytes = gLast;
+    s.scopes    = gScopes;
+    return s;
+}
+
+void AllocGuard::resetStats() { gAllocs = gBytes = gLast = gScopes = 0; }
+
+#else
+
+void AllocGuard::note(size_t) {}
+AllocGuard::Stats AllocGuard::stats() { return {}; }
+void AllocGuard::resetStats() {}
+
+#endif
+
+} // namespace ae2
+
+extern "C" void aeAllocGuardNote(size_t bytes) { ae2::AllocGuard::note(bytes); }
+
+#if AE2_ALLOC_GUARD
+
+/* ── Замена глобальных operator new/delete ── */
+
+static void* guardedAlloc(size_t n) {
+    ae2::AllocGuard::note(n);
+    return std::malloc(n ? n : 1);
+}
+
+void* operator new(size_t n) {
+    void* p = guardedAlloc(n);
+    if (!p) std::abort();
+    return p;
+}
+void* operator new[](size_t n) { return operator new(n); }
+void* operator new(size_t n, const std::nothrow_t&) noexcept { return guardedAlloc(n); }
+void* operator new[](size_t n, const std::nothrow_t&) noexcept { return guardedAlloc(n); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+#if defined(__cpp_aligned_new)
+
+/* Выровненные (alignas больше __STDCPP_DEFAULT_NEW_ALIGNMENT__): malloc с
+ * запасом, исходный указатель лежит сразу перед выдаваемым блоком */
+static void* guardedAlignedAlloc(size_t n, std::align_val_t al) {
+    ae2::AllocGuard::note(n);
+    const size_t a = (size_t)al < sizeof(void*) ? sizeof(void*) : (size_t)al;
+    void* raw = std::malloc((n ? n : 1) + a - 1 + sizeof(void*));
+    if (!raw) return nullptr;
+    const uintptr_t p = ((uintptr_t)raw + sizeof(void*) + a - 1) & ~(uintptr_t)(a - 1);
+    reinterpret_cast<void**>(p)[-1] = raw;
+    return reinterpret_cast<void*>(p);
+}
+
+static void guardedAlignedFree(void* p) {
+    if (p) std::free(reinterpret_cast<void**>(p)[-1]);
+}
+
+void* operator new(size_t n, std::align_val_t al) {
+    void* p = guardedAlignedAlloc(n, al);
+    if (!p) std::abort();
+    return p;
+}
+void* operator new[](size_t n, std::align_val_t al) { return operator new(n, al); }
+void* operator new(size_t n, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return guardedAlignedAlloc(n, al);
+}
+void* operator new[](size_t n, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return guardedAlignedAlloc(n, al);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept { guardedAlignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { guardedAlignedFree(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { guardedAlignedFree(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { guardedAlignedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    guardedAlignedFree(p);
+}
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    guardedAlignedFree(p);
+}
+
+#endif // __cpp_aligned_new
+
+#endif
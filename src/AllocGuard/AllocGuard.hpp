@@ -0,0 +1,68 @@
+#pragma once
+/// @file AllocGuard.hpp
+/// @brief Контроль «нуля аллокаций» на hot path таска AudioMgr.
+///
+/// Режим инструментирования, по умолчанию выключен. При AE2_ALLOC_GUARD=1
+/// глобальные operator new/delete заменяются, включая выровненные
+/// (std::align_val_t) и nothrow. Аллокация, сделанная тем
+/// таском, что открыл Scope, пока Scope жив, считается нарушением.
+/// C-аллокации (malloc Helix, pvPortMalloc) сообщаются через
+/// aeAllocGuardNote(): из traceMALLOC в FreeRTOSConfig.h или из обёртки
+/// -Wl,--wrap=malloc. При AE2_ALLOC_GUARD_TRAP=1 нарушение — configASSERT
+/// (без него __builtin_trap), а не счётчик.
+///
+/// Без флага Scope пустой, stats() всегда нулевой.
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <cstddef>
+#include <cstdint>
+
+#ifndef AE2_ALLOC_GUARD
+#  define AE2_ALLOC_GUARD 0
+#endif
+#ifndef AE2_ALLOC_GUARD_TRAP
+#  define AE2_ALLOC_GUARD_TRAP 0
+#endif
+
+extern "C" void aeAllocGuardNote(size_t bytes);
+
+namespace ae2 {
+
+class AllocGuard {
+public:
+    struct Stats {
+        uint32_t allocs    = 0;  ///< аллокаций внутри Scope
+        uint32_t bytes     = 0;  ///< их суммарный размер
+        uint32_t lastBytes = 0;  ///< размер последней — для поиска источника
+        uint32_t scopes    = 0;  ///< сколько раз Scope открывался
+    };
+
+    static constexpr bool kEnabled = AE2_ALLOC_GUARD != 0;
+
+    /// Отмечает участок hot path текущего таска. Не вкладывается.
+    class Scope {
+    public:
+#if AE2_ALLOC_GUARD
+        Scope()  { AllocGuard::enter_(); }
+        ~Scope() { AllocGuard::leave_(); }
+#else
+        Scope()  {}
+        ~Scope() {}  // нетривиальный — без -Wunused-variable в месте использования
+#endif
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    [[nodiscard]] static Stats stats();
+    static void resetStats();
+
+    /// Учесть аллокацию bytes байт (вызывается из перехватчиков).
+    static void note(size_t bytes);
+
+private:
+    static void enter_();
+    static void leave_();
+};
+
+} // namespace ae2
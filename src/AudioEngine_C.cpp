@@ -2,10 +2,63 @@
 /// @brief C-обёртки AudioEngineV2.
 #include "AudioEngineV2/AudioEngine_C.h"
 #include "AudioEngineV2/AudioMgr.hpp"
+#include "AudioHw/AudioHw.hpp"
+#include "Trace/Trace.hpp"
 #include <cstring>
 
 using namespace ae2;
 
+namespace {
+
+void toC(const AudioMgr::Event& ev, ae_event_t* out) {
+    std::memset(out, 0, sizeof(*out));
+    out->type = (ae_event_type_t)ev.type;
+    out->tick = (uint32_t)ev.tick;
+    switch (ev.type) {
+        case AudioMgr::Event::TrackStarted:
+            out->track_id = ev.track.trackId;
+            out->arg0     = ev.track.durationSec;
+            break;
+        case AudioMgr::Event::TrackEnded:
+            out->track_id = ev.ended.trackId;
+            out->arg0     = ev.ended.reason;
+            break;
+        case AudioMgr::Event::SourceSwitched:
+            out->arg0 = ev.source.from;
+            out->arg1 = ev.source.to;
+            break;
+        case AudioMgr::Event::Underrun:
+            out->arg0 = ev.underrun.count;
+            break;
+        case AudioMgr::Event::QueueChanged:
+            out->arg0 = ev.queue.count;
+            break;
+        case AudioMgr::Event::PositionTick:
+            out->track_id = ev.position.trackId;
+            out->arg0     = ev.position.positionSec;
+            out->arg1     = ev.position.durationSec;
+            break;
+        default:
+            break;
+    }
+}
+
+/* Пара C-callback — одним снимком в трамплине; ctx AudioMgr не нужен */
+ae_event_cb_t s_eventCb  = nullptr;
+void*         s_eventCtx = nullptr;
+
+void eventTrampoline(const AudioMgr::Event& ev, void*) {
+    taskENTER_CRITICAL();
+    const ae_event_cb_t cb  = s_eventCb;
+    void* const         ctx = s_eventCtx;
+    taskEXIT_CRITICAL();
+    ae_event_t c;
+    toC(ev, &c);
+    if (cb) cb(&c, ctx);
+}
+
+} // namespace
+
 extern "C" {
 
 void aeInit(void) {
@@ -24,6 +77,12 @@ void aePlayerPlayFileImmediately(const char* path, bool front) {
     AudioMgr::instance().addFile(path, 0, out, true);
 }
 
+void aePlayerPlayList(const char* path, bool shuffle, uint32_t seed, bool front) {
+    if (!path) return;
+    Output out = front ? Output::FrontSpeaker : Output::RearLineout;
+    AudioMgr::instance().playPlaylist(path, shuffle, seed, out);
+}
+
 void aePlayerPlay(void)    { AudioMgr::instance().play(); }
 void aePlayerPause(void)   { AudioMgr::instance().pause(); }
 void aePlayerStop(void)    { AudioMgr::instance().stop(); }
@@ -70,6 +129,11 @@ void aeSetSampleRateParam(int param) {
     AudioMgr::instance().setSampleRate(rate);
 }
 
+void aeSetNativeRate(bool enable) {
+    AudioMgr::instance().setRatePolicy(enable ? AudioMgr::RatePolicy::NativeMultiple
+                                              : AudioMgr::RatePolicy::Fixed);
+}
+
 void aeVolumeChanged(void) {
     AudioMgr::instance().volumeChanged();
 }
@@ -78,4 +142,101 @@ void aeSetVolume(ae_pipe_id_t id, uint8_t vol) {
     AudioMgr::instance().setVolume((SrcId)id, vol);
 }
 
+void aeSetPrebuffer(uint32_t start_ms, uint32_t max_ms) {
+    AudioMgr::instance().setPrebuffer(start_ms, max_ms);
+}
+
+void aeSetRawG711Format(uint32_t rate, uint8_t channels) {
+    AudioMgr::instance().setRawG711Format(rate, channels);
+}
+
+void aePcmCacheSetup(void* mem, uint32_t bytes, uint32_t max_file_bytes, bool pre_resample) {
+    AudioMgr::PcmCacheConfig c;
+    c.mem          = mem;
+    c.bytes        = bytes;
+    c.maxFileBytes = max_file_bytes;
+    c.preResample  = pre_resample;
+    AudioMgr::instance().setPcmCache(c);
+}
+
+void aePcmCacheInvalidate(const char* path) {
+    AudioMgr::instance().invalidatePcmCache(path);
+}
+
+void aePcmCacheStats(ae_pcm_cache_stats_t* st) {
+    if (!st) return;
+    auto s = AudioMgr::instance().pcmCacheStats();
+    st->capacity  = s.capacity;
+    st->used      = s.used;
+    st->entries   = s.entries;
+    st->hits      = s.hits;
+    st->misses    = s.misses;
+    st->fills     = s.fills;
+    st->aborts    = s.aborts;
+    st->evictions = s.evictions;
+}
+
+bool aeEventWait(ae_event_t* ev, uint32_t timeout_ms) {
+    if (!ev) return false;
+    AudioMgr::Event e{};
+    TickType_t to = (timeout_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    if (!AudioMgr::instance().waitEvent(e, to)) return false;
+    toC(e, ev);
+    return true;
+}
+
+void aeEventSetCallback(ae_event_cb_t cb, void* ctx) {
+    taskENTER_CRITICAL();
+    s_eventCb  = cb;
+    s_eventCtx = ctx;
+    taskEXIT_CRITICAL();
+    AudioMgr::instance().setEventCb(cb ? eventTrampoline : nullptr, nullptr);
+}
+
+void aeEventSetPositionTick(uint32_t period_ms) {
+    AudioMgr::instance().setPositionTickMs(period_ms);
+}
+
+uint32_t aeEventDropped(void) {
+    return AudioMgr::instance().droppedEvents();
+}
+
+void aePipelineStats(ae_pipeline_stats_t* st, bool reset) {
+    if (!st) return;
+    auto s = AudioMgr::instance().pipelineStats(reset);
+    st->window_ms       = s.windowMs;
+    st->loop_iter       = s.loopIter;
+    st->decodes         = s.decodes;
+    st->direct          = s.direct;
+    st->residuals       = s.residuals;
+    st->truncations     = s.truncations;
+    st->timeouts        = s.timeouts;
+    st->wait_ms         = s.waitMs;
+    st->max_wait_ms     = s.maxWaitMs;
+    st->samples_in      = s.samplesIn;
+    st->samples_out     = s.samplesOut;
+    st->ring_min        = s.ringMin;
+    st->ring_max        = s.ringMax;
+    st->ring_size       = AudioHw::RingSize;
+    st->underruns       = s.underruns;
+    st->underruns_total = s.underrunsTotal;
+    st->prebuffer_ms    = s.prebufferMs;
+    st->decode_p50_us   = s.decodeP50Us;
+    st->decode_p90_us   = s.decodeP90Us;
+    st->decode_p99_us   = s.decodeP99Us;
+    st->decode_max_us   = s.decodeMaxUs;
+}
+
+void aeTraceEnable(bool enable) {
+    Trace::setEnabled(enable);
+}
+
+void aeTraceClear(void) {
+    Trace::clear();
+}
+
+bool aeTraceDumpChrome(const char* path) {
+    return Trace::exportChromeFile(path);
+}
+
 } /* extern "C" */
@@ -24,10 +24,16 @@ void AudioHw::start() {
     if (started_) return;
     writePos_.store(0, std::memory_order_relaxed);
     readPos_.store(0, std::memory_order_relaxed);
-    started_ = true;
+    primed_.store(false, std::memory_order_relaxed);
+    gated_      = true;
+    starved_    = false;
+    resumeFade_ = false;
+    started_    = true;
+#if !AE2_HW_SIM
     if (!drainTask_) {
-        xTaskCreateInRegion(RegionAlloc::Zone::HEAP_ZONE_FAST, drainEntry_, "AeHwDrain", 1024, this, PRIO_TASK_AUDIO_HW_DRAIN, &drainTask_);
+        xTaskCreateInRegion(RegionAlloc::Zone::HEAP_ZONE_FAST, drainEntry_, "AeHwDrain", kDrainStackDepth, this, PRIO_TASK_AUDIO_HW_DRAIN, &drainTask_);
     }
+#endif
 }
 
 void AudioHw::stop() {
@@ -46,7 +52,7 @@ AudioHw::WriteRegion AudioHw::acquireWrite(uint32_t minSamples, TickType_t timeo
     TickType_t waited = 0;
     while (freeSpace() < minSamples) {
         if (!started_ || waited >= timeout) return wr;
-        vTaskDelay(1);
+        waitTick_();
         waited++;
     }
     uint32_t w = writePos_.load(std::memory_order_relaxed);
@@ -68,22 +74,114 @@ AudioHw::WriteRegion AudioHw::acquireWrite(uint32_t minSamples, TickType_t timeo
 
 void AudioHw::commitWrite(uint32_t written) {
     uint32_t w = writePos_.load(std::memory_order_relaxed);
+    if (fadeInLeft_ > 0) fadeIn_(w, written);
     writePos_.store((w + written) % RingSize, std::memory_order_release);
+    if (written > 0) primed_.store(true, std::memory_order_relaxed);
 }
 
-void AudioHw::flush(bool fadeOut) {
-    if (fadeOut) {
-        /* Быстрый fade-out: обнуляем последние FadeSamples записанных */
-        uint32_t w = writePos_.load(std::memory_order_relaxed);
-        for (uint32_t i = 0; i < FadeSamples && i < RingSize; ++i) {
-            uint32_t idx = (w >= i + 1) ? (w - i - 1) : (RingSize + w - i - 1);
-            int32_t scale = (int32_t)(FadeSamples - i);
-            ring_[idx] = (s16)((int32_t)ring_[idx] * scale / (int32_t)FadeSamples);
+void AudioHw::setPrebuffer(uint32_t startMs, uint32_t maxMs) {
+    prebufMaxMs_.store(std::max(startMs, maxMs), std::memory_order_relaxed);
+    prebufMs_.store(startMs, std::memory_order_relaxed);
+}
+
+void AudioHw::rampRing_(uint32_t pos, uint32_t n, bool up) {
+    /* Потребитель трогает только ещё не отданные DAC сэмплы — продюсер
+     * пишет за writePos_, сюда не заходит */
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t idx = (pos + i) % RingSize;
+        int32_t scale = (int32_t)(up ? i : n - i);
+        ring_[idx] = (s16)((int32_t)ring_[idx] * scale / (int32_t)n);
+    }
+}
+
+uint32_t AudioHw::admit_(uint32_t want, uint32_t r, uint32_t avail) {
+    consumerMs_++;
+    const bool streaming = primed_.load(std::memory_order_relaxed);
+    if (gated_) {
+        /* Предбуфер; конец потока открывает сразу — короткий звук доиграет */
+        uint32_t need = std::min<uint32_t>(
+            (uint32_t)((uint64_t)prebufMs_.load(std::memory_order_relaxed) * sampleRate_ / 1000),
+            RingSize / 2);
+        if (avail == 0 || (streaming && avail < need)) return 0;
+        gated_ = false;
+        if (resumeFade_) {
+            rampRing_(r, std::min(avail, FadeSamples), true);
+            resumeFade_ = false;
+        }
+    }
+    if (avail >= want) { starved_ = false; return want; }
+
+    /* Недобор: остаток доигрываем с затуханием, ворота закрываются */
+    if (streaming && !starved_) {
+        underruns_.fetch_add(1, std::memory_order_relaxed);
+        /* Повторный underrun вскоре после прошлого — носитель не успевает,
+         * платим задержкой */
+        uint32_t cur = prebufMs_.load(std::memory_order_relaxed);
+        uint32_t max = prebufMaxMs_.load(std::memory_order_relaxed);
+        if (underruns_.load(std::memory_order_relaxed) > 1 &&
+            consumerMs_ - lastUnderrunMs_ < kGrowWindowMs && cur < max)
+            prebufMs_.store(std::min(std::max(cur * 2, 1u), max), std::memory_order_relaxed);
+        lastUnderrunMs_ = consumerMs_;
+        rampRing_(r, avail, false);
+        resumeFade_ = true;
+    }
+    starved_ = true;
+    gated_   = true;
+    return avail;
+}
+
+void AudioHw::fadeOutTail_() {
+    /* Быстрый fade-out: обнуляем последние FadeSamples записанных */
+    uint32_t w = writePos_.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < FadeSamples && i < RingSize; ++i) {
+        uint32_t idx = (w >= i + 1) ? (w - i - 1) : (RingSize + w - i - 1);
+        int32_t scale = (int32_t)(FadeSamples - i);
+        ring_[idx] = (s16)((int32_t)ring_[idx] * scale / (int32_t)FadeSamples);
+    }
+}
+
+void AudioHw::fadeIn_(uint32_t pos, uint32_t count) {
+    uint32_t n = std::min(count, fadeInLeft_);
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t idx = (pos + i) % RingSize;
+        int32_t scale = (int32_t)(FadeSamples - fadeInLeft_);
+        ring_[idx] = (s16)((int32_t)ring_[idx] * scale / (int32_t)FadeSamples);
+        fadeInLeft_--;
+    }
+}
+
+void AudioHw::switchRate(uint32_t rate, TickType_t timeout) {
+    if (rate == sampleRate_) return;
+    if (started_) {
+        fadeOutTail_();
+        TickType_t waited = 0;
+        while (freeSpace() < RingSize - 1 && waited < timeout) {
+            waitTick_();
+            waited++;
         }
+        /* Не успел доиграть — остаток всё равно затух, сбрасываем */
+        uint32_t r = readPos_.load(std::memory_order_acquire);
+        writePos_.store(r, std::memory_order_release);
+        primed_.store(false, std::memory_order_relaxed);
     }
+    setSampleRate(rate);
+    fadeInLeft_ = FadeSamples;
+}
+
+void AudioHw::flush(bool fadeOut) {
+    if (fadeOut) fadeOutTail_();
     /* Сбрасываем write к read */
     uint32_t r = readPos_.load(std::memory_order_acquire);
     writePos_.store(r, std::memory_order_release);
+    primed_.store(false, std::memory_order_relaxed);
+}
+
+void AudioHw::waitTick_() {
+#if AE2_HW_SIM
+    simAdvance(1);
+#else
+    vTaskDelay(1);
+#endif
 }
 
 /* ── Drain-тред ── */
@@ -106,7 +204,7 @@ void AudioHw::drain_() {
         uint32_t r = readPos_.load(std::memory_order_relaxed);
         uint32_t avail = (w >= r) ? (w - r) : (RingSize - r + w);
 
-        uint32_t consume = std::min(samplesToConsume, avail);
+        uint32_t consume = admit_(samplesToConsume, r, avail);
         if (consume > 0) {
             readPos_.store((r + consume) % RingSize, std::memory_order_release);
         }
@@ -114,4 +212,70 @@ void AudioHw::drain_() {
     }
 }
 
+/* ── Симуляция ── */
+
+#if AE2_HW_SIM
+
+void AudioHw::simConfigure(const SimConfig& cfg) {
+    simCfg_     = cfg;
+    simStats_   = {};
+    simAcc_     = 0;
+    simStarved_ = false;
+}
+
+void AudioHw::simAdvance(uint32_t ms) {
+    for (uint32_t i = 0; i < ms; ++i) {
+        simStats_.timeMs++;
+#if AE2_HOST_RTOS
+        vTaskStepTick(1);  /* тики стаба FreeRTOS — те же виртуальные мс */
+#endif
+        if (!started_) continue;
+        /* rate × (1 + ppm·1e-6) / 1000 сэмплов за мс, дробь копится */
+        simAcc_ += (uint64_t)sampleRate_ * (uint64_t)(1000000 + simCfg_.driftPpm);
+        uint32_t n = (uint32_t)(simAcc_ / 1000000000u);
+        simAcc_ %= 1000000000u;
+        simConsume_(n);
+    }
+}
+
+void AudioHw::simStorageRead() {
+    const uint32_t read = simStats_.reads++;
+    if (!simCfg_.readStall) return;
+    const uint32_t ms = simCfg_.readStall(simCfg_.readStallCtx, read);
+    simStats_.stallMs += ms;
+    simAdvance(ms);
+}
+
+void AudioHw::simConsume_(uint32_t n) {
+    uint32_t w = writePos_.load(std::memory_order_acquire);
+    uint32_t r = readPos_.load(std::memory_order_relaxed);
+    uint32_t avail = (w >= r) ? (w - r) : (RingSize - r + w);
+    uint32_t take = n > 0 ? admit_(n, r, avail) : 0;
+
+    if (simCfg_.record && take > 0) {
+        uint32_t first = std::min(take, RingSize - r);
+        simCfg_.record(simCfg_.recordCtx, ring_ + r, first, sampleRate_);
+        if (take > first) simCfg_.record(simCfg_.recordCtx, ring_, take - first, sampleRate_);
+    }
+    readPos_.store((r + take) % RingSize, std::memory_order_release);
+    simStats_.consumed += take;
+
+    uint32_t missing = n - take;
+    if (missing == 0) { simStarved_ = false; return; }
+    /* DAC выдаёт нули, пока ring пуст */
+    if (!simStarved_) simStats_.underruns++;
+    simStarved_ = true;
+    simStats_.underrunSamples += missing;
+    if (simCfg_.record) {
+        static const s16 kZeros[256] = {};
+        while (missing > 0) {
+            uint32_t k = std::min<uint32_t>(missing, 256);
+            simCfg_.record(simCfg_.recordCtx, kZeros, k, sampleRate_);
+            missing -= k;
+        }
+    }
+}
+
+#endif
+
 } // namespace ae2
@@ -1,6 +1,12 @@
 #pragma once
 /// @file AudioHw.hpp
 /// @brief Аппаратный слой: кольцевой буфер + DMA-эмуляция (на хосте — drain-тред).
+///
+/// AE2_HW_SIM=1 — симуляция на виртуальных часах вместо drain-треда: DAC
+/// потребляет сэмплы только в simAdvance() и в ожиданиях acquireWrite /
+/// switchRate, детерминированно и без планировщика. Тест крутит
+/// AudioMgr::runOnce() + simAdvance(1) быстрее реального времени. Со
+/// стабами host/ (AE2_HOST_RTOS) simAdvance двигает и xTaskGetTickCount.
 
 #include "AudioEngineV2/Types.hpp"
 #include "FreeRTOS.h"
@@ -10,6 +16,13 @@
 #include <cstddef>
 #include <cstring>
 
+#ifndef AE2_HW_SIM
+#  define AE2_HW_SIM 0
+#endif
+#ifndef AE2_HOST_RTOS
+#  define AE2_HOST_RTOS 0
+#endif
+
 namespace ae2 {
 
 class AudioHw final {
@@ -20,10 +33,23 @@ public:
     void setSampleRate(uint32_t rate);
 	[[nodiscard]] uint32_t sampleRate() const { return sampleRate_; }
 
+	/// Диапазон частот DAC (таймер DMA делит частоту шины — годится любая).
+	static constexpr uint32_t kMinRate = 8000;
+	static constexpr uint32_t kMaxRate = 192000;
+	[[nodiscard]] static constexpr bool supportsRate(uint32_t rate) {
+		return rate >= kMinRate && rate <= kMaxRate;
+	}
+
+	/// Сменить частоту без щелчка: уже записанный хвост затухает и
+	/// доигрывается (ждём не дольше timeout), затем новая частота, а первые
+	/// FadeSamples следующей записи нарастают от нуля.
+	void switchRate(uint32_t rate, TickType_t timeout);
+
 	void start();
     void stop();
 	[[nodiscard]] bool isStarted() const { return started_; }
 	void ampEnable(bool) {}  ///< Стаб для хоста (нет усилителя)
+	void setOutput(Output) {}  ///< Стаб для хоста (один выход)
 
     /* ── Прямая запись ── */
     struct WriteRegion {
@@ -42,7 +68,61 @@ public:
     /// Сколько свободного места.
 	[[nodiscard]] uint32_t freeSpace() const;
 
+	/// Продюсер закончил поток (пауза, конец очереди, фид иссяк): ring
+	/// доигрывается без ожидания предбуфера, и его опустошение — не
+	/// underrun. Следующий commitWrite снова включает учёт.
+	void endOfStream() { primed_.store(false, std::memory_order_relaxed); }
+	/// Эпизодов underrun на стороне DMA с запуска: ring опустел, пока
+	/// продюсер ещё писал. Монотонный, читается из любого таска.
+	[[nodiscard]] uint32_t underruns() const { return underruns_.load(std::memory_order_relaxed); }
+
+	/// Предбуфер: когда ring опустел (старт, flush, смена частоты, underrun),
+	/// DAC молчит, пока не наберётся startMs звука или продюсер не вызовет
+	/// endOfStream(). Два underrun подряд в пределах kGrowWindowMs удваивают
+	/// порог, но не выше maxMs (maxMs == startMs — без роста). Порог
+	/// ограничен RingSize/2 — иначе продюсер с порцией до 2048 мог бы не
+	/// дописать до него. После underrun первые FadeSamples нарастают.
+	void setPrebuffer(uint32_t startMs, uint32_t maxMs);
+	/// Текущий порог с учётом роста, мс.
+	[[nodiscard]] uint32_t prebufferMs() const { return prebufMs_.load(std::memory_order_relaxed); }
+	static constexpr uint32_t kDefaultPrebufferMs    = 4;
+	static constexpr uint32_t kDefaultMaxPrebufferMs = 32;
+	static constexpr uint32_t kGrowWindowMs          = 10000;
+
 	static constexpr uint32_t RingSize = 8192;
+	static constexpr uint32_t kDrainStackDepth = 1024;  ///< в StackType_t
+
+#if AE2_HW_SIM
+    /* ── Симуляция: виртуальные часы (1 шаг = 1 мс) ── */
+    struct SimConfig {
+        int32_t driftPpm = 0;  ///< DAC быстрее (+) или медленнее (−) номинала
+        /// Всё, что «услышал» DAC, включая нули при underrun. Вызывается
+        /// до двух раз за шаг (заворот ring).
+        void (*record)(void* ctx, const s16* samples, uint32_t n, uint32_t rate) = nullptr;
+        void* recordCtx = nullptr;
+        /// Медленный носитель: сколько мс стоит продюсер на read-й подкачке
+        /// буфера FsAdapter (с нуля); DAC тем временем ест ring. nullptr —
+        /// чтение мгновенное.
+        uint32_t (*readStall)(void* ctx, uint32_t read) = nullptr;
+        void* readStallCtx = nullptr;
+    };
+    struct SimStats {
+        uint64_t timeMs          = 0;
+        uint64_t consumed        = 0;  ///< сэмплов из ring
+        uint64_t underrunSamples = 0;  ///< сэмплов тишины из-за пустого ring
+        uint32_t underruns       = 0;  ///< эпизодов (переходов в пустой ring)
+        uint32_t reads           = 0;  ///< подкачек FsAdapter
+        uint32_t stallMs         = 0;  ///< из них ожидания носителя
+    };
+    /// Сбрасывает часы и статистику.
+    void simConfigure(const SimConfig& cfg);
+    /// Продвинуть часы на ms: DAC потребляет, продюсер не работает.
+    /// Вызов без runOnce() между шагами — тоже инъекция underrun.
+    void simAdvance(uint32_t ms);
+    /// Подкачка буфера FsAdapter: задержка носителя по SimConfig::readStall.
+    void simStorageRead();
+	[[nodiscard]] SimStats simStats() const { return simStats_; }
+#endif
 
     // Не копируем
     AudioHw(const AudioHw&) = delete;
@@ -58,13 +138,42 @@ private:
     uint32_t sampleRate_{128000};
     bool started_{false};
 
+    /* Underrun и предбуфер на стороне потребителя (drain_ / simConsume_) */
+    std::atomic<bool>     primed_{false};   ///< писали с start/flush/endOfStream
+    std::atomic<uint32_t> underruns_{0};
+    std::atomic<uint32_t> prebufMs_{kDefaultPrebufferMs};
+    std::atomic<uint32_t> prebufMaxMs_{kDefaultMaxPrebufferMs};
+    /* Дальше — только потребитель */
+    bool     gated_{true};        ///< ждём предбуфер
+    bool     starved_{false};     ///< недобор уже засчитан
+    bool     resumeFade_{false};  ///< нарастание при открытии после underrun
+    uint32_t consumerMs_{0};      ///< шагов потребителя (≈ мс)
+    uint32_t lastUnderrunMs_{0};
+    /// Сколько из avail сэмплов (с позиции r) отдать DAC при запросе want.
+    uint32_t admit_(uint32_t want, uint32_t r, uint32_t avail);
+    void     rampRing_(uint32_t pos, uint32_t n, bool up);
+
     /* Drain-тред (эмуляция DMA-потребления на хосте) */
     TaskHandle_t drainTask_{nullptr};
     static void drainEntry_(void* arg);
     void drain_();
 
+    /// Ждать 1 тик: vTaskDelay или, в симуляции, шаг виртуальных часов.
+    void waitTick_();
+
+#if AE2_HW_SIM
+    SimConfig simCfg_{};
+    SimStats  simStats_{};
+    uint64_t  simAcc_ = 0;       ///< дробная часть потребления, 1e-9 сэмпла
+    bool      simStarved_ = false;
+    void simConsume_(uint32_t n);
+#endif
+
     /* Тишина: при flush обнуляем */
     static constexpr uint32_t FadeSamples = 200;
+    uint32_t fadeInLeft_{0};  ///< сэмплов нарастания после switchRate
+    void fadeOutTail_();
+    void fadeIn_(uint32_t pos, uint32_t count);
 };
 
 } // namespace ae2
@@ -0,0 +1,88 @@
+#pragma once
+/// @file AudioCodecs.hpp
+/// @brief Кодеки, включённые в сборку AudioMgr.
+///
+/// Отключить кодек: -DAE2_CODEC_<NAME>=0 (WAV PCM есть всегда, как и
+/// DecoderRamPcm — воспроизведение из PcmCache).
+/// Отключённый кодек не линкуется; его файлы уходят в OpenFailed.
+///
+/// MP3: Helix (fixed-point, по умолчанию) или minimp3 — -DAE2_MP3_MINIMP3=1
+/// (float, SSE2/NEON на хосте). Какой быстрее на цели — ae2_bench, mp3/*.
+
+#include "Decoders/CodecSet.hpp"
+#include "Decoders/DecoderWavPcm.hpp"
+#include "Decoders/DecoderRamPcm.hpp"
+
+#if AE2_CODEC_MP3 && AE2_MP3_MINIMP3
+#  include "Decoders/DecoderMp3Mini.hpp"
+#elif AE2_CODEC_MP3
+#  include "Decoders/DecoderMp3.hpp"
+#endif
+#if AE2_CODEC_FLAC
+#  include "Decoders/DecoderFlac.hpp"
+#endif
+#if AE2_CODEC_ADPCM
+#  include "Decoders/DecoderAdpcm.hpp"
+#endif
+#if AE2_CODEC_MSADPCM
+#  include "Decoders/DecoderMsAdpcm.hpp"
+#endif
+#if AE2_CODEC_G711
+#  include "Decoders/DecoderG711.hpp"
+#endif
+
+namespace ae2 {
+
+class AudioCodecs final : public CodecSet<
+    DecoderWavPcm
+    , DecoderRamPcm
+#if AE2_CODEC_MP3 && AE2_MP3_MINIMP3
+    , DecoderMp3Mini
+#elif AE2_CODEC_MP3
+    , DecoderMp3
+#endif
+#if AE2_CODEC_FLAC
+    , DecoderFlac
+#endif
+#if AE2_CODEC_ADPCM
+    , DecoderAdpcm
+#endif
+#if AE2_CODEC_MSADPCM
+    , DecoderMsAdpcm
+#endif
+#if AE2_CODEC_G711
+    , DecoderAlaw
+    , DecoderUlaw
+#endif
+> {};
+
+/* Таблица codec_mem (Types.hpp) против настоящих sizeof: константа не меньше
+ * объекта и больше него не более чем на kCodecsMemSlack. */
+template<typename T, uint32_t Bytes>
+constexpr bool fitsCodecMem() { return sizeof(T) <= Bytes && Bytes < sizeof(T) + kCodecsMemSlack; }
+
+static_assert(fitsCodecMem<DecoderWavPcm, codec_mem::kWavPcm>(), "codec_mem::kWavPcm устарел");
+static_assert(fitsCodecMem<DecoderRamPcm, codec_mem::kRamPcm>(), "codec_mem::kRamPcm устарел");
+#if AE2_CODEC_MP3 && AE2_MP3_MINIMP3
+static_assert(fitsCodecMem<DecoderMp3Mini, codec_mem::kMp3>(), "codec_mem::kMp3 устарел");
+#elif AE2_CODEC_MP3
+static_assert(fitsCodecMem<DecoderMp3, codec_mem::kMp3>(), "codec_mem::kMp3 устарел");
+#endif
+#if AE2_CODEC_FLAC
+static_assert(fitsCodecMem<DecoderFlac, codec_mem::kFlac>(), "codec_mem::kFlac устарел");
+#endif
+#if AE2_CODEC_ADPCM
+static_assert(fitsCodecMem<DecoderAdpcm, codec_mem::kAdpcm>(), "codec_mem::kAdpcm устарел");
+#endif
+#if AE2_CODEC_MSADPCM
+static_assert(fitsCodecMem<DecoderMsAdpcm, codec_mem::kMsAdpcm>(), "codec_mem::kMsAdpcm устарел");
+#endif
+#if AE2_CODEC_G711
+static_assert(fitsCodecMem<DecoderAlaw, codec_mem::kG711>(), "codec_mem::kG711 устарел");
+static_assert(fitsCodecMem<DecoderUlaw, codec_mem::kG711>(), "codec_mem::kG711 устарел");
+#endif
+static_assert(fitsCodecMem<AudioCodecs, kCodecsMemBytes>(), "kCodecsMemBytes расходится с AudioCodecs");
+static_assert(kCodecsScratchBytes == std::max<size_t>(AudioCodecs::kScratchBytes, kScratchAlign),
+              "kCodecsScratchBytes расходится с AudioCodecs::kScratchBytes");
+
+} // namespace ae2
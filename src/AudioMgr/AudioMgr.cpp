@@ -6,14 +6,15 @@
 #include "FsAdapter/FsAdapter.hpp"
 #include "CodecDetect/CodecDetect.hpp"
 #include "Mp3Duration/Mp3Duration.hpp"
-#include "Decoders/DecoderBase.hpp"
-#include "Decoders/DecoderWavPcm.hpp"
-#include "Decoders/DecoderMp3.hpp"
-#include "Decoders/DecoderAdpcm.hpp"
-#include "Decoders/DecoderAlaw.hpp"
-#include "Decoders/DecoderUlaw.hpp"
+#include "PathPool/PathPool.hpp"
+#include "Playlist/Playlist.hpp"
+#include "PcmCache/PcmCache.hpp"
+#include "AudioMgr/AudioCodecs.hpp"
+#include "AudioMgr/Volume.hpp"
+#include "AllocGuard/AllocGuard.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <cstdio>
 #include <algorithm>
@@ -22,10 +23,12 @@
 #include "TaskPriorities.h"
 #include "Statuses.hpp"
 
-/* Подключение профайлера (только в прошивке, не на хосте) */
+/* Подключение профайлера: прошивочный, иначе встроенный (AE2_PROFILER) */
 #if defined(__has_include) && __has_include("AudioProfiler.hpp")
 #  include "AudioProfiler.hpp"
 #endif
+#include "Profiler/Profiler.hpp"
+#include "Trace/Trace.hpp"
 #ifndef APROF_SCOPE
 #  define APROF_SCOPE(name) ((void)0)
 #  define APROF_BEGIN(name) ((void)0)
@@ -56,30 +59,16 @@
 #  define HAS_SETTINGS 1
 #endif
 
-/* Fallback arm_scale_q15 if arm_math.h is not available */
-#if defined(__has_include)
-#  if __has_include("arm_math.h")
-#    include "arm_math.h"
-#    define HAS_ARM_MATH 1
-#  endif
-#endif
-#ifndef HAS_ARM_MATH
-static inline void arm_scale_q15(const int16_t* src, int16_t scaleFract, int8_t shift,
-                                  int16_t* dst, uint32_t n) {
-    for (uint32_t i = 0; i < n; i++) {
-        int32_t v = ((int32_t)src[i] * (int32_t)scaleFract);
-        if (shift >= 0) v >>= (15 - shift); else v >>= (15 + (-shift));
-        if (v > 32767) v = 32767;
-        if (v < -32768) v = -32768;
-        dst[i] = (int16_t)v;
-    }
-}
-#endif
-
 namespace ae2 {
 
 static_assert(sizeof(FsAdapter) <= 1152, "fsMem_ слишком мал для FsAdapter");
 static_assert(sizeof(Resampler) <= 32, "resamplerMem_ слишком мал для Resampler");
+static_assert(sizeof(PathPool) <= 5504, "pathPoolMem_ слишком мал для PathPool");
+static_assert(sizeof(Playlist) <= 1792, "playlistMem_ слишком мал для Playlist");
+static_assert(sizeof(PcmCache) <= 448, "pcmCacheMem_ слишком мал для PcmCache");
+static_assert(AudioCodecs::kCount <= AudioMgr::MemBudget::kMaxCodecs,
+              "MemBudget::kMaxCodecs меньше числа кодеков сборки");
+static_assert(kScratchAlign <= 16, "decoderScratch_ недостаточно выровнен");
 
 /* ═══ Singleton ═══ */
 
@@ -112,11 +101,20 @@ AudioMgr::AudioMgr() {
     sources_[(int)SrcId::Diag].priority     = 3;
 
     fs_ = new (fsMem_) FsAdapter(fsBuf_, sizeof(fsBuf_));
+    paths_ = new (pathPoolMem_) PathPool();
+    playlist_ = new (playlistMem_) Playlist(*paths_);
     resampler_ = new (resamplerMem_) Resampler();
+    pcmCache_ = new (pcmCacheMem_) PcmCache();
+    codecs_ = new (decoderMem_) AudioCodecs();
     cmdQueue_ = xQueueCreateStatic(kCmdQueueDepth, sizeof(Cmd),
                                      cmdQueueStorage_, &cmdQueueBuf_);
+    eventQueue_ = xQueueCreateStatic(kEventQueueDepth, sizeof(Event),
+                                     eventQueueStorage_, &eventQueueBuf_);
     AudioHw::instance().start();
-    xTaskCreateInRegion(RegionAlloc::Zone::HEAP_ZONE_FAST, taskEntry_, "AudioMgr", 1024*6, this, PRIO_TASK_AUDIO_MGR, &task_);
+#if !AE2_HW_SIM
+    /* Временные буферы кодеков — в decoderScratch_, не на стеке таска */
+    xTaskCreateInRegion(RegionAlloc::Zone::HEAP_ZONE_FAST, taskEntry_, "AudioMgr", kTaskStackDepth, this, PRIO_TASK_AUDIO_MGR, &task_);
+#endif
     initialized_ = true;
 
 #ifdef HAS_SETTINGS
@@ -132,9 +130,9 @@ AudioMgr::AudioMgr() {
 
 /* ═══ sendCmd_ ═══ */
 
-void AudioMgr::sendCmd_(QueueHandle_t q, const Cmd& cmd) {
-    if (!q) return;
-    xQueueSend(q, &cmd, pdMS_TO_TICKS(50));
+bool AudioMgr::sendCmd_(QueueHandle_t q, const Cmd& cmd) {
+    if (!q) return false;
+    return xQueueSend(q, &cmd, pdMS_TO_TICKS(50)) == pdPASS;
 }
 
 /* ═══ Thread-safe API ═══ */
@@ -145,17 +143,38 @@ void AudioMgr::stop()  { Cmd c{}; c.type = Cmd::Stop;  sendCmd_(cmdQueue_, c); }
 
 void AudioMgr::addFile(const char* path, uint32_t startSec, Output out, bool front) {
     if (!path) return;
+    /* Интернируем в контексте вызывающего: в mailbox уходит только Id */
+    PathPool::Id id = paths_->intern(path);
+    if (id == PathPool::kInvalid) {
+        AE_LOGW("path pool full, skipped: %s", path);
+        return;
+    }
     Cmd c{};
     c.type = front ? Cmd::AddFileFront : Cmd::AddFile;
-    std::strncpy(c.file.path, path, sizeof(c.file.path) - 1);
-    c.file.path[sizeof(c.file.path)-1] = '\0';
+    c.file.pathId   = id;
     c.file.startSec = startSec;
     c.file.output   = (uint8_t)out;
-    sendCmd_(cmdQueue_, c);
+    if (!sendCmd_(cmdQueue_, c)) paths_->release(id);
 }
 
 void AudioMgr::clearQueue() { Cmd c{}; c.type = Cmd::ClearQueue; sendCmd_(cmdQueue_, c); }
 
+void AudioMgr::playPlaylist(const char* path, bool shuffle, uint32_t seed, Output out) {
+    if (!path) return;
+    PathPool::Id id = paths_->intern(path);
+    if (id == PathPool::kInvalid) {
+        AE_LOGW("path pool full, playlist skipped: %s", path);
+        return;
+    }
+    Cmd c{};
+    c.type = Cmd::PlayPlaylist;
+    c.playlist.pathId  = id;
+    c.playlist.output  = (uint8_t)out;
+    c.playlist.shuffle = shuffle ? 1 : 0;
+    c.playlist.seed    = seed;
+    if (!sendCmd_(cmdQueue_, c)) paths_->release(id);
+}
+
 void AudioMgr::removeFromQueue(uint32_t trackId) {
     Cmd c{}; c.type = Cmd::RemoveQueueItem; c.remove.trackId = trackId; sendCmd_(cmdQueue_, c);
 }
@@ -183,9 +202,56 @@ void AudioMgr::setVolume(SrcId id, uint8_t vol) {
 void AudioMgr::setSampleRate(uint32_t rate) {
     Cmd c{}; c.type = Cmd::SetSampleRate; c.sampleRate.rate = rate; sendCmd_(cmdQueue_, c);
 }
+void AudioMgr::setRatePolicy(RatePolicy policy) {
+    Cmd c{}; c.type = Cmd::SetRatePolicy; c.ratePolicy.policy = (uint8_t)policy; sendCmd_(cmdQueue_, c);
+}
 void AudioMgr::volumeChanged() {
     Cmd c{}; c.type = Cmd::VolumeChanged; sendCmd_(cmdQueue_, c);
 }
+void AudioMgr::setPrebuffer(uint32_t startMs, uint32_t maxMs) {
+    AudioHw::instance().setPrebuffer(startMs, maxMs);
+}
+
+void AudioMgr::setPcmCache(const PcmCacheConfig& cfg) {
+    Cmd c{};
+    c.type = Cmd::SetPcmCache;
+    c.pcmCache.mem          = cfg.mem;
+    c.pcmCache.bytes        = cfg.mem ? cfg.bytes : 0;
+    c.pcmCache.maxFileBytes = cfg.maxFileBytes;
+    c.pcmCache.preResample  = cfg.preResample ? 1 : 0;
+    sendCmd_(cmdQueue_, c);
+}
+
+void AudioMgr::invalidatePcmCache(const char* path) {
+    PathPool::Id id = PathPool::kInvalid;
+    if (path) {
+        id = paths_->intern(path);
+        if (id == PathPool::kInvalid) return;
+    }
+    Cmd c{};
+    c.type = Cmd::DropPcmCache;
+    c.pcmDrop.pathId = id;
+    if (!sendCmd_(cmdQueue_, c)) paths_->release(id);
+}
+
+AudioMgr::PcmCacheStats AudioMgr::pcmCacheStats() const {
+    const PcmCache::Stats c = pcmCache_->stats();
+    PcmCacheStats s;
+    s.capacity  = c.capacity;
+    s.used      = c.used;
+    s.entries   = c.entries;
+    s.hits      = c.hits;
+    s.misses    = c.misses;
+    s.fills     = c.fills;
+    s.aborts    = c.aborts;
+    s.evictions = c.evictions;
+    return s;
+}
+
+void AudioMgr::setRawG711Format(uint32_t rate, uint8_t channels) {
+    Cmd c{}; c.type = Cmd::SetRawFormat;
+    c.rawFormat.rate = rate; c.rawFormat.channels = channels; sendCmd_(cmdQueue_, c);
+}
 
 void AudioMgr::registerSource(SrcId id, uint8_t priority, ExternalFeed feed) {
     uint8_t idx = (uint8_t)id;
@@ -212,70 +278,72 @@ SrcId AudioMgr::currentSource() const { return currentSrcAtomic_; }
 
 /* ═══ Queue ═══ */
 
-bool AudioMgr::queuePush_(const char* path, uint32_t startSec, Output out) {
+bool AudioMgr::queuePush_(uint16_t pathId, uint32_t startSec, Output out) {
     if (queueCount_ >= kMaxQueue) return false;
     auto& e = queue_[queueTail_];
-    std::strncpy(e.path, path, sizeof(e.path) - 1);
-    e.path[sizeof(e.path)-1] = '\0';
+    e.path = pathId;
     e.startSec = startSec; e.output = out; e.used = true;
     e.trackId = nextTrackId_++;
     queueTail_ = (queueTail_ + 1) % kMaxQueue;
     queueCount_++;
+    queueRev_++;
     return true;
 }
 
-bool AudioMgr::queuePushFront_(const char* path, uint32_t startSec, Output out) {
+bool AudioMgr::queuePushFront_(uint16_t pathId, uint32_t startSec, Output out) {
     if (queueCount_ >= kMaxQueue) return false;
     queueHead_ = (queueHead_ == 0) ? (kMaxQueue - 1) : (queueHead_ - 1);
     auto& e = queue_[queueHead_];
-    std::strncpy(e.path, path, sizeof(e.path) - 1);
-    e.path[sizeof(e.path)-1] = '\0';
+    e.path = pathId;
     e.startSec = startSec; e.output = out; e.used = true;
     e.trackId = nextTrackId_++;
     queueCount_++;
+    queueRev_++;
     return true;
 }
 
 bool AudioMgr::queuePop_(QueueEntry& out) {
     if (queueCount_ == 0) return false;
-    out = queue_[queueHead_];
+    out = queue_[queueHead_];  /* ссылка на путь переходит к out */
     queue_[queueHead_].used = false;
+    queue_[queueHead_].path = PathPool::kInvalid;
     queueHead_ = (queueHead_ + 1) % kMaxQueue;
     queueCount_--;
+    queueRev_++;
     return true;
 }
 
 void AudioMgr::queueClear_() {
-    for (auto& e : queue_) e.used = false;
+    for (uint32_t i = 0; i < queueCount_; ++i)
+        paths_->release(queue_[(queueHead_ + i) % kMaxQueue].path);
+    for (auto& e : queue_) { e.used = false; e.path = PathPool::kInvalid; }
+    if (queueCount_ > 0) queueRev_++;
     queueHead_ = queueTail_ = queueCount_ = 0;
 }
 
 bool AudioMgr::queueRemoveById_(uint32_t trackId) {
     if (queueCount_ == 0 || trackId == PLAYER_INVALID_ID) return false;
-    /* Ищем элемент с данным trackId, перестраиваем очередь без него */
-    uint32_t found = 0;
-    for (uint32_t i = 0; i < queueCount_; ++i) {
-        uint32_t idx = (queueHead_ + i) % kMaxQueue;
-        if (queue_[idx].trackId == trackId) { found++; continue; }
-    }
-    if (found == 0) return false;
-    /* Перестраиваем: копируем элементы без удалённого в начало */
-    QueueEntry tmp[kMaxQueue];
-    uint32_t newCount = 0;
+    /* Уплотняем кольцо на месте, без временной копии очереди */
+    uint32_t kept = 0;
     for (uint32_t i = 0; i < queueCount_; ++i) {
-        uint32_t idx = (queueHead_ + i) % kMaxQueue;
-        if (queue_[idx].trackId == trackId) continue;
-        tmp[newCount++] = queue_[idx];
-    }
-    for (uint32_t i = 0; i < newCount; ++i) {
-        queue_[i] = tmp[i];
+        uint32_t src = (queueHead_ + i) % kMaxQueue;
+        if (queue_[src].trackId == trackId) {
+            paths_->release(queue_[src].path);
+            continue;
+        }
+        uint32_t dst = (queueHead_ + kept) % kMaxQueue;
+        if (dst != src) queue_[dst] = queue_[src];
+        kept++;
     }
-    for (uint32_t i = newCount; i < kMaxQueue; ++i) {
-        queue_[i].used = false;
+    if (kept == queueCount_) return false;
+    for (uint32_t i = kept; i < queueCount_; ++i) {
+        auto& e = queue_[(queueHead_ + i) % kMaxQueue];
+        e.used = false;
+        e.path = PathPool::kInvalid;
     }
-    queueHead_ = 0;
-    queueTail_ = newCount % kMaxQueue;
-    queueCount_ = newCount;
+    queueTail_ = (queueHead_ + kept) % kMaxQueue;
+    queueCount_ = kept;
+    queueRev_++;
     return true;
 }
 
@@ -295,8 +363,10 @@ static const char* srcIdName_(ae2::SrcId id) {
 /* ═══ Process commands ═══ */
 
 void AudioMgr::processCommands_() {
+    static_assert(Cmd::DropPcmCache + 1 == Trace::kCommandNames, "Trace: имена команд");
 	Cmd cmd{};
 	while (xQueueReceive(cmdQueue_, &cmd, 0) == pdPASS) {
+        AE2_TRACE_SPAN(span, Command, cmd.type);
         switch (cmd.type) {
         case Cmd::Play:
             if (playerState_ == PlayerState::Paused) {
@@ -311,7 +381,7 @@ void AudioMgr::processCommands_() {
                     AE_LOGI("cmd: play (resume)");
                     playerState_ = PlayerState::Playing;
                 }
-            } else if (playerState_ == PlayerState::Stopped && queueCount_ > 0) {
+            } else if (playerState_ == PlayerState::Stopped && hasPendingTracks_()) {
                 sources_[(int)SrcId::Player].wantPlay = true;
                 if (isPlayerPreempted_()) {
                     AE_LOGI("cmd: play (start) deferred (preempted by %s, queue=%lu)",
@@ -336,11 +406,12 @@ void AudioMgr::processCommands_() {
 
         case Cmd::Stop:
             AE_LOGI("cmd: stop");
+            postTrackEnded_(Event::Stopped);
             notifyRearOutput_(false);
             residualCount_ = 0;
-            destroyDecoder(decoder_);
+            destroyDecoder_();
             fs_->close();
-            currentPath_[0] = '\0';
+            clearCurrentPath_();
             currentTrackId_ = 0;
             playerState_ = PlayerState::Stopped;
             sources_[(int)SrcId::Player].wantPlay = false;
@@ -348,9 +419,10 @@ void AudioMgr::processCommands_() {
             break;
 
         case Cmd::AddFile:
-            if (queuePush_(cmd.file.path, cmd.file.startSec, (Output)cmd.file.output)) {
-                AE_LOGD("queue add: %s (q=%lu)", cmd.file.path, (unsigned long)queueCount_);
-                if (playerState_ == PlayerState::Stopped) {
+            if (queuePush_(cmd.file.pathId, cmd.file.startSec, (Output)cmd.file.output)) {
+                AE_LOGD("queue add: id=%u (q=%lu)", (unsigned)cmd.file.pathId, (unsigned long)queueCount_);
+                if (playerState_ == PlayerState::Stopped ||
+                    playerState_ == PlayerState::PlayWaiting) {
                     sources_[(int)SrcId::Player].wantPlay = true;
                     if (!isPlayerPreempted_()) {
                         startNextTrack_();
@@ -359,50 +431,65 @@ void AudioMgr::processCommands_() {
                     // switchSource_(...->Player), когда вытеснитель уйдёт.
                 }
             } else {
-                AE_LOGW("queue full, skipped: %s", cmd.file.path);
+                paths_->resolve(cmd.file.pathId, pathBuf_, sizeof(pathBuf_));
+                AE_LOGW("queue full, skipped: %s", pathBuf_);
+                paths_->release(cmd.file.pathId);
             }
             break;
 
         case Cmd::AddFileFront:
-            AE_LOGI("queue add front: %s", cmd.file.path);
+            AE_LOGI("queue add front: id=%u", (unsigned)cmd.file.pathId);
             /* Если сейчас что-то играет — возвращаем текущий трек в очередь с текущей позицией */
-            if (decoder_ && currentPath_[0] != '\0') {
+            if (decoder_ && currentPath_ != PathPool::kInvalid) {
                 uint32_t pos = decoder_->position();
                 if (queuePushFront_(currentPath_, pos, currentOutput_)) {
-                    AE_LOGI("saved current track pos=%lu: %s", (unsigned long)pos, currentPath_);
+                    AE_LOGI("saved current track pos=%lu", (unsigned long)pos);
+                    currentPath_ = PathPool::kInvalid;  /* ссылка ушла в очередь */
                 } else {
-                    AE_LOGW("queue full, current track lost: %s", currentPath_);
+                    AE_LOGW("queue full, current track lost");
                 }
             }
-            destroyDecoder(decoder_);
+            postTrackEnded_(Event::Interrupted);
+            destroyDecoder_();
             fs_->close();
-            currentPath_[0] = '\0';
-            queuePushFront_(cmd.file.path, cmd.file.startSec, (Output)cmd.file.output);
+            clearCurrentPath_();
+            if (!queuePushFront_(cmd.file.pathId, cmd.file.startSec, (Output)cmd.file.output))
+                paths_->release(cmd.file.pathId);
             sources_[(int)SrcId::Player].wantPlay = true;
             startNextTrack_();
             break;
 
         case Cmd::ClearQueue:
+            postTrackEnded_(Event::Stopped);
             notifyRearOutput_(false);
-            destroyDecoder(decoder_);
+            destroyDecoder_();
             fs_->close();
-            currentPath_[0] = '\0';
+            clearCurrentPath_();
             currentTrackId_ = 0;
             queueClear_();
+            playlist_->close();
             playerState_ = PlayerState::Stopped;
             sources_[(int)SrcId::Player].wantPlay = false;
             break;
 
         case Cmd::Seek:
-            if (decoder_) decoder_->seek(cmd.seek.sec);
+            pcmCache_->abortFill();  /* в кэш — только файл целиком с начала */
+            if (decoder_) { AE2_PROF_SCOPE(DecoderSeek); decoder_->seek(cmd.seek.sec); }
             break;
 
         case Cmd::Forward:
-            if (decoder_) { uint32_t c = decoder_->position(); decoder_->seek(c + cmd.seek.sec); }
+            pcmCache_->abortFill();
+            if (decoder_) {
+                AE2_PROF_SCOPE(DecoderSeek);
+                uint32_t c = decoder_->position();
+                decoder_->seek(c + cmd.seek.sec);
+            }
             break;
 
         case Cmd::Rewind:
+            pcmCache_->abortFill();
             if (decoder_) {
+                AE2_PROF_SCOPE(DecoderSeek);
                 uint32_t c = decoder_->position();
                 decoder_->seek((c > cmd.seek.sec) ? (c - cmd.seek.sec) : 0);
             }
@@ -435,7 +522,39 @@ void AudioMgr::processCommands_() {
         } break;
 
         case Cmd::SetSampleRate:
-            AudioHw::instance().setSampleRate(cmd.sampleRate.rate);
+            dacRate_ = cmd.sampleRate.rate ? cmd.sampleRate.rate : 128000;
+            applyDacRate_();
+            break;
+
+        case Cmd::SetRatePolicy:
+            ratePolicy_ = (RatePolicy)cmd.ratePolicy.policy;
+            applyDacRate_();
+            break;
+
+        case Cmd::SetRawFormat:
+            if (cmd.rawFormat.rate > 0) rawG711Rate_ = cmd.rawFormat.rate;
+            rawG711Channels_ = cmd.rawFormat.channels ? cmd.rawFormat.channels : 1;
+            break;
+
+        case Cmd::SetPcmCache:
+            /* Текущий трек из старого блока доигрывает: запись он не меняет */
+            pcmCache_->attach(cmd.pcmCache.mem, cmd.pcmCache.bytes);
+            pcmCacheMaxFile_     = cmd.pcmCache.maxFileBytes;
+            pcmCachePreResample_ = cmd.pcmCache.preResample != 0;
+            AE_LOGI("pcm cache: %lu bytes, files <= %lu, preResample=%u",
+                    (unsigned long)pcmCache_->capacity(), (unsigned long)pcmCacheMaxFile_,
+                    (unsigned)pcmCachePreResample_);
+            break;
+
+        case Cmd::DropPcmCache:
+            /* Играющая из кэша запись закреплена: удалится в destroyDecoder_ */
+            if (cmd.pcmDrop.pathId == PathPool::kInvalid) {
+                pcmCache_->clear();
+            } else {
+                paths_->resolve(cmd.pcmDrop.pathId, pathBuf_, sizeof(pathBuf_));
+                paths_->release(cmd.pcmDrop.pathId);
+                pcmCache_->invalidate(pathBuf_);
+            }
             break;
 
         case Cmd::RemoveQueueItem:
@@ -447,6 +566,29 @@ void AudioMgr::processCommands_() {
             }
             break;
 
+        case Cmd::PlayPlaylist:
+            postTrackEnded_(Event::Interrupted);
+            destroyDecoder_();
+            fs_->close();
+            clearCurrentPath_();
+            currentTrackId_ = 0;
+            queueClear_();
+            paths_->resolve(cmd.playlist.pathId, pathBuf_, sizeof(pathBuf_));
+            paths_->release(cmd.playlist.pathId);
+            if (!playlist_->open(pathBuf_, cmd.playlist.shuffle != 0, cmd.playlist.seed)) {
+                AE_LOGW("playlist open failed: %s%s", pathBuf_,
+                        FsDir::kSupported ? "" : " (no directory support in this build)");
+                playerState_ = PlayerState::Stopped;
+                sources_[(int)SrcId::Player].wantPlay = false;
+                break;
+            }
+            AE_LOGI("playlist: %s (shuffle=%u)", pathBuf_, (unsigned)cmd.playlist.shuffle);
+            playlistOutput_ = (Output)cmd.playlist.output;
+            playerState_ = PlayerState::Stopped;
+            sources_[(int)SrcId::Player].wantPlay = true;
+            if (!isPlayerPreempted_()) startNextTrack_();
+            break;
+
         case Cmd::VolumeChanged:
 #ifdef HAS_SETTINGS
         {
@@ -503,6 +645,13 @@ void AudioMgr::switchSource_(SrcId newId) {
             playerState_ = PlayerState::Paused;
         AudioHw::instance().flush(true);
     }
+    {
+        Event ev{};
+        ev.type = Event::SourceSwitched;
+        ev.source.from = (uint8_t)currentSrc_;
+        ev.source.to   = (uint8_t)newId;
+        postEvent_(ev);
+    }
     currentSrc_ = newId;
     currentSrcAtomic_ = newId;
 
@@ -519,6 +668,7 @@ void AudioMgr::switchSource_(SrcId newId) {
 
         /* Запускаем ядро если было остановлено (idempotent) */
         AudioHw::instance().start();
+        applyDacRate_();
         sources_[(int)newId].active = true;
         /* Включаем усилитель если новый источник выводит на FrontSpeaker */
         if (newOut == Output::FrontSpeaker) {
@@ -530,7 +680,7 @@ void AudioMgr::switchSource_(SrcId newId) {
                 playerState_ = PlayerState::Playing;
             } else if (playerState_ == PlayerState::Stopped &&
                        sources_[(int)SrcId::Player].wantPlay &&
-                       queueCount_ > 0 && !decoder_) {
+                       hasPendingTracks_() && !decoder_) {
                 // Отложенный старт: команда Play/AddFile пришла под вытеснением
                 // и не стала открывать декодер. Делаем это сейчас.
                 AE_LOGI("switch->Player: deferred start (queue=%lu)",
@@ -544,54 +694,96 @@ void AudioMgr::switchSource_(SrcId newId) {
 /* ═══ Next track ═══ */
 
 void AudioMgr::startNextTrack_() {
+    /* Цикл, а не рекурсия: плейлист из непроигрываемых файлов длиннее
+     * любого стека. Лимит — на вызов; остальные попытки со следующей
+     * итерации runOnce (PlayWaiting без задержки). */
+    for (uint32_t i = 0; i < kStartAttempts; ++i)
+        if (tryStartTrack_()) return;
+    AE_LOGD("start: %lu entries failed, continue next iteration", (unsigned long)kStartAttempts);
+    playlistRetryAt_ = xTaskGetTickCount();
+    playerState_ = PlayerState::PlayWaiting;
+}
+
+bool AudioMgr::tryStartTrack_() {
     residualCount_ = 0;
-    destroyDecoder(decoder_);
+    destroyDecoder_();
     fs_->close();
+    clearCurrentPath_();
 
     QueueEntry entry;
-    if (!queuePop_(entry)) {
+    bool unplayable = false;  /* упреждающая проверка — только у плейлиста */
+    if (!queuePop_(entry) && !playlistNext_(entry, unplayable)) {
+        if (playlist_->isOpen()) {
+            playlistWait_();
+            return true;
+        }
         AE_LOGD("queue empty, player stopped");
         notifyRearOutput_(false);
-        currentPath_[0] = '\0';
         currentTrackId_ = 0;
+        if (playerState_ != PlayerState::Stopped) {
+            Event ev{};
+            ev.type = Event::QueueEnded;
+            postEvent_(ev);
+        }
         playerState_ = PlayerState::Stopped;
         sources_[(int)SrcId::Player].wantPlay = false;
-        return;
+        return true;
+    }
+    currentTrackId_ = entry.trackId;  /* для TrackEnded(OpenFailed) */
+    currentPath_ = entry.path;        /* ссылка переходит к текущему треку */
+    paths_->resolve(currentPath_, pathBuf_, sizeof(pathBuf_));
+
+    /* Плейлист уже заглянул в файл: непроигрываемый — мимо без fopen */
+    if (unplayable) {
+        AE_LOGW("skipped (probe): %s", pathBuf_);
+        postTrackEnded_(Event::OpenFailed);
+        return false;
     }
 
-    if (!fs_->open(entry.path)) {
-        AE_LOGW("open failed: %s", entry.path);
-        startNextTrack_();
-        return;
+    /* Попадание в кэш: ни fopen, ни CodecDetect, ни разбора заголовков */
+    PcmCache::View cached;
+    const bool hit = pcmCache_->lookup(pathBuf_, cached);
+
+    if (!hit && !fs_->open(pathBuf_)) {
+        AE_LOGW("open failed: %s", pathBuf_);
+        postTrackEnded_(Event::OpenFailed);
+        return false;
     }
 
-    auto codecType = CodecDetect::detect(*fs_);
-    switch (codecType) {
-        case CodecDetect::Type::WavPcm:   emplaceDecoder<DecoderWavPcm>(decoderMem_, decoder_); break;
-        case CodecDetect::Type::Mp3:      emplaceDecoder<DecoderMp3>(decoderMem_, decoder_); break;
-        case CodecDetect::Type::WavAdpcm: emplaceDecoder<DecoderAdpcm>(decoderMem_, decoder_); break;
-        case CodecDetect::Type::WavAlaw:  emplaceDecoder<DecoderAlaw>(decoderMem_, decoder_); break;
-        case CodecDetect::Type::WavUlaw:  emplaceDecoder<DecoderUlaw>(decoderMem_, decoder_); break;
-        default:
-            AE_LOGW("unknown codec: %s", entry.path);
-            startNextTrack_();
-            return;
+    DecoderEnv env;
+    env.type          = hit ? CodecDetect::Type::RamPcm : CodecDetect::detect(*fs_);
+    env.scratch       = ScratchArena{decoderScratch_, sizeof(decoderScratch_)};
+    env.rawRate       = rawG711Rate_;
+    env.rawChannels   = rawG711Channels_;
+    env.pcm           = cached.pcm;
+    env.pcmSamples    = cached.samples;
+    env.pcmRate       = cached.rate;
+    decoder_ = codecs_->emplace(env);
+    if (!decoder_) {
+        AE_LOGW("unknown codec: %s", pathBuf_);
+        postTrackEnded_(Event::OpenFailed);
+        return false;
     }
 
-    if (!decoder_->open(*fs_)) {
-        AE_LOGW("decoder open failed: %s", entry.path);
-        destroyDecoder(decoder_);
-        startNextTrack_();
-        return;
+    bool opened = false;
+    { AE2_PROF_SCOPE(DecoderOpen); AE2_TRACE_SPAN(span, Open); opened = decoder_->open(*fs_); }
+    if (!opened) {
+        AE_LOGW("decoder open failed: %s", pathBuf_);
+        destroyDecoder_();
+        postTrackEnded_(Event::OpenFailed);
+        return false;
     }
 
-    if (entry.startSec > 0) decoder_->seek(entry.startSec);
+    /* DecoderRamPcm читает прямо из блока кэша: запись не двигается и не
+     * удаляется, пока декодер жив (unpin — в destroyDecoder_) */
+    if (hit) pcmCache_->pin(cached);
+    if (entry.startSec > 0) { AE2_PROF_SCOPE(DecoderSeek); decoder_->seek(entry.startSec); }
+    applyDacRate_();
+    if (!hit && entry.startSec == 0) beginCacheFill_();
     playerState_ = PlayerState::Playing;
     sources_[(int)SrcId::Player].wantPlay = true;
     sources_[(int)SrcId::Player].output = entry.output;
-    /* Сохраняем путь, выход и trackId текущего трека */
-    std::strncpy(currentPath_, entry.path, sizeof(currentPath_) - 1);
-    currentPath_[sizeof(currentPath_) - 1] = '\0';
+    /* Сохраняем выход и trackId текущего трека (путь уже в currentPath_) */
     currentOutput_ = entry.output;
     currentTrackId_ = entry.trackId;
 
@@ -610,15 +802,26 @@ void AudioMgr::startNextTrack_() {
 #endif
 
     {
-        auto nm = fs_->name();
-        size_t len = nm.size();
+        /* Имя — из пути: при попадании в кэш файл не открыт */
+        const char* slash = std::strrchr(pathBuf_, '/');
+        if (!slash) slash = std::strrchr(pathBuf_, '\\');
+        const char* nm = slash ? (slash + 1) : pathBuf_;
+        size_t len = std::strlen(nm);
         if (len >= sizeof(status_.filename)) len = sizeof(status_.filename) - 1;
-        std::memcpy((char*)status_.filename, nm.data(), len);
+        std::memcpy((char*)status_.filename, nm, len);
         ((char*)status_.filename)[len] = '\0';
     }
-    AE_LOGI("playing: %s (dur=%lu sec, out=%s)", entry.path,
+    AE_LOGI("playing: %s (dur=%lu sec, out=%s%s)", pathBuf_,
             (unsigned long)decoder_->duration(),
-            (entry.output == Output::FrontSpeaker) ? "Front" : "Rear");
+            (entry.output == Output::FrontSpeaker) ? "Front" : "Rear",
+            hit ? ", cached" : "");
+    {
+        Event ev{};
+        ev.type = Event::TrackStarted;
+        ev.track.trackId     = entry.trackId;
+        ev.track.durationSec = decoder_->duration();
+        postEvent_(ev);
+    }
 
     /* Переключаем GPIO-пин ЦАП если выход изменился между треками */
     if (currentSrc_ == SrcId::Player && sources_[(int)SrcId::Player].active) {
@@ -638,11 +841,121 @@ void AudioMgr::startNextTrack_() {
                 (entry.output == Output::FrontSpeaker) ? "ON" : "OFF");
     }
     notifyRearOutput_(entry.output == Output::RearLineout);
+    return true;
 }
 
 /* ═══ Pipeline tick ═══ */
 
+void AudioMgr::applyVolume_(s16* buf, uint32_t n) {
+    uint8_t volIdx = sources_[(int)currentSrc_].volume;
+    if (volIdx >= 7 || n == 0) return;
+    APROF_BEGIN(Volume);
+    applyVolume(buf, n, volIdx);
+    APROF_END(Volume);
+}
+
+void AudioMgr::checkUnderrun_() {
+    /* Underrun фиксирует потребитель (AudioHw) в момент недобора — здесь
+     * только сообщаем о новых эпизодах */
+    uint32_t n = AudioHw::instance().underruns();
+    if (n != underrunCount_) {
+        underrunCount_ = n;
+        Event ev{};
+        ev.type = Event::Underrun;
+        ev.underrun.count = n;
+        postEvent_(ev);
+    }
+}
+
+/// Часы стоимости decode для pipelineStats. Без AE2_PROFILER таймер не
+/// читается, гистограмма пустая.
+static inline uint32_t decodeClock_() {
+#if AE2_PROFILER
+    return Profiler::now();
+#else
+    return 0;
+#endif
+}
+
+/// acquireWrite с учётом ожидания в waitTicks/maxWait диагностики.
+static AudioHw::WriteRegion acquireTimed(uint32_t minSamples, uint32_t& waitTicks, uint32_t& maxWait) {
+    TickType_t tBefore = xTaskGetTickCount();
+    AE2_TRACE_BEGIN(Wait, 0, minSamples);
+    auto wr = AudioHw::instance().acquireWrite(minSamples, pdMS_TO_TICKS(20));
+    AE2_TRACE_END(Wait, 0, wr.cap1 + wr.cap2);
+    TickType_t waitMs = xTaskGetTickCount() - tBefore;
+    waitTicks += waitMs;
+    if (waitMs > maxWait) maxWait = waitMs;
+    return wr;
+}
+
+/* Частота кодека совпадает с DAC: декодер пишет прямо в сегменты ring,
+ * громкость — на месте. Ни decodeBuf_, ни копии passthrough в
+ * Resampler::process. @return false — нужен обычный путь. */
+bool AudioMgr::directTick_() {
+    auto& hw = AudioHw::instance();
+    if (residualCount_ > 0 || currentSrc_ != SrcId::Player ||
+        playerState_ != PlayerState::Playing || !decoder_ ||
+        codecs_->sampleRate() != hw.sampleRate())
+        return false;
+
+    checkUnderrun_();
+    auto wr = acquireTimed(kDecodeChunk, pipeStats_.waitTicks, pipeStats_.maxWait);
+    if (wr.cap1 + wr.cap2 == 0) {
+        pipeStats_.timeouts++;
+        return true;  /* ещё ничего не декодировано — остатка нет */
+    }
+
+    /* Хвост ring перед заворотом может быть короче порции — дописываем в ptr2 */
+    uint32_t want1 = std::min(wr.cap1, kDecodeChunk);
+    uint32_t n1 = 0;
+    uint32_t n2 = 0;
+    { APROF_SCOPE(Decode); AE2_TRACE_SPAN(span, Decode);
+    const uint32_t t0 = decodeClock_();
+    n1 = codecs_->decode(wr.ptr1, want1);
+    if (n1 == want1 && want1 < kDecodeChunk && wr.ptr2)
+        n2 = codecs_->decode(wr.ptr2, std::min(wr.cap2, kDecodeChunk - want1));
+    noteDecodeCost_(decodeClock_() - t0);
+    AE2_TRACE_SET(span, n1 + n2);
+    }
+    if (n1 == 0) {
+        if (decoder_->skipping()) return true;  /* мусор в потоке, не конец */
+        finishCacheFill_();
+        postTrackEnded_(Event::EndOfFile);
+        startNextTrack_();
+        return true;
+    }
+    pipeStats_.decodes++;
+    cacheFill_(wr.ptr1, n1);  /* до громкости: в кэше — исходный PCM */
+    cacheFill_(wr.ptr2, n2);
+    applyVolume_(wr.ptr1, n1);
+    applyVolume_(wr.ptr2, n2);
+
+    uint32_t rate = codecs_->sampleRate();
+    if (rate != hw.sampleRate()) {
+        /* Частота сменилась по ходу потока (MP3): не коммитим, а отдаём
+         * порцию обычному пути как остаток — громкость уже применена */
+        std::memcpy(decodeBuf_, wr.ptr1, n1 * sizeof(s16));
+        if (n2 > 0) std::memcpy(decodeBuf_ + n1, wr.ptr2, n2 * sizeof(s16));
+        residualOffset_     = 0;
+        residualCount_      = n1 + n2;
+        residualSampleRate_ = rate;
+        return true;
+    }
+
+    { APROF_SCOPE(Enqueue);
+    hw.commitWrite(n1 + n2);
+    }
+    pipeStats_.direct++;
+    pipeStats_.samplesIn  += n1 + n2;
+    pipeStats_.samplesOut += n1 + n2;
+    return true;
+}
+
 void AudioMgr::pipelineTick_() {
+    AllocGuard::Scope noAlloc;  /* AE2_ALLOC_GUARD: куча здесь запрещена */
+    if (directTick_()) return;
+
     auto& hw = AudioHw::instance();
     auto* resamp = static_cast<Resampler*>(resampler_);
 
@@ -659,30 +972,35 @@ void AudioMgr::pipelineTick_() {
         pipeStats_.residuals++;
     } else {
         if (currentSrc_ == SrcId::Player) {
-            if (playerState_ != PlayerState::Playing || !decoder_) return;
-            { APROF_SCOPE(Decode);
-            decoded = decoder_->decode(decodeBuf_, 1024);
+            if (playerState_ != PlayerState::Playing || !decoder_) { hw.endOfStream(); return; }
+            { APROF_SCOPE(Decode); AE2_TRACE_SPAN(span, Decode);
+            const uint32_t t0 = decodeClock_();
+            decoded = codecs_->decode(decodeBuf_, kDecodeChunk);
+            noteDecodeCost_(decodeClock_() - t0);
+            AE2_TRACE_SET(span, decoded);
+            }
+            if (decoded == 0) {
+                if (decoder_->skipping()) return;  /* мусор в потоке, не конец */
+                finishCacheFill_();
+                postTrackEnded_(Event::EndOfFile);
+                startNextTrack_();
+                return;
             }
-            if (decoded == 0) { startNextTrack_(); return; }
-            srcSampleRate = decoder_->sampleRate();
+            srcSampleRate = codecs_->sampleRate();
+            cacheFill_(decodeBuf_, decoded);
         } else {
             uint8_t idx = (uint8_t)currentSrc_;
             if (idx >= kMaxSources || !sources_[idx].feed.feed) return;
+            AE2_TRACE_BEGIN(Decode, idx, 0);
             decoded = sources_[idx].feed.feed(
-                sources_[idx].feed.ctx, decodeBuf_, 1024, &srcSampleRate);
-            if (decoded == 0) return;
+                sources_[idx].feed.ctx, decodeBuf_, kDecodeChunk, &srcSampleRate);
+            AE2_TRACE_END(Decode, idx, decoded);
+            if (decoded == 0) { hw.endOfStream(); return; }
         }
         srcPtr = decodeBuf_;
         pipeStats_.decodes++;
 
-        /* Volume */
-        uint8_t volIdx = sources_[(int)currentSrc_].volume;
-        if (volIdx < 7) {
-            APROF_BEGIN(Volume);
-            int16_t scale = kVolumeTable[volIdx];
-            arm_scale_q15(decodeBuf_, scale, 0, decodeBuf_, decoded);
-            APROF_END(Volume);
-        }
+        applyVolume_(decodeBuf_, decoded);
     }
 
     /* Resample + write */
@@ -696,11 +1014,8 @@ void AudioMgr::pipelineTick_() {
     static constexpr uint32_t kMaxAcquire = 2048;
     uint32_t minRequest = std::min(outLen, kMaxAcquire);
 
-    TickType_t tBefore = xTaskGetTickCount();
-    auto wr = hw.acquireWrite(minRequest, pdMS_TO_TICKS(20));
-    TickType_t waitMs = xTaskGetTickCount() - tBefore;
-    pipeStats_.waitTicks += waitMs;
-    if (waitMs > pipeStats_.maxWait) pipeStats_.maxWait = waitMs;
+    checkUnderrun_();
+    auto wr = acquireTimed(minRequest, pipeStats_.waitTicks, pipeStats_.maxWait);
 
     uint32_t available = wr.cap1 + wr.cap2;
     if (available == 0) {
@@ -724,8 +1039,9 @@ void AudioMgr::pipelineTick_() {
     pipeStats_.samplesIn += usable;
 
     uint32_t outWritten;
-    { APROF_SCOPE(Resample);
+    { APROF_SCOPE(Resample); AE2_TRACE_SPAN(span, Resample);
     outWritten = resamp->process(srcPtr, usable, wr.ptr1, wr.cap1, wr.ptr2, wr.cap2);
+    AE2_TRACE_SET(span, outWritten);
     }
     { APROF_SCOPE(Enqueue);
     hw.commitWrite(outWritten);
@@ -740,6 +1056,58 @@ void AudioMgr::pipelineTick_() {
     }
 }
 
+/* ═══ Кэш PCM ═══ */
+
+void AudioMgr::beginCacheFill_() {
+    if (!pcmCache_->enabled() || !decoder_) return;
+    if (fs_->size() > pcmCacheMaxFile_) return;
+    fillRate_    = codecs_->sampleRate();
+    fillOutRate_ = pcmCachePreResample_ ? AudioHw::instance().sampleRate() : fillRate_;
+    if (fillRate_ == 0 || fillOutRate_ == 0) return;
+    /* Оценка длины с запасом в секунду: по ней вытесняется LRU. Запись
+     * может занять и весь свободный хвост, дальше — отказ */
+    const uint64_t est = (uint64_t)(decoder_->duration() + 1) * fillOutRate_;
+    if (est > pcmCache_->capacity() / sizeof(s16)) return;
+    if (!pcmCache_->beginFill(pathBuf_, (uint32_t)est))
+        AE_LOGD("pcm cache: no room for %s", pathBuf_);
+}
+
+void AudioMgr::cacheFill_(const s16* pcm, uint32_t n) {
+    if (!pcmCache_->filling() || n == 0) return;
+    if (codecs_->sampleRate() != fillRate_) {
+        pcmCache_->abortFill();  /* частота сменилась посреди потока */
+        return;
+    }
+    if (fillOutRate_ == fillRate_) {
+        pcmCache_->fillAppend(pcm, n);
+        return;
+    }
+    /* preResample: тот же Resampler, что у pipelineTick_ (без состояния
+     * между порциями, частоты он выставляет себе каждый тик сам) */
+    auto* resamp = static_cast<Resampler*>(resampler_);
+    resamp->setRates(fillRate_, fillOutRate_);
+    uint32_t cap = 0;
+    s16* dst = pcmCache_->fillSpace(cap);
+    if (resamp->outputLength(n) > cap) {
+        pcmCache_->abortFill();
+        return;
+    }
+    pcmCache_->fillAdvance(resamp->process(pcm, n, dst, cap, nullptr, 0));
+}
+
+void AudioMgr::finishCacheFill_() {
+    if (!pcmCache_->filling()) return;
+    if (pcmCache_->commitFill(fillOutRate_))
+        AE_LOGD("pcm cache: stored %s (%lu Hz)", pathBuf_, (unsigned long)fillOutRate_);
+}
+
+void AudioMgr::noteDecodeCost_(uint32_t ticks) {
+    static_assert(kDecodeBuckets == Profiler::kBuckets, "PipeStats: корзины как у Profiler");
+    if (!Profiler::kEnabled) return;
+    pipeStats_.decodeHist[ticks ? 32u - (uint32_t)__builtin_clz(ticks) : 0u]++;
+    if (ticks > pipeStats_.decodeMax) pipeStats_.decodeMax = ticks;
+}
+
 /* ═══ Status update ═══ */
 
 void AudioMgr::updateStatus_() {
@@ -757,21 +1125,213 @@ void AudioMgr::updateStatus_() {
         st.positionPercent = 0;
     }
 
-    /* Снэпшот очереди */
+    /* Снэпшот очереди и событие — только если очередь менялась */
+    if (queueRev_ == queueRevNotified_) return;
+    queueRevNotified_ = queueRev_;
+
     uint8_t n = 0;
     for (uint32_t i = 0; i < queueCount_ && n < PLAYER_MAX_QUEUE; ++i) {
         uint32_t idx = (queueHead_ + i) % kMaxQueue;
         auto& src = queue_[idx];
         auto& dst = queueSnapshot_[n];
         dst.trackId = src.trackId;
-        std::strncpy(dst.path, src.path, PLAYER_PATH_MAX - 1);
-        dst.path[PLAYER_PATH_MAX - 1] = '\0';
+        paths_->resolve(src.path, dst.path, PLAYER_PATH_MAX);
         dst.positionSec = src.startSec;
         dst.durationSec = 0;  // продолжительность неизвестна для элементов в очереди
         dst.output = static_cast<PlayerOutput>((uint8_t)src.output);
         n++;
     }
     queueSnapshotCount_ = n;
+
+    Event ev{};
+    ev.type = Event::QueueChanged;
+    ev.queue.count = queueCount_;
+    postEvent_(ev);
+}
+
+bool AudioMgr::hasPendingTracks_() const {
+    return queueCount_ > 0 || playlist_->isOpen();
+}
+
+bool AudioMgr::playlistNext_(QueueEntry& out, bool& unplayable) {
+    Playlist::Entry pe;
+    if (!playlist_->next(pe)) {
+        /* Закрываем только в настоящем конце; иначе — PlayWaiting и повтор */
+        if (playlist_->isOpen() && playlist_->exhausted()) {
+            AE_LOGD("playlist finished (%lu tracks)", (unsigned long)playlist_->position());
+            playlist_->close();
+        }
+        return false;
+    }
+    out.path     = pe.path;
+    out.startSec = 0;
+    out.output   = playlistOutput_;
+    out.used     = true;
+    out.trackId  = nextTrackId_++;
+    unplayable   = pe.probed && !AudioCodecs::supports(pe.codec);
+    return true;
+}
+
+void AudioMgr::playlistWait_() {
+    uint32_t ms = 0;  /* подсчёт shuffle ещё ничего не нашёл — на следующей итерации */
+    if (!playlist_->scanning()) {
+        ms = kPlaylistRetryMs;
+        AE_LOGD("playlist: path pool full, retry in %lu ms", (unsigned long)ms);
+    }
+    playlistRetryAt_ = xTaskGetTickCount() + pdMS_TO_TICKS(ms);
+    playerState_ = PlayerState::PlayWaiting;
+}
+
+/* ═══ Частота DAC ═══ */
+
+uint32_t AudioMgr::wantedDacRate_() const {
+    if (ratePolicy_ != RatePolicy::NativeMultiple || currentSrc_ != SrcId::Player || !decoder_)
+        return dacRate_;
+    uint32_t src = codecs_->sampleRate();
+    if (src == 0 || src > dacRate_) return dacRate_;
+    for (uint32_t k = dacRate_ / src; k >= 1; --k) {
+        if (AudioHw::supportsRate(k * src)) return k * src;
+    }
+    return dacRate_;
+}
+
+void AudioMgr::applyDacRate_() {
+    auto& hw = AudioHw::instance();
+    uint32_t rate = wantedDacRate_();
+    if (rate == hw.sampleRate()) return;
+    AE_LOGI("DAC rate %lu -> %lu", (unsigned long)hw.sampleRate(), (unsigned long)rate);
+    /* Хвост ring доигрывается на старой частоте: не дольше полного ring */
+    hw.switchRate(rate, pdMS_TO_TICKS(AudioHw::RingSize * 1000 / hw.sampleRate() + 1));
+    /* Остаток — входные сэмплы со своей residualSampleRate_: ресемплер
+     * перенастроится на новую частоту DAC в следующем тике */
+}
+
+void AudioMgr::clearCurrentPath_() {
+    paths_->release(currentPath_);
+    currentPath_ = PathPool::kInvalid;
+}
+
+void AudioMgr::destroyDecoder_() {
+    pcmCache_->abortFill();  /* файл не доигран до конца */
+    codecs_->reset();
+    decoder_ = nullptr;
+    pcmCache_->unpin();      /* отложенные invalidate/clear — теперь */
+}
+
+/* ═══ Бюджет памяти ═══ */
+
+AudioMgr::MemBudget AudioMgr::memoryBudget() {
+    MemBudget b;
+    b.audioMgr       = sizeof(AudioMgr);
+    b.decoderMem     = sizeof(decoderMem_);
+    b.decoderUsed    = sizeof(AudioCodecs);
+    b.decoderScratch = sizeof(decoderScratch_);
+    b.scratchUsed    = AudioCodecs::kScratchBytes;
+    b.decodeBuf      = sizeof(decodeBuf_);
+    b.fsBuf          = sizeof(fsBuf_);
+    b.fsAdapter      = sizeof(fsMem_);
+    b.pathPool       = sizeof(pathPoolMem_);
+    b.playlist       = sizeof(playlistMem_);
+    b.resampler      = sizeof(resamplerMem_);
+    b.queues         = sizeof(cmdQueueStorage_) + sizeof(eventQueueStorage_) +
+                       sizeof(cmdQueueBuf_) + sizeof(eventQueueBuf_);
+    b.audioHw        = sizeof(AudioHw);
+    b.ring           = AudioHw::RingSize * sizeof(s16);
+    b.audioTaskStack = kTaskStackDepth * sizeof(StackType_t);
+    b.decoderStack   = kCodecsStackBytes;
+    b.drainTaskStack = AudioHw::kDrainStackDepth * sizeof(StackType_t);
+    b.trace          = Trace::kBytes;
+    b.pcmCache       = sizeof(pcmCacheMem_);
+    AudioCodecs::describe([&b](const char* name, size_t object, size_t scratch) {
+        auto& c   = b.codecs[b.codecCount++];
+        c.name    = name;
+        c.object  = (uint32_t)object;
+        c.scratch = (uint32_t)scratch;
+    });
+    return b;
+}
+
+AudioMgr::HotAllocStats AudioMgr::hotAllocStats() {
+    auto g = AllocGuard::stats();
+    HotAllocStats s;
+    s.enabled   = AllocGuard::kEnabled;
+    s.allocs    = g.allocs;
+    s.bytes     = g.bytes;
+    s.lastBytes = g.lastBytes;
+    s.ticks     = g.scopes;
+    return s;
+}
+
+void AudioMgr::resetHotAllocStats() { AllocGuard::resetStats(); }
+
+void AudioMgr::publishPipeStats_() {
+    pipeStatsSeq_ = pipeStatsSeq_ + 1;
+    std::atomic_thread_fence(std::memory_order_release);
+    pipeStatsPub_ = pipeStats_;
+    std::atomic_thread_fence(std::memory_order_release);
+    pipeStatsSeq_ = pipeStatsSeq_ + 1;
+}
+
+AudioMgr::PipelineStats AudioMgr::pipelineStats(bool reset) {
+    /* Seqlock: копия целиком из одной публикации. Читатель приоритетнее
+     * таска может застать его посреди копирования — тогда уступает тик */
+    PipeStats cur;
+    for (;;) {
+        const uint32_t seq = pipeStatsSeq_;
+        if (seq & 1u) {
+            vTaskDelay(1);
+            continue;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        cur = pipeStatsPub_;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (pipeStatsSeq_ == seq) break;
+    }
+    const PipeStats& base = pipeStatsBase_;
+    const uint32_t   dma  = AudioHw::instance().underruns();
+    const TickType_t now  = xTaskGetTickCount();
+
+    auto ms = [](uint32_t ticks) { return (uint32_t)((uint64_t)ticks * 1000u / configTICK_RATE_HZ); };
+
+    PipelineStats st;
+    st.windowMs    = ms(now - pipeStatsSince_);
+    st.loopIter    = cur.loopIter    - base.loopIter;
+    st.decodes     = cur.decodes     - base.decodes;
+    st.direct      = cur.direct      - base.direct;
+    st.residuals   = cur.residuals   - base.residuals;
+    st.truncations = cur.truncations - base.truncations;
+    st.timeouts    = cur.timeouts    - base.timeouts;
+    st.waitMs      = ms(cur.waitTicks - base.waitTicks);
+    st.maxWaitMs   = ms(cur.maxWait);
+    st.samplesIn   = cur.samplesIn   - base.samplesIn;
+    st.samplesOut  = cur.samplesOut  - base.samplesOut;
+    st.ringMin     = cur.ringMin == UINT32_MAX ? 0 : cur.ringMin;
+    st.ringMax     = cur.ringMax;
+    st.underruns      = dma - underrunsBase_;
+    st.underrunsTotal = dma;
+    st.prebufferMs    = AudioHw::instance().prebufferMs();
+
+    /* Перцентили — по гистограмме окна, теми же корзинами, что у Profiler */
+    Profiler::Stats h;
+    for (uint32_t b = 0; b < kDecodeBuckets; ++b) {
+        h.hist[b] = cur.decodeHist[b] - base.decodeHist[b];
+        h.count  += h.hist[b];
+    }
+    h.max = cur.decodeMax;
+    const uint64_t hz = Profiler::tickHz();
+    auto us = [hz](uint32_t ticks) { return (uint32_t)((uint64_t)ticks * 1000000u / hz); };
+    st.decodeP50Us = us(h.percentileBound(50));
+    st.decodeP90Us = us(h.percentileBound(90));
+    st.decodeP99Us = us(h.percentileBound(99));
+    st.decodeMaxUs = us(h.max);
+
+    if (reset) {
+        pipeStatsBase_   = cur;
+        underrunsBase_   = dma;
+        pipeStatsSince_  = now;
+        pipeStatsReset_  = true;
+    }
+    return st;
 }
 
 uint8_t AudioMgr::getQueueSnapshot(PlayerQueueEntry* out, uint8_t maxEntries) const {
@@ -788,49 +1348,100 @@ void AudioMgr::taskEntry_(void* arg) { static_cast<AudioMgr*>(arg)->taskLoop_();
 void AudioMgr::taskLoop_() {
     Waitfor(SysState.RecFlasherExited);
     for (;;) {
-        processCommands_();
-
-        /* Прогресс воспроизведения — раз в секунду */
-        if (playerState_ == PlayerState::Playing && decoder_) {
-            TickType_t now = xTaskGetTickCount();
-            if ((now - lastProgressLog_) >= pdMS_TO_TICKS(1000)) {
-                lastProgressLog_ = now;
-                const auto& st = *(const PlayerStatus*)&status_;
-                AE_LOGI("progress: \"%s\" %lu/%lu sec (%u%%)",
-                        (const char*)status_.filename,
-                        (unsigned long)st.position,
-                        (unsigned long)st.duration,
-                        (unsigned)st.positionPercent);
-            }
+        if (runOnce()) vTaskDelay(1);
+        else           ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(50));
+    }
+}
 
-            /* Диагностика пайплайна — раз в 2 секунды */
-            // if ((now - lastPipeStatsLog_) >= pdMS_TO_TICKS(2000)) {
-            //     lastPipeStatsLog_ = now;
-            //     auto& s = pipeStats_;
-            //     AE_LOGI("pipe: loop=%lu dec=%lu res=%lu trunc=%lu tout=%lu "
-            //             "wait=%lums maxW=%lums in=%lu out=%lu free=%lu",
-            //             (unsigned long)s.loopIter,
-            //             (unsigned long)s.decodes,
-            //             (unsigned long)s.residuals,
-            //             (unsigned long)s.truncations,
-            //             (unsigned long)s.timeouts,
-            //             (unsigned long)s.waitTicks,
-            //             (unsigned long)s.maxWait,
-            //             (unsigned long)s.samplesIn,
-            //             (unsigned long)s.samplesOut,
-            //             (unsigned long)AudioHw::instance().freeSpace());
-            //     s = {};  // сброс
-            // }
+bool AudioMgr::runOnce() {
+    AE2_TRACE_SPAN(tick, Tick);
+    if (pipeStatsReset_) {
+        /* Новое окно pipelineStats: экстремумы с нуля, счётчики копятся */
+        pipeStatsReset_       = false;
+        pipeStats_.maxWait    = 0;
+        pipeStats_.ringMin    = UINT32_MAX;
+        pipeStats_.ringMax    = 0;
+        pipeStats_.decodeMax  = 0;
+    }
+    processCommands_();
+
+    /* Подсчёт shuffle — порциями, в том числе под уже играющий
+     * временный трек */
+    if (playlist_->scanning()) {
+        playlist_->scanStep(kPlaylistScanBudget);
+        if (!playlist_->scanning())
+            AE_LOGI("playlist: %lu entries", (unsigned long)playlist_->count());
+    }
+
+    /* Плеер ждёт: подсчёт shuffle ещё ничего не нашёл или занят PathPool —
+     * повтор по таймеру; лимит попыток startNextTrack_ — продолжение сразу */
+    if (playerState_ == PlayerState::PlayWaiting && !isPlayerPreempted_() &&
+        (int32_t)(xTaskGetTickCount() - playlistRetryAt_) >= 0)
+        startNextTrack_();
+
+    /* Прогресс воспроизведения — раз в секунду */
+    if (playerState_ == PlayerState::Playing && decoder_) {
+        TickType_t now = xTaskGetTickCount();
+        if ((now - lastProgressLog_) >= pdMS_TO_TICKS(1000)) {
+            lastProgressLog_ = now;
+            const auto& st = *(const PlayerStatus*)&status_;
+            AE_LOGI("progress: \"%s\" %lu/%lu sec (%u%%)",
+                    (const char*)status_.filename,
+                    (unsigned long)st.position,
+                    (unsigned long)st.duration,
+                    (unsigned)st.positionPercent);
         }
 
-        if (currentSrc_ == SrcId::Disabled) {
-            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(50));
-            continue;
+        /* Позиция для подписчиков событий */
+        if (positionTickMs_ > 0 &&
+            (now - lastPositionTick_) >= pdMS_TO_TICKS(positionTickMs_)) {
+            lastPositionTick_ = now;
+            Event ev{};
+            ev.type = Event::PositionTick;
+            ev.position.trackId     = currentTrackId_;
+            ev.position.positionSec = decoder_->position();
+            ev.position.durationSec = decoder_->duration();
+            postEvent_(ev);
         }
-        pipeStats_.loopIter++;
-        pipelineTick_();
-        vTaskDelay(1);
+
+        /* Диагностика пайплайна — раз в 2 секунды */
+        // if ((now - lastPipeStatsLog_) >= pdMS_TO_TICKS(2000)) {
+        //     lastPipeStatsLog_ = now;
+        //     auto& s = pipeStats_;
+        //     AE_LOGI("pipe: loop=%lu dec=%lu res=%lu trunc=%lu tout=%lu "
+        //             "wait=%lums maxW=%lums in=%lu out=%lu free=%lu",
+        //             (unsigned long)s.loopIter,
+        //             (unsigned long)s.decodes,
+        //             (unsigned long)s.residuals,
+        //             (unsigned long)s.truncations,
+        //             (unsigned long)s.timeouts,
+        //             (unsigned long)s.waitTicks,
+        //             (unsigned long)s.maxWait,
+        //             (unsigned long)s.samplesIn,
+        //             (unsigned long)s.samplesOut,
+        //             (unsigned long)AudioHw::instance().freeSpace());
+        //     s = {};  // сброс
+        // }
+    }
+
+    if (currentSrc_ == SrcId::Disabled) {
+        publishPipeStats_();
+        return false;
     }
+    pipeStats_.loopIter++;
+    const uint32_t fill = AudioHw::RingSize - 1 - AudioHw::instance().freeSpace();
+    pipeStats_.ringMin = std::min(pipeStats_.ringMin, fill);
+    pipeStats_.ringMax = std::max(pipeStats_.ringMax, fill);
+    AE2_TRACE_COUNTER(RingFill, fill);
+    pipelineTick_();
+    /* Упреждающая проверка следующих элементов плейлиста — вне hot path:
+     * только когда ring заполнен больше чем наполовину, один файл за
+     * итерацию */
+    if (playerState_ == PlayerState::Playing && playlist_->isOpen() &&
+        AudioHw::instance().freeSpace() < AudioHw::RingSize / 2)
+        playlist_->probeStep();
+    publishPipeStats_();
+    return true;
 }
 
 /* ═══ Rear output notification ═══ */
@@ -846,4 +1457,59 @@ void AudioMgr::notifyRearOutput_(bool active) {
     if (rearOutputCb_) rearOutputCb_(active);
 }
 
+/* ═══ Events ═══ */
+
+void AudioMgr::setEventCb(EventCb cb, void* ctx) {
+    taskENTER_CRITICAL();
+    eventCb_    = cb;
+    eventCbCtx_ = ctx;
+    taskEXIT_CRITICAL();
+}
+
+bool AudioMgr::waitEvent(Event& out, TickType_t timeout) {
+    if (!eventQueue_) return false;
+    return xQueueReceive(eventQueue_, &out, timeout) == pdPASS;
+}
+
+#if AE2_TRACE
+/// Главное поле события для трассы.
+static uint32_t traceValue_(const AudioMgr::Event& ev) {
+    switch (ev.type) {
+        case AudioMgr::Event::TrackStarted:   return ev.track.trackId;
+        case AudioMgr::Event::TrackEnded:     return ev.ended.trackId;
+        case AudioMgr::Event::SourceSwitched: return (uint32_t)ev.source.from << 8 | ev.source.to;
+        case AudioMgr::Event::Underrun:       return ev.underrun.count;
+        case AudioMgr::Event::QueueChanged:   return ev.queue.count;
+        case AudioMgr::Event::PositionTick:   return ev.position.positionSec;
+        default:                              return 0;
+    }
+}
+#endif
+
+void AudioMgr::postEvent_(Event& ev) {
+    static_assert(Event::PositionTick + 1 == Trace::kEventNames, "Trace: имена событий");
+    ev.tick = xTaskGetTickCount();
+    AE2_TRACE_INSTANT(Event, ev.type, traceValue_(ev));
+    taskENTER_CRITICAL();
+    const EventCb cb  = eventCb_;
+    void* const   ctx = eventCbCtx_;
+    taskEXIT_CRITICAL();
+    if (cb) {
+        cb(ev, ctx);  /* callback вместо кольца: читать его некому */
+        return;
+    }
+    /* Не блокируемся: если читатель не успевает — теряем событие */
+    if (eventQueue_ && xQueueSend(eventQueue_, &ev, 0) != pdPASS)
+        eventsDropped_ = eventsDropped_ + 1;
+}
+
+void AudioMgr::postTrackEnded_(uint8_t reason) {
+    if (currentTrackId_ == 0) return;
+    Event ev{};
+    ev.type = Event::TrackEnded;
+    ev.ended.trackId = currentTrackId_;
+    ev.ended.reason  = reason;
+    postEvent_(ev);
+}
+
 } // namespace ae2
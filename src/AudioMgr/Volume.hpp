@@ -0,0 +1,36 @@
+#pragma once
+/// @file Volume.hpp
+/// @brief Громкость по kVolumeTable: arm_scale_q15 (CMSIS-DSP) или fallback.
+
+#include "AudioEngineV2/Types.hpp"
+#include <cstdint>
+
+/* Fallback arm_scale_q15 if arm_math.h is not available */
+#if defined(__has_include)
+#  if __has_include("arm_math.h")
+#    include "arm_math.h"
+#    define HAS_ARM_MATH 1
+#  endif
+#endif
+#ifndef HAS_ARM_MATH
+static inline void arm_scale_q15(const int16_t* src, int16_t scaleFract, int8_t shift,
+                                  int16_t* dst, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        int32_t v = ((int32_t)src[i] * (int32_t)scaleFract);
+        if (shift >= 0) v >>= (15 - shift); else v >>= (15 + (-shift));
+        if (v > 32767) v = 32767;
+        if (v < -32768) v = -32768;
+        dst[i] = (int16_t)v;
+    }
+}
+#endif
+
+namespace ae2 {
+
+/// Применить громкость volIdx (0..10) на месте; 7 и выше — passthrough.
+inline void applyVolume(s16* buf, uint32_t n, uint8_t volIdx) {
+    if (volIdx >= 7 || n == 0) return;
+    arm_scale_q15(buf, kVolumeTable[volIdx], 0, buf, n);
+}
+
+} // namespace ae2
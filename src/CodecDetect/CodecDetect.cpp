@@ -1,6 +1,7 @@
 /// @file CodecDetect.cpp
 #include "CodecDetect.hpp"
 #include "FsAdapter/FsAdapter.hpp"
+#include "Profiler/Profiler.hpp"
 #include <cstring>
 
 namespace ae2 {
@@ -9,6 +10,13 @@ namespace CodecDetect {
 static uint16_t readU16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
 
 Type detect(FsAdapter& fs) {
+    AE2_PROF_SCOPE(CodecDetect);
+    /* Headerless G.711 — только по расширению: μ-law тишина 0xFF 0xFF
+     * неотличима от MP3 sync word */
+    auto rawExt = fs.extension();
+    if (rawExt == "alaw") return Type::RawAlaw;
+    if (rawExt == "ulaw") return Type::RawUlaw;
+
     fs.seek(0);
     uint8_t hdr[512];
     size_t n = fs.read(hdr, sizeof(hdr));
@@ -18,6 +26,7 @@ Type detect(FsAdapter& fs) {
         auto ext = fs.extension();
         if (ext == "mp3") return Type::Mp3;
         if (ext == "wav") return Type::WavPcm;
+        if (ext == "flac") return Type::Flac;
         return Type::Unknown;
     }
 
@@ -32,6 +41,7 @@ Type detect(FsAdapter& fs) {
                 uint16_t fmt = readU16(hdr + pos + 8);
                 switch (fmt) {
                     case 1:  return Type::WavPcm;
+                    case 2:  return Type::WavMsAdpcm;
                     case 6:  return Type::WavAlaw;
                     case 7:  return Type::WavUlaw;
                     case 0x11: return Type::WavAdpcm;
@@ -44,15 +54,20 @@ Type detect(FsAdapter& fs) {
         return Type::WavPcm;
     }
 
+    /* FLAC: "fLaC" (ID3v2 перед ним — по расширению) */
+    if (std::memcmp(hdr, "fLaC", 4) == 0)
+        return Type::Flac;
+
     /* MP3: sync word или ID3 */
     if (n >= 3 && hdr[0] == 'I' && hdr[1] == 'D' && hdr[2] == '3')
-        return Type::Mp3;
+        return fs.extension() == "flac" ? Type::Flac : Type::Mp3;
     if (n >= 2 && hdr[0] == 0xFF && (hdr[1] & 0xE0) == 0xE0)
         return Type::Mp3;
 
     /* fallback */
     auto ext = fs.extension();
     if (ext == "mp3") return Type::Mp3;
+    if (ext == "flac") return Type::Flac;
     return Type::Unknown;
 }
 
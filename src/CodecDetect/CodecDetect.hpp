@@ -10,9 +10,14 @@ enum class Type : uint8_t {
     Unknown = 0,
     WavPcm,
     WavAdpcm,
+    WavMsAdpcm,
     WavAlaw,
     WavUlaw,
-    Mp3
+    Mp3,
+    Flac,
+    RawAlaw,   ///< headerless G.711 (.alaw), формат задаётся снаружи
+    RawUlaw,   ///< headerless G.711 (.ulaw)
+    RamPcm     ///< готовый PCM в памяти (PcmCache); detect() его не возвращает
 };
 
 /// Определить формат по содержимому файла (читает первые ~512 байт).
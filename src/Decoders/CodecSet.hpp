@@ -0,0 +1,118 @@
+#pragma once
+/// @file CodecSet.hpp
+/// @brief Набор кодеков сборки: выбор по CodecDetect::Type и вызов без vtable.
+///
+/// Хранилище — union-подобный буфер под самый большой кодек + индекс
+/// активного. visit() разворачивается в цепочку сравнений индекса, а вызов
+/// метода идёт по конкретному final-типу, поэтому decode() на hot path —
+/// прямой вызов. Кодек, не попавший в список, не линкуется.
+///
+/// Требование к кодеку: final-наследник DecoderBase со статическим
+/// `static constexpr bool accepts(CodecDetect::Type)` и `kName`. Потребность в общем
+/// scratch — DecoderBase::kScratchBytes; набор отдаёт максимум по списку.
+
+#include "DecoderBase.hpp"
+#include <algorithm>
+#include <tuple>
+
+namespace ae2 {
+
+template<typename... Codecs>
+class CodecSet {
+    static_assert(sizeof...(Codecs) > 0, "CodecSet: пустой список");
+    static_assert(sizeof...(Codecs) < 255, "CodecSet: индекс — uint8_t");
+    static_assert((std::is_base_of_v<DecoderBase, Codecs> && ...), "CodecSet: не DecoderBase");
+    static_assert((std::is_final_v<Codecs> && ...), "CodecSet: кодек должен быть final");
+    static_assert(((sizeof(Codecs) <= kMaxDecoderSize) && ...), "Decoder too large");
+    static_assert(((alignof(Codecs) <= kMaxDecoderAlign) && ...), "Decoder alignment too large");
+
+public:
+    static constexpr size_t kStorageSize  = std::max({sizeof(Codecs)...});
+    static constexpr size_t kStorageAlign = std::max({alignof(Codecs)...});
+    static constexpr size_t kScratchBytes = std::max({Codecs::kScratchBytes...});
+    static constexpr size_t kCount        = sizeof...(Codecs);
+
+    CodecSet() = default;
+    ~CodecSet() { reset(); }
+    CodecSet(const CodecSet&) = delete;
+    CodecSet& operator=(const CodecSet&) = delete;
+
+    /// Есть ли в сборке кодек для типа.
+    static constexpr bool supports(CodecDetect::Type type) {
+        return (Codecs::accepts(type) || ...);
+    }
+
+    /// f(kName, sizeof, kScratchBytes) для каждого кодека — отчёт о памяти.
+    template<typename F>
+    static void describe(F&& f) { (f(Codecs::kName, sizeof(Codecs), Codecs::kScratchBytes), ...); }
+
+    /// Создать декодер для env.type (старый закрывается).
+    /// @return базовый указатель для холодного пути; nullptr — кодек не включён
+    ///         или env.scratch меньше его kScratchBytes
+    DecoderBase* emplace(const DecoderEnv& env) {
+        reset();
+        emplaceAt_<0>(env);
+        return get();
+    }
+
+    /// Закрыть и разрушить активный декодер.
+    void reset() {
+        if (index_ == kNone) return;
+        visit([](auto& d) {
+            using T = std::decay_t<decltype(d)>;
+            d.close();
+            d.~T();
+        });
+        index_ = kNone;
+    }
+
+    [[nodiscard]] bool empty() const { return index_ == kNone; }
+
+    [[nodiscard]] DecoderBase* get() {
+        if (index_ == kNone) return nullptr;
+        return visit([](auto& d) -> DecoderBase* { return &d; });
+    }
+
+    /// Вызвать f(T&) для активного декодера. Требует !empty().
+    template<typename F>
+    decltype(auto) visit(F&& f) { return visitAt_<0>(std::forward<F>(f)); }
+
+    /* ── Hot path без виртуальных вызовов ── */
+    uint32_t decode(s16* buf, uint32_t maxSamples) {
+        return visit([=](auto& d) { return d.decode(buf, maxSamples); });
+    }
+    uint32_t sampleRate() {
+        return visit([](auto& d) { return d.sampleRate(); });
+    }
+
+private:
+    static constexpr uint8_t kNone = 0xFF;
+
+    alignas(kStorageAlign) uint8_t storage_[kStorageSize];
+    uint8_t index_ = kNone;
+
+    template<size_t I>
+    using At = std::tuple_element_t<I, std::tuple<Codecs...>>;
+
+    template<size_t I>
+    void emplaceAt_(const DecoderEnv& env) {
+        if constexpr (I < sizeof...(Codecs)) {
+            using T = At<I>;
+            if (!T::accepts(env.type)) { emplaceAt_<I + 1>(env); return; }
+            if (env.scratch.bytes < T::kScratchBytes) return;
+            if constexpr (std::is_constructible_v<T, const DecoderEnv&>) new (storage_) T(env);
+            else                                                          new (storage_) T();
+            index_ = (uint8_t)I;
+        }
+    }
+
+    template<size_t I, typename F>
+    decltype(auto) visitAt_(F&& f) {
+        if constexpr (I + 1 < sizeof...(Codecs)) {
+            if (index_ != I) return visitAt_<I + 1>(std::forward<F>(f));
+        }
+        return f(*std::launder(reinterpret_cast<At<I>*>(storage_)));
+    }
+};
+
+} // namespace ae2
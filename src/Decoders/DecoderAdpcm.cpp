@@ -3,7 +3,10 @@
 #include "FsAdapter/FsAdapter.hpp"
 #include <algorithm>
 #include <cstring>
-#include <algorithm>
+
+#if defined(__ARM_FEATURE_SAT)
+#  include <arm_acle.h>
+#endif
 
 namespace ae2 {
 
@@ -59,151 +62,196 @@ bool DecoderAdpcm::open(FsAdapter& fs) {
         pos += 8+sz; if (sz&1) pos++;
         if (gotFmt && gotData) break;
     }
-    if (!gotFmt || !gotData || channels_ == 0 || blockAlign_ == 0) return false;
-    if (samplesPerBlock_ > kMaxBlockSamples) return false;
+    if (!gotFmt || !gotData || channels_ == 0 || channels_ > 2) return false;
+    if (blockAlign_ < 4u * channels_) return false;
     totalBlocks_ = dataSize_ / blockAlign_;
     blocksRead_ = 0;
+    blockBytesLeft_ = 0;
+    carryLen_ = carryPos_ = 0;
     fs.seek(dataOffset_);
     status_ = Status::Ready;
     return true;
 }
 
-s16 DecoderAdpcm::decodeNibble(uint8_t nibble, AdpcmState& state) {
-    int step = kStepTable[state.stepIndex];
-    int diff = step >> 3;
-    if (nibble & 1) diff += step >> 2;
-    if (nibble & 2) diff += step >> 1;
-    if (nibble & 4) diff += step;
-    if (nibble & 8) diff = -diff;
-
-    int pred = state.predictor + diff;
-	pred			= std::min(pred, 32767);
-	pred			= std::max(pred, -32768);
-	state.predictor = (s16)pred;
-
-    int idx = state.stepIndex + kIndexTable[nibble & 0x0F];
-	idx				= std::max(idx, 0);
-	idx				= std::min(idx, 88);
-	state.stepIndex = (uint8_t)idx;
-
-    return state.predictor;
+/* Шаг IMA без ветвлений: биты nibble превращаются в маски слагаемых,
+ * знак — в xor/вычитание, насыщение — min/max (на M4 — SSAT). */
+static inline int32_t imaStep(uint32_t nib, int32_t& pred, int32_t& idx) {
+    const int32_t step = kStepTable[idx];
+    int32_t diff = step >> 3;
+    diff += step        & -(int32_t)((nib >> 2) & 1);
+    diff += (step >> 1) & -(int32_t)((nib >> 1) & 1);
+    diff += (step >> 2) & -(int32_t)(nib & 1);
+    const int32_t sign = -(int32_t)(nib >> 3);
+    diff = (diff ^ sign) - sign;
+#if defined(__ARM_FEATURE_SAT)
+    pred = __ssat(pred + diff, 16);
+#else
+    pred = std::min(std::max(pred + diff, -32768), 32767);
+#endif
+    idx = std::min(std::max(idx + kIndexTable[nib], 0), 88);
+    return pred;
+}
+
+/* 8 байт стерео-группы (4 L + 4 R) → 8 моно-сэмплов.
+ * Каналы декодируются попеременно — две независимые цепочки зависимостей. */
+static inline void decodeGroup(const uint8_t* g, s16* o,
+                               int32_t& p0, int32_t& i0, int32_t& p1, int32_t& i1) {
+    for (int k = 0; k < 4; ++k) {
+        const uint32_t bl = g[k];
+        const uint32_t br = g[k + 4];
+        int32_t l0 = imaStep(bl & 0x0F, p0, i0);
+        int32_t r0 = imaStep(br & 0x0F, p1, i1);
+        int32_t l1 = imaStep(bl >> 4,   p0, i0);
+        int32_t r1 = imaStep(br >> 4,   p1, i1);
+        o[k * 2]       = (s16)((l0 + r0) / 2);
+        o[(k * 2) + 1] = (s16)((l1 + r1) / 2);
+    }
 }
 
 uint32_t DecoderAdpcm::decode(s16* buf, uint32_t maxSamples) {
     if (!fs_ || (status_ != Status::Ready && status_ != Status::Playing)) return 0;
     status_ = Status::Playing;
 
-    uint32_t totalOut = 0;
-
-    /* ── Cначала отдаём остаток от предыдущего блока ── */
-    if (blockDecPos_ < blockDecLen_) {
-        uint32_t avail = blockDecLen_ - blockDecPos_;
-        uint32_t n = std::min(avail, maxSamples);
-        std::memcpy(buf, blockDecBuf_ + blockDecPos_, n * sizeof(s16));
-        blockDecPos_ += n;
-        totalOut += n;
-        if (blockDecPos_ >= blockDecLen_)
-            blockDecLen_ = blockDecPos_ = 0;
-    }
+    uint32_t out = 0;
 
-    /* ── Декодируем следующие блоки, пока не заполним буфер ── */
-    while (totalOut < maxSamples) {
-        if (blocksRead_ >= totalBlocks_) {
-            if (totalOut == 0) status_ = Status::Closed;
-            break;
-        }
+    /* ── Сначала хвост группы с прошлого вызова ── */
+    while (carryPos_ < carryLen_ && out < maxSamples)
+        buf[out++] = carry_[carryPos_++];
 
-        uint32_t blockSamples = decodeOneBlock_();
-        if (blockSamples == 0) {
-            if (totalOut == 0) status_ = Status::Closed;
-            break;
+    while (out < maxSamples) {
+        if (blockBytesLeft_ == 0) {
+            s16 first;
+            if (!startBlock_(first)) break;
+            buf[out++] = first;
+            continue;
         }
-
-        uint32_t space = maxSamples - totalOut;
-        uint32_t n = std::min(blockSamples, space);
-        std::memcpy(buf + totalOut, blockDecBuf_, n * sizeof(s16));
-        totalOut += n;
-
-        if (n < blockSamples) {
-            /* Остаток сохраняем для следующего вызова */
-            blockDecPos_ = n;
-            blockDecLen_ = blockSamples;
-            break;
+        if (channels_ == 2 && blockBytesLeft_ < 8) {
+            /* Неполная группа в конце блока — пропускаем, как и раньше */
+            fs_->seek(fs_->tell() + blockBytesLeft_);
+            blockBytesLeft_ = 0;
+            continue;
         }
+        uint32_t n = (channels_ == 1) ? decodeMono_(buf + out, maxSamples - out)
+                                      : decodeStereo_(buf + out, maxSamples - out);
+        out += n;
+        if (carryPos_ < carryLen_) break;  /* буфер заполнен группой */
+        if (n == 0 && blockBytesLeft_ != 0) break;
     }
 
-    return totalOut;
+    if (out == 0) status_ = Status::Closed;
+    return out;
 }
 
-uint32_t DecoderAdpcm::decodeOneBlock_() {
-    /* Читаем один блок из файла */
-    uint8_t blockBuf[4096];
-    uint8_t* block = blockBuf;
-    bool alloc = false;
-    if (blockAlign_ > sizeof(blockBuf)) { block = new uint8_t[blockAlign_]; alloc = true; }
-
-    size_t rd = fs_->read(block, blockAlign_);
-    if (rd < blockAlign_) {
-        if (alloc) delete[] block;
-        return 0;
-    }
+bool DecoderAdpcm::startBlock_(s16& first) {
+    if (blocksRead_ >= totalBlocks_) return false;
+    uint8_t hdr[8];
+    const uint32_t hdrLen = 4u * channels_;
+    if (fs_->read(hdr, hdrLen) < hdrLen) return false;
     blocksRead_++;
 
-    uint32_t outSamples = 0;
-    AdpcmState states[2];
-
     /* Block header: для каждого канала 4 байта */
-    for (uint16_t c = 0; c < channels_ && c < 2; ++c) {
-        uint32_t off = c * 4;
-        states[c].predictor = (s16)(block[off] | (block[off+1] << 8));
-        states[c].stepIndex = block[off+2];
-		states[c].stepIndex = std::min<uint8_t>(states[c].stepIndex, 88);
-	}
+    for (uint16_t c = 0; c < channels_; ++c) {
+        states_[c].predictor = (s16)(hdr[c * 4] | (hdr[(c * 4) + 1] << 8));
+        states_[c].stepIndex = std::min<int32_t>(hdr[(c * 4) + 2], 88);
+    }
+    blockBytesLeft_ = blockAlign_ - hdrLen;
 
     /* Первый сэмпл — predictor из заголовка */
-    if (channels_ == 1) {
-        blockDecBuf_[outSamples++] = states[0].predictor;
-    } else {
-        blockDecBuf_[outSamples++] = (s16)(((int32_t)states[0].predictor + states[1].predictor) / 2);
+    first = (channels_ == 1) ? (s16)states_[0].predictor
+                             : (s16)((states_[0].predictor + states_[1].predictor) / 2);
+    return true;
+}
+
+uint32_t DecoderAdpcm::decodeMono_(s16* dst, uint32_t room) {
+    int32_t pred = states_[0].predictor;
+    int32_t idx  = states_[0].stepIndex;
+    uint32_t out = 0;
+
+    while (out < room && blockBytesLeft_ > 0) {
+        const uint8_t* p = nullptr;
+        size_t span = fs_->peek(p);
+        if (span == 0) { blockBytesLeft_ = 0; break; }  /* обрезанный файл */
+
+        uint32_t bytes = (uint32_t)std::min<size_t>(span, blockBytesLeft_);
+        bytes = std::min(bytes, (room - out) / 2);
+        if (bytes == 0) {
+            /* Осталось одно место: второй nibble — в перенос */
+            const uint32_t b = p[0];
+            dst[out++] = (s16)imaStep(b & 0x0F, pred, idx);
+            carry_[0]  = (s16)imaStep(b >> 4,   pred, idx);
+            carryPos_ = 0;
+            carryLen_ = 1;
+            fs_->consume(1);
+            blockBytesLeft_--;
+            break;
+        }
+
+        s16* o = dst + out;
+        for (uint32_t i = 0; i < bytes; ++i) {
+            const uint32_t b = p[i];
+            o[i * 2]       = (s16)imaStep(b & 0x0F, pred, idx);
+            o[(i * 2) + 1] = (s16)imaStep(b >> 4,   pred, idx);
+        }
+        out += bytes * 2;
+        fs_->consume(bytes);
+        blockBytesLeft_ -= bytes;
     }
 
-    /* Данные nibbles */
-    uint32_t dataStart = 4 * channels_;
-    uint32_t dataBytes = blockAlign_ - dataStart;
+    states_[0].predictor = pred;
+    states_[0].stepIndex = idx;
+    return out;
+}
+
+uint32_t DecoderAdpcm::decodeStereo_(s16* dst, uint32_t room) {
+    int32_t p0 = states_[0].predictor;
+    int32_t i0 = states_[0].stepIndex;
+    int32_t p1 = states_[1].predictor;
+    int32_t i1 = states_[1].stepIndex;
+    uint32_t out = 0;
+
+    while (out < room && blockBytesLeft_ >= 8) {
+        const uint8_t* p = nullptr;
+        size_t span = fs_->peek(p);
+        uint8_t edge[8];
+        uint32_t groups = 0;
+        bool viaEdge = false;
 
-    if (channels_ == 1) {
-        for (uint32_t i = 0; i < dataBytes && outSamples < kMaxBlockSamples; ++i) {
-            uint8_t byte = block[dataStart + i];
-            blockDecBuf_[outSamples++] = decodeNibble(byte & 0x0F, states[0]);
-            if (outSamples < kMaxBlockSamples)
-                blockDecBuf_[outSamples++] = decodeNibble((byte >> 4) & 0x0F, states[0]);
+        if (span >= 8) {
+            groups = (uint32_t)(std::min<size_t>(span, blockBytesLeft_) / 8);
+        } else {
+            /* Группа на границе буфера FsAdapter — собираем её в 8 байт */
+            if (fs_->read(edge, 8) < 8) { blockBytesLeft_ = 0; break; }
+            p = edge;
+            groups = 1;
+            viaEdge = true;
         }
-    } else {
-        /* Stereo: interleaved 4-byte chunks per channel */
-        uint32_t pos_ = dataStart;
-        while (pos_ + 8 <= blockAlign_ && outSamples < kMaxBlockSamples) {
-            s16 ch0[8];
-            s16 ch1[8];
-            int n0 = 0;
-            int n1 = 0;
-            for (int b = 0; b < 4 && pos_ < blockAlign_; ++b, ++pos_) {
-                uint8_t byte = block[pos_];
-                ch0[n0++] = decodeNibble(byte & 0x0F, states[0]);
-                ch0[n0++] = decodeNibble((byte >> 4) & 0x0F, states[0]);
-            }
-            for (int b = 0; b < 4 && pos_ < blockAlign_; ++b, ++pos_) {
-                uint8_t byte = block[pos_];
-                ch1[n1++] = decodeNibble(byte & 0x0F, states[1]);
-                ch1[n1++] = decodeNibble((byte >> 4) & 0x0F, states[1]);
-            }
-            int pairs = std::min(n0, n1);
-            for (int j = 0; j < pairs && outSamples < kMaxBlockSamples; ++j)
-                blockDecBuf_[outSamples++] = (s16)(((int32_t)ch0[j] + ch1[j]) / 2);
+
+        const uint32_t roomGroups = (room - out) / 8;
+        if (roomGroups == 0) {
+            decodeGroup(p, carry_, p0, i0, p1, i1);
+            const uint32_t n = room - out;
+            std::memcpy(dst + out, carry_, n * sizeof(s16));
+            out += n;
+            carryPos_ = (uint8_t)n;
+            carryLen_ = 8;
+            if (!viaEdge) fs_->consume(8);
+            blockBytesLeft_ -= 8;
+            break;
         }
+
+        groups = std::min(groups, roomGroups);
+        for (uint32_t g = 0; g < groups; ++g)
+            decodeGroup(p + (g * 8), dst + out + (g * 8), p0, i0, p1, i1);
+        out += groups * 8;
+        if (!viaEdge) fs_->consume(groups * 8);
+        blockBytesLeft_ -= groups * 8;
     }
 
-    if (alloc) delete[] block;
-    return outSamples;
+    states_[0].predictor = p0;
+    states_[0].stepIndex = i0;
+    states_[1].predictor = p1;
+    states_[1].stepIndex = i1;
+    return out;
 }
 
 void DecoderAdpcm::seek(uint32_t sec) {
@@ -212,7 +260,8 @@ void DecoderAdpcm::seek(uint32_t sec) {
     uint32_t targetBlock = targetSample / samplesPerBlock_;
     if (targetBlock >= totalBlocks_) targetBlock = totalBlocks_ > 0 ? totalBlocks_ - 1 : 0;
     blocksRead_ = targetBlock;
-    blockDecLen_ = blockDecPos_ = 0;  /* сброс буфера остатка */
+    blockBytesLeft_ = 0;                /* блок начнётся заново */
+    carryLen_ = carryPos_ = 0;
 	fs_->seek(dataOffset_ + (targetBlock * blockAlign_));
 }
 
@@ -228,7 +277,8 @@ uint32_t DecoderAdpcm::duration() const {
 
 void DecoderAdpcm::close() {
     fs_ = nullptr; status_ = Status::Closed; blocksRead_ = 0;
-    blockDecLen_ = blockDecPos_ = 0;
+    blockBytesLeft_ = 0;
+    carryLen_ = carryPos_ = 0;
 }
 
 } // namespace ae2
@@ -5,6 +5,9 @@ namespace ae2 {
 
 class DecoderAdpcm final : public DecoderBase {
 public:
+    static constexpr const char* kName = "ima-adpcm";
+    static constexpr bool accepts(CodecDetect::Type t) { return t == CodecDetect::Type::WavAdpcm; }
+
     bool     open(FsAdapter& fs) override;
     uint32_t decode(s16* buf, uint32_t maxSamples) override;
     void     seek(uint32_t sec) override;
@@ -24,16 +27,20 @@ private:
     uint32_t blocksRead_      = 0;
     uint32_t totalBlocks_     = 0;
 
-    /// Внутренний буфер декодированного блока (для порционной выдачи).
-    /// Стандартный WAV IMA ADPCM: blockAlign 256-1024 → до ~2000 сэмплов.
-    static constexpr uint32_t kMaxBlockSamples = 2048;
-    s16 blockDecBuf_[kMaxBlockSamples]{};
-    uint32_t blockDecLen_ = 0;  ///< Всего декодировано сэмплов в текущем блоке
-    uint32_t blockDecPos_ = 0;  ///< Текущая позиция чтения из буфера
+    /* Потоковое состояние: блок разбирается прямо из буфера FsAdapter
+     * порциями любого размера, без копии блока — blockAlign_ не ограничен. */
+    struct AdpcmState { int32_t predictor; int32_t stepIndex; };
+    AdpcmState states_[2]{};
+    uint32_t blockBytesLeft_ = 0;  ///< байт nibble-данных до конца текущего блока
+
+    /// Хвост группы, не поместившийся в выходной буфер (≤ 8 сэмплов).
+    s16 carry_[8]{};
+    uint8_t carryLen_ = 0;
+    uint8_t carryPos_ = 0;
 
-    struct AdpcmState { s16 predictor; uint8_t stepIndex; };
-    static s16 decodeNibble(uint8_t nibble, AdpcmState& state);
-    uint32_t decodeOneBlock_();
+    bool     startBlock_(s16& first);
+    uint32_t decodeMono_(s16* dst, uint32_t room);
+    uint32_t decodeStereo_(s16* dst, uint32_t room);
 };
 
 } // namespace ae2
@@ -3,6 +3,7 @@
 /// @brief Базовый интерфейс синхронного декодера.
 
 #include "AudioEngineV2/Types.hpp"
+#include "CodecDetect/CodecDetect.hpp"
 #include <cstdint>
 #include <cstddef>
 #include <new>
@@ -25,32 +26,51 @@ public:
 	[[nodiscard]] virtual uint32_t sampleRate() const	   = 0;
 	virtual void     close() = 0;
 
+    /// Сколько байт общего scratch нужно кодеку (см. ScratchArena).
+    /// Наследник с временными буферами перекрывает константу.
+    static constexpr size_t kScratchBytes = 0;
+
     enum class Status : uint8_t { Closed, Ready, Playing, Error };
 	[[nodiscard]] Status status() const { return status_; }
+	/// decode() вернул 0, но поток не кончился: декодер пропускал мусор и
+	/// упёрся в лимит работы на вызов. Звать decode() снова в следующем тике.
+	[[nodiscard]] bool skipping() const { return skipping_; }
 
 protected:
-    Status status_ = Status::Closed;
+    Status status_   = Status::Closed;
+    bool   skipping_ = false;
 };
 
 static constexpr size_t kMaxDecoderSize  = 8192;
 static constexpr size_t kMaxDecoderAlign = 16;
 
-template<typename T, typename... Args>
-T* emplaceDecoder(uint8_t* mem, DecoderBase*& ptr, Args&&... args) {
-    static_assert(sizeof(T) <= kMaxDecoderSize, "Decoder too large");
-    static_assert(alignof(T) <= kMaxDecoderAlign, "Decoder alignment too large");
-    if (ptr) { ptr->close(); ptr->~DecoderBase(); ptr = nullptr; }
-    auto* p = new (mem) T(std::forward<Args>(args)...);
-    ptr = p;
-    return p;
-}
-
-inline void destroyDecoder(DecoderBase*& ptr) {
-    if (ptr) {
-        ptr->close();
-        ptr->~DecoderBase();
-        ptr = nullptr;
+/// Общий scratch декодеров: один буфер AudioMgr вместо временных массивов
+/// на стеке таска. Принадлежит активному декодеру от emplace до reset,
+/// содержимое между вызовами decode() сохраняется.
+static constexpr size_t kScratchAlign = 16;
+
+struct ScratchArena {
+    void*  data  = nullptr;
+    size_t bytes = 0;
+
+    /// Буфер как массив T[count]; nullptr, если не помещается.
+    template<typename T>
+    [[nodiscard]] T* as(size_t count) const {
+        static_assert(alignof(T) <= kScratchAlign, "ScratchArena: выравнивание");
+        return (data && count * sizeof(T) <= bytes) ? static_cast<T*>(data) : nullptr;
     }
-}
+};
+
+/// Параметры создания декодера. CodecSet передаёт их конструктору
+/// T(const DecoderEnv&), если он есть; иначе вызывается T().
+struct DecoderEnv {
+    CodecDetect::Type type = CodecDetect::Type::Unknown;
+    ScratchArena scratch;            ///< ≥ kScratchBytes кодека
+    uint32_t rawRate     = 0;        ///< формат headerless G.711
+    uint16_t rawChannels = 1;
+    const s16* pcm        = nullptr; ///< RamPcm: моно PCM из PcmCache
+    uint32_t   pcmSamples = 0;
+    uint32_t   pcmRate    = 0;
+};
 
 } // namespace ae2
@@ -0,0 +1,575 @@
+/// @file DecoderFlac.cpp — FLAC (fixed-point)
+#include "DecoderFlac.hpp"
+#include "FsAdapter/FsAdapter.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__ARM_FEATURE_SAT)
+#  include <arm_acle.h>
+#endif
+
+namespace ae2 {
+
+static uint32_t be16(const uint8_t* p) { return ((uint32_t)p[0] << 8) | p[1]; }
+static uint32_t be24(const uint8_t* p) { return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2]; }
+static uint32_t be32(const uint8_t* p) { return (be16(p) << 16) | be16(p + 2); }
+static uint64_t be64(const uint8_t* p) { return ((uint64_t)be32(p) << 32) | be32(p + 4); }
+
+static inline s16 sat16(int32_t v) {
+#if defined(__ARM_FEATURE_SAT)
+    return (s16)__ssat(v, 16);
+#else
+    return (s16)std::min(std::max(v, -32768), 32767);
+#endif
+}
+
+/* Сдвиг влево без UB для отрицательных */
+static inline int32_t shl(int32_t v, uint32_t n) { return (int32_t)((uint32_t)v << n); }
+
+/* CRC-8 заголовка кадра (poly 0x07): отсекает ложный sync после seek */
+static uint8_t crc8(const uint8_t* p, uint32_t n) {
+    uint32_t crc = 0;
+    while (n--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; ++i) crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) : (crc << 1);
+        crc &= 0xFF;
+    }
+    return (uint8_t)crc;
+}
+
+/* CRC-16 кадра (poly 0x8005), табличный: считается по ходу чтения */
+static constexpr std::array<uint16_t, 256> makeCrc16() {
+    std::array<uint16_t, 256> t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i << 8;
+        for (int b = 0; b < 8; ++b) crc = (crc & 0x8000) ? ((crc << 1) ^ 0x8005) : (crc << 1);
+        t[i] = (uint16_t)crc;
+    }
+    return t;
+}
+static constexpr std::array<uint16_t, 256> kCrc16 = makeCrc16();
+
+inline void DecoderFlac::crcPush_(uint8_t b) {
+    crc16_ = (uint16_t)((crc16_ << 8) ^ kCrc16[(crc16_ >> 8) ^ b]);
+    crcHist_[crcBytes_++ & kCrcHistMask] = crc16_;
+}
+
+/* ═══ Битовый ридер ═══ */
+
+void DecoderFlac::resetInput_() {
+    inBase_ = inPtr_ = inEnd_ = nullptr;
+    cache_ = cacheBits_ = padBits_ = 0;
+}
+
+bool DecoderFlac::fetch_() {
+    if (inBase_) fs_->consume((size_t)(inEnd_ - inBase_));
+    const uint8_t* p = nullptr;
+    size_t n = fs_->peek(p);
+    inBase_ = inPtr_ = p;
+    inEnd_  = p ? p + n : nullptr;
+    return n > 0;
+}
+
+inline void DecoderFlac::refill_() {
+    while (cacheBits_ <= 24) {
+        if (inPtr_ == inEnd_ && !fetch_()) {
+            /* Конец файла: добиваем нулями; выход за данные — exhausted_().
+             * В CRC — тоже, чтобы отмотка по cacheBits_ сходилась */
+            crcPush_(0);
+            padBits_ += 8;
+            cacheBits_ += 8;
+            continue;
+        }
+        crcPush_(*inPtr_);
+        cache_ |= (uint32_t)*inPtr_++ << (24 - cacheBits_);
+        cacheBits_ += 8;
+    }
+}
+
+inline uint32_t DecoderFlac::bits_(uint32_t n) {
+    if (n == 0) return 0;
+    if (n > 24) {
+        uint32_t hi = bits_(n - 16);
+        return (hi << 16) | bits_(16);
+    }
+    refill_();
+    uint32_t v = cache_ >> (32 - n);
+    cache_ <<= n;
+    cacheBits_ -= n;
+    return v;
+}
+
+inline int32_t DecoderFlac::sbits_(uint32_t n) {
+    if (n == 0) return 0;
+    return (int32_t)(bits_(n) << (32 - n)) >> (32 - n);
+}
+
+inline uint32_t DecoderFlac::unary_() {
+    uint32_t q = 0;
+    for (;;) {
+        refill_();
+        if (cache_) {
+            /* Биты за cacheBits_ — нули, поэтому clz < cacheBits_ */
+            uint32_t z = (uint32_t)__builtin_clz(cache_);
+            cache_ <<= z;
+            cache_ <<= 1;
+            cacheBits_ -= z + 1;
+            return q + z;
+        }
+        q += cacheBits_;
+        cache_ = cacheBits_ = 0;
+        if (padBits_) return q;
+    }
+}
+
+/* ═══ Открытие ═══ */
+
+bool DecoderFlac::open(FsAdapter& fs) {
+    close();
+    fs_ = &fs;
+    if (!out_ || outCap_ == 0) return false;
+    fs.seek(0);
+
+    uint8_t h[10];
+    if (fs.read(h, 4) < 4) return false;
+    if (!std::memcmp(h, "ID3", 3)) {
+        /* ID3v2 перед fLaC: пропускаем по syncsafe-размеру */
+        if (fs.read(h + 4, 6) < 6) return false;
+        uint32_t sz = ((uint32_t)(h[6] & 0x7F) << 21) | ((uint32_t)(h[7] & 0x7F) << 14) |
+                      ((uint32_t)(h[8] & 0x7F) << 7) | (h[9] & 0x7F);
+        fs.seek(10 + sz + ((h[5] & 0x10) ? 10 : 0));
+        if (fs.read(h, 4) < 4) return false;
+    }
+    if (std::memcmp(h, "fLaC", 4)) return false;
+
+    bool gotInfo = false;
+    for (;;) {
+        uint8_t mh[4];
+        if (fs.read(mh, 4) < 4) return false;
+        uint32_t type = mh[0] & 0x7F;
+        uint32_t len  = be24(mh + 1);
+        uint32_t body = fs.tell();
+        if (type == 127) return false;
+
+        if (type == 0 && len >= 34) {
+            uint8_t si[18];
+            if (fs.read(si, sizeof(si)) < sizeof(si)) return false;
+            maxBlock_     = be16(si + 2);
+            sampleRate_   = (be24(si + 10) >> 4);
+            channels_     = ((si[12] >> 1) & 7) + 1;
+            bps_          = (((si[12] & 1) << 4) | (si[13] >> 4)) + 1;
+            totalSamples_ = ((uint64_t)(si[13] & 0x0F) << 32) | be32(si + 14);
+            gotInfo = true;
+        } else if (type == 3) {
+            seekTableOffset_ = body;
+            seekPoints_      = len / 18;
+        }
+        fs.seek(body + len);
+        if (mh[0] & 0x80) break;
+    }
+    firstFrame_ = fs.tell();
+
+    if (!gotInfo || sampleRate_ == 0) return false;
+    if (channels_ > 2 || bps_ < 4 || bps_ > 24) return false;
+    if (maxBlock_ > std::min(kMaxBlockSize, outCap_)) return false;
+
+    resetInput_();
+    fs.seek(firstFrame_);
+    frameStart_ = 0;
+    status_ = Status::Ready;
+    return true;
+}
+
+/* ═══ Кадр ═══ */
+
+bool DecoderFlac::readFrameHeader_() {
+    alignByte_();
+    uint32_t prev = 0;
+    for (;;) {
+        uint32_t b = bits_(8);
+        if (exhausted_()) return false;
+        /* sync 0xFFF8 / 0xFFF9 (фиксированный / переменный блок) */
+        if (prev == 0xFF && (b & 0xFE) == 0xF8) {
+            if (parseFrameHeader_(b)) return true;
+            if (exhausted_()) return false;
+            b = 0;
+        }
+        prev = b;
+    }
+}
+
+bool DecoderFlac::parseFrameHeader_(uint32_t b1) {
+    uint8_t h[16];
+    uint32_t n = 0;
+    h[n++] = 0xFF;
+    h[n++] = (uint8_t)b1;
+    h[n++] = (uint8_t)bits_(8);
+    h[n++] = (uint8_t)bits_(8);
+
+    const uint32_t bsCode = h[2] >> 4;
+    const uint32_t srCode = h[2] & 0x0F;
+    const uint32_t chCode = h[3] >> 4;
+    const uint32_t ssCode = (h[3] >> 1) & 7;
+    if (bsCode == 0 || srCode == 15 || chCode > 10 || ssCode == 3 || (h[3] & 1)) return false;
+
+    /* Номер кадра/сэмпла, UTF-8-подобное кодирование (до 36 бит) */
+    uint32_t c = bits_(8);
+    h[n++] = (uint8_t)c;
+    uint32_t extra = 0;
+    uint64_t num = 0;
+    if      (!(c & 0x80))         { num = c; }
+    else if ((c & 0xE0) == 0xC0)  { num = c & 0x1F; extra = 1; }
+    else if ((c & 0xF0) == 0xE0)  { num = c & 0x0F; extra = 2; }
+    else if ((c & 0xF8) == 0xF0)  { num = c & 0x07; extra = 3; }
+    else if ((c & 0xFC) == 0xF8)  { num = c & 0x03; extra = 4; }
+    else if ((c & 0xFE) == 0xFC)  { num = c & 0x01; extra = 5; }
+    else if (c == 0xFE)           { num = 0;        extra = 6; }
+    else return false;
+    while (extra--) {
+        c = bits_(8);
+        h[n++] = (uint8_t)c;
+        if ((c & 0xC0) != 0x80) return false;
+        num = (num << 6) | (c & 0x3F);
+    }
+
+    uint32_t bs = 0;
+    if (bsCode == 1)      bs = 192;
+    else if (bsCode <= 5) bs = 576u << (bsCode - 2);
+    else if (bsCode == 6) { bs = bits_(8);  h[n++] = (uint8_t)bs; bs += 1; }
+    else if (bsCode == 7) { bs = bits_(16); h[n++] = (uint8_t)(bs >> 8); h[n++] = (uint8_t)bs; bs += 1; }
+    else                  bs = 256u << (bsCode - 8);
+
+    /* Частота кадра не используется — берём из STREAMINFO */
+    if (srCode == 12) h[n++] = (uint8_t)bits_(8);
+    else if (srCode == 13 || srCode == 14) {
+        uint32_t v = bits_(16);
+        h[n++] = (uint8_t)(v >> 8);
+        h[n++] = (uint8_t)v;
+    }
+
+    const uint32_t hcrc = bits_(8);
+    if (hcrc != crc8(h, n)) return false;
+
+    static const uint8_t kBps[8] = {0, 8, 12, 0, 16, 20, 24, 32};
+    const uint32_t bps = ssCode ? kBps[ssCode] : bps_;
+    const uint32_t nch = (chCode <= 7) ? chCode + 1 : 2;
+    if (bps > 24 || nch != channels_ || bs > outCap_) return false;
+
+    blockSize_ = bs;
+    frameBps_  = bps;
+    scaleDown_ = (bps > 16) ? bps - 16 : 0;
+    scaleUp_   = (bps < 16) ? 16 - bps : 0;
+    assign_    = (chCode <= 7) ? Assign::Independent : (Assign)(chCode - 7);
+    frameStart_ = (h[1] & 1) ? num : num * (maxBlock_ ? maxBlock_ : bs);
+
+    /* CRC-16 кадра — с его первого байта: заголовок, затем байты, уже
+     * взятые в кэш ридера (заголовок кончается на границе байта) */
+    crc16_ = 0;
+    for (uint32_t i = 0; i < n; ++i) crcPush_(h[i]);
+    crcPush_((uint8_t)hcrc);
+    for (uint32_t i = 0; i < cacheBits_ / 8; ++i) crcPush_((uint8_t)(cache_ >> (24 - 8 * i)));
+    return true;
+}
+
+bool DecoderFlac::decodeFrame_() {
+    for (;;) {
+        if (!readFrameHeader_()) return false;
+
+        bool ok = true;
+        for (uint32_t ch = 0; ch < channels_ && ok; ++ch) {
+            /* Side-канал на бит шире */
+            const bool side = (ch == 0) ? assign_ == Assign::RightSide
+                                        : (assign_ == Assign::LeftSide || assign_ == Assign::MidSide);
+            Sink sink;
+            if (channels_ == 1)   sink = Sink::Final;
+            else if (ch == 0)     sink = (assign_ == Assign::MidSide) ? Sink::Final : Sink::Store;
+            else                  sink = (assign_ == Assign::MidSide) ? Sink::Skip  : Sink::Combine;
+            ok = decodeSubframe_(frameBps_ + (side ? 1 : 0), sink);
+        }
+        if (exhausted_()) return false;
+        if (!ok) continue;  /* битый кадр — ищем следующий sync */
+
+        /* CRC-16 по кадру вместе с полем CRC даёт 0. Кэш ридера забежал
+         * вперёд на cacheBits_/8 байт — берём состояние до них */
+        alignByte_();
+        bits_(16);
+        if (crcHist_[(crcBytes_ - 1 - cacheBits_ / 8) & kCrcHistMask] != 0)
+            continue;  /* битый кадр не выводим — ищем следующий sync */
+        outLen_ = blockSize_;
+        outPos_ = 0;
+        return true;
+    }
+}
+
+/* ═══ Субкадр ═══ */
+
+bool DecoderFlac::decodeSubframe_(uint32_t bps, Sink sink) {
+    const uint32_t h = bits_(8);
+    if (h & 0x80) return false;
+    const uint32_t type = (h >> 1) & 0x3F;
+    uint32_t wasted = 0;
+    if (h & 1) {
+        wasted = unary_() + 1;
+        if (wasted >= bps) return false;
+        bps -= wasted;
+    }
+
+    int32_t* const s = win_ + kMaxOrder;
+
+    if (type == 0) {
+        /* CONSTANT */
+        const int32_t v = sbits_(bps);
+        for (uint32_t pos = 0; pos < blockSize_; pos += kChunk) {
+            uint32_t n = std::min(kChunk, blockSize_ - pos);
+            std::fill(s, s + n, v);
+            emit_(sink, s, pos, n, wasted);
+        }
+        return true;
+    }
+    if (type == 1) {
+        /* VERBATIM */
+        for (uint32_t pos = 0; pos < blockSize_; pos += kChunk) {
+            uint32_t n = std::min(kChunk, blockSize_ - pos);
+            for (uint32_t i = 0; i < n; ++i) s[i] = sbits_(bps);
+            emit_(sink, s, pos, n, wasted);
+        }
+        return !exhausted_();
+    }
+
+    uint32_t order = 0;
+    bool lpc = false;
+    if (type >= 8 && type <= 12) order = type - 8;
+    else if (type >= 32)         { order = type - 31; lpc = true; }
+    else return false;
+    if (order > blockSize_) return false;
+
+    for (uint32_t i = 0; i < order; ++i) s[i] = sbits_(bps);
+
+    uint32_t precision = 0;
+    int32_t  shift = 0;
+    bool     wide = false;
+    if (lpc) {
+        precision = bits_(4) + 1;
+        if (precision == 16) return false;
+        shift = sbits_(5);
+        if (shift < 0) return false;
+        for (uint32_t j = 0; j < order; ++j) qlp_[j] = sbits_(precision);
+        /* Сумма не влезает в 32 бита — считаем в 64 (SMLAL на M4) */
+        uint32_t log2Order = 0;
+        while ((1u << log2Order) < order) log2Order++;
+        wide = bps + precision + log2Order > 32;
+    }
+
+    if (!startResidual_(order)) return false;
+
+    uint32_t fill = order;
+    for (uint32_t pos = 0; pos < blockSize_; pos += kChunk) {
+        const uint32_t n = std::min(kChunk, blockSize_ - pos);
+        if (!readResidual_(s + fill, n - fill)) return false;
+
+        if (sink != Sink::Skip) {
+            /* Восстановление: s[i] = residual[i] + prediction */
+            if (!lpc) {
+                /* p[-k] в начале порции — история в win_ */
+                int32_t* p = s + fill;
+                int32_t* const end = s + n;
+                switch (order) {
+                    case 1: for (; p < end; ++p) p[0] += p[-1]; break;
+                    case 2: for (; p < end; ++p) p[0] += (2 * p[-1]) - p[-2]; break;
+                    case 3: for (; p < end; ++p) p[0] += (3 * (p[-1] - p[-2])) + p[-3]; break;
+                    case 4: for (; p < end; ++p)
+                                p[0] += (4 * (p[-1] + p[-3])) - (6 * p[-2]) - p[-4];
+                            break;
+                    default: break;
+                }
+            } else if (!wide) {
+                /* Корректный поток в 32 бита влезает (wide); битый — только
+                 * заворачивается (uint32, без UB), кадр отсечёт CRC-16 */
+                for (uint32_t i = fill; i < n; ++i) {
+                    const int32_t* hist = s + i - 1;
+                    uint32_t sum = 0;
+                    for (uint32_t j = 0; j < order; ++j)
+                        sum += (uint32_t)qlp_[j] * (uint32_t)hist[-(int32_t)j];
+                    s[i] = (int32_t)((uint32_t)s[i] + (uint32_t)((int32_t)sum >> shift));
+                }
+            } else {
+                for (uint32_t i = fill; i < n; ++i) {
+                    const int32_t* hist = s + i - 1;
+                    int64_t sum = 0;
+                    for (uint32_t j = 0; j < order; ++j) sum += (int64_t)qlp_[j] * hist[-(int32_t)j];
+                    s[i] = (int32_t)((uint32_t)s[i] + (uint32_t)(int32_t)(sum >> shift));
+                }
+            }
+            emit_(sink, s, pos, n, wasted);
+            /* Последние order отсчётов — история для следующей порции */
+            std::memmove(s - order, s + n - order, order * sizeof(int32_t));
+        }
+        fill = 0;
+    }
+    return true;
+}
+
+bool DecoderFlac::startResidual_(uint32_t predOrder) {
+    const uint32_t method = bits_(2);
+    if (method > 1) return false;
+    const uint32_t partOrder = bits_(4);
+    rice_.paramBits   = method ? 5 : 4;
+    rice_.escape      = method ? 31 : 15;
+    rice_.partSamples = blockSize_ >> partOrder;
+    rice_.predOrder   = predOrder;
+    rice_.partLeft    = 0;
+    rice_.first       = true;
+    if ((rice_.partSamples << partOrder) != blockSize_ || rice_.partSamples < predOrder) return false;
+    return true;
+}
+
+bool DecoderFlac::readResidual_(int32_t* dst, uint32_t n) {
+    while (n > 0) {
+        if (rice_.partLeft == 0) {
+            if (exhausted_()) return false;
+            const uint32_t k = bits_(rice_.paramBits);
+            rice_.partLeft = rice_.partSamples - (rice_.first ? rice_.predOrder : 0);
+            rice_.first = false;
+            rice_.raw = (k == rice_.escape);
+            if (rice_.raw) rice_.escBits = bits_(5);
+            else           rice_.k = k;
+            continue;
+        }
+        const uint32_t m = std::min(n, rice_.partLeft);
+        if (rice_.raw) {
+            for (uint32_t i = 0; i < m; ++i) dst[i] = sbits_(rice_.escBits);
+        } else {
+            const uint32_t k = rice_.k;
+            for (uint32_t i = 0; i < m; ++i) {
+                uint32_t v = (unary_() << k) | bits_(k);
+                dst[i] = (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+            }
+        }
+        dst += m;
+        n -= m;
+        rice_.partLeft -= m;
+        if (exhausted_()) return false;
+    }
+    return true;
+}
+
+/* Свод в моно:
+ *   independent: (L + R) >> 1
+ *   left/side:   L - ((S + 1) >> 1)
+ *   right/side:  (S >> 1) + R      — S >> 1 сохраняется первым каналом
+ *   mid/side:    M                 — side только разбирается
+ * Для >16 бит оба слагаемых заранее сдвигаются к 16 битам. */
+void DecoderFlac::emit_(Sink sink, const int32_t* s, uint32_t pos, uint32_t n, uint32_t wasted) {
+    s16* o = out_ + pos;
+    const uint32_t down = scaleDown_;
+    const uint32_t up   = scaleUp_;
+
+    switch (sink) {
+        case Sink::Final:
+            for (uint32_t i = 0; i < n; ++i)
+                o[i] = sat16(shl(shl(s[i], wasted) >> down, up));
+            break;
+        case Sink::Store: {
+            const uint32_t rs = (assign_ == Assign::RightSide) ? 1 : 0;
+            for (uint32_t i = 0; i < n; ++i) o[i] = (s16)((shl(s[i], wasted) >> rs) >> down);
+            break;
+        }
+        case Sink::Combine:
+            if (assign_ == Assign::Independent) {
+                for (uint32_t i = 0; i < n; ++i) {
+                    int32_t m = (o[i] + (shl(s[i], wasted) >> down)) >> 1;
+                    o[i] = sat16(shl(m, up));
+                }
+            } else if (assign_ == Assign::LeftSide) {
+                for (uint32_t i = 0; i < n; ++i) {
+                    int32_t m = o[i] - (((shl(s[i], wasted) >> down) + 1) >> 1);
+                    o[i] = sat16(shl(m, up));
+                }
+            } else {
+                for (uint32_t i = 0; i < n; ++i) {
+                    int32_t m = o[i] + (shl(s[i], wasted) >> down);
+                    o[i] = sat16(shl(m, up));
+                }
+            }
+            break;
+        case Sink::Skip:
+            break;
+    }
+}
+
+/* ═══ DecoderBase ═══ */
+
+uint32_t DecoderFlac::decode(s16* buf, uint32_t maxSamples) {
+    if (!fs_ || (status_ != Status::Ready && status_ != Status::Playing)) return 0;
+    status_ = Status::Playing;
+
+    uint32_t out = 0;
+    while (out < maxSamples) {
+        if (outPos_ >= outLen_) {
+            if (!decodeFrame_()) break;
+            if (skipTo_) {
+                /* Догоняем цель seek внутри кадров */
+                if (frameStart_ + outLen_ <= skipTo_) { outPos_ = outLen_; continue; }
+                if (skipTo_ > frameStart_) outPos_ = (uint32_t)(skipTo_ - frameStart_);
+                skipTo_ = 0;
+            }
+            continue;
+        }
+        uint32_t n = std::min(outLen_ - outPos_, maxSamples - out);
+        std::memcpy(buf + out, out_ + outPos_, n * sizeof(s16));
+        outPos_ += n;
+        out += n;
+    }
+
+    if (out == 0) status_ = Status::Closed;
+    return out;
+}
+
+void DecoderFlac::seek(uint32_t sec) {
+    if (!fs_ || sampleRate_ == 0) return;
+    uint64_t target = (uint64_t)sec * sampleRate_;
+    if (totalSamples_ && target >= totalSamples_) target = totalSamples_ - 1;
+
+    resetInput_();
+    uint64_t off = 0;
+    if (seekPoints_) {
+        /* SEEKTABLE отсортирована; placeholder'ы (0xFF..FF) — в конце */
+        fs_->seek(seekTableOffset_);
+        for (uint32_t i = 0; i < seekPoints_; ++i) {
+            uint8_t pt[18];
+            if (fs_->read(pt, sizeof(pt)) < sizeof(pt)) break;
+            uint64_t sample = be64(pt);
+            if (sample == ~0ull || sample > target) break;
+            off = be64(pt + 8);
+        }
+    } else if (totalSamples_) {
+        /* Без таблицы — пропорционально, с запасом в блок назад;
+         * точный номер сэмпла даст заголовок кадра */
+        uint64_t est = (target > maxBlock_) ? target - maxBlock_ : 0;
+        off = (uint64_t)(fs_->size() - firstFrame_) * est / totalSamples_;
+    }
+
+    fs_->seek(firstFrame_ + (uint32_t)off);
+    outLen_ = outPos_ = 0;
+    skipTo_ = target;
+}
+
+uint32_t DecoderFlac::position() const {
+    return sampleRate_ ? (uint32_t)((frameStart_ + outPos_) / sampleRate_) : 0;
+}
+
+uint32_t DecoderFlac::duration() const {
+    return sampleRate_ ? (uint32_t)(totalSamples_ / sampleRate_) : 0;
+}
+
+void DecoderFlac::close() {
+    fs_ = nullptr; status_ = Status::Closed;
+    resetInput_();
+    outLen_ = outPos_ = 0;
+    frameStart_ = skipTo_ = 0;
+    seekPoints_ = 0;
+    totalSamples_ = 0;
+}
+
+} // namespace ae2
@@ -0,0 +1,129 @@
+#pragma once
+/// @file DecoderFlac.hpp
+/// @brief FLAC: целочисленные fixed/LPC-предсказатели, Rice, SEEKTABLE.
+///
+/// Объект (битовый ридер, окно истории предсказателя) живёт в decoderMem_.
+/// Кадр, уже сведённый в моно, — в общем scratch на kMaxBlockSize
+/// сэмплов: второй канал сводится с первым по ходу декодирования, поэтому
+/// на отсчёт хранится один s16. Вход читается прямо из буфера FsAdapter.
+
+#include "DecoderBase.hpp"
+
+namespace ae2 {
+
+class DecoderFlac final : public DecoderBase {
+public:
+    /// Максимальный размер блока (FLAC subset, пресеты -0..-8 — 4096).
+    static constexpr uint32_t kMaxBlockSize = 4096;
+    static constexpr size_t   kScratchBytes = kMaxBlockSize * sizeof(s16);
+
+    static constexpr const char* kName = "flac";
+    static constexpr bool accepts(CodecDetect::Type t) { return t == CodecDetect::Type::Flac; }
+
+    /// @param scratch         буфер кадра, ≥ максимального блока потока
+    /// @param scratchSamples  его размер в сэмплах
+    DecoderFlac(s16* scratch, uint32_t scratchSamples)
+        : out_(scratch), outCap_(scratchSamples) {}
+    explicit DecoderFlac(const DecoderEnv& env)
+        : DecoderFlac(env.scratch.as<s16>(kMaxBlockSize), kMaxBlockSize) {}
+
+    bool     open(FsAdapter& fs) override;
+    uint32_t decode(s16* buf, uint32_t maxSamples) override;
+    void     seek(uint32_t sec) override;
+	[[nodiscard]] uint32_t position() const override;
+	[[nodiscard]] uint32_t duration() const override;
+	[[nodiscard]] uint32_t sampleRate() const override { return sampleRate_; }
+	void     close() override;
+
+private:
+    enum class Assign : uint8_t { Independent, LeftSide, RightSide, MidSide };
+    /// Куда идут отсчёты субкадра.
+    enum class Sink : uint8_t {
+        Final,    ///< сразу в моно (моно-поток, mid канала mid/side)
+        Store,    ///< первый канал стерео — ждёт второго
+        Combine,  ///< второй канал — сводится с сохранённым
+        Skip      ///< side при mid/side: моно = mid, только разбор
+    };
+
+    FsAdapter* fs_ = nullptr;
+
+    /* ── Битовый ридер поверх peek()/consume() ── */
+    const uint8_t* inBase_ = nullptr;
+    const uint8_t* inPtr_  = nullptr;
+    const uint8_t* inEnd_  = nullptr;
+    uint32_t cache_     = 0;  ///< биты выровнены по старшему разряду
+    uint32_t cacheBits_ = 0;
+    uint32_t padBits_   = 0;  ///< нулевых бит, добавленных за концом файла
+
+    /// Прочитаны биты за концом файла.
+    [[nodiscard]] bool exhausted_() const { return padBits_ > cacheBits_; }
+
+    void     resetInput_();
+    bool     fetch_();
+    void     refill_();
+    uint32_t bits_(uint32_t n);
+    int32_t  sbits_(uint32_t n);
+    uint32_t unary_();
+    void     alignByte_() { bits_(cacheBits_ & 7); }
+
+    /* CRC-16 кадра по байтам, входящим в кэш; история — чтобы отмотать
+     * состояние на байты, взятые кэшем наперёд (≤ 4) */
+    static constexpr uint32_t kCrcHistMask = 7;
+    uint16_t crc16_    = 0;
+    uint16_t crcHist_[kCrcHistMask + 1]{};
+    uint32_t crcBytes_ = 0;
+
+    void crcPush_(uint8_t b);
+
+    /* ── STREAMINFO / SEEKTABLE ── */
+    uint32_t sampleRate_      = 44100;
+    uint32_t channels_        = 2;
+    uint32_t bps_             = 16;
+    uint32_t maxBlock_        = 0;
+    uint64_t totalSamples_    = 0;
+    uint32_t firstFrame_      = 0;  ///< смещение первого кадра в файле
+    uint32_t seekTableOffset_ = 0;
+    uint32_t seekPoints_      = 0;
+
+    /* ── Текущий кадр ── */
+    s16*     out_;
+    uint32_t outCap_;
+    uint32_t outLen_     = 0;
+    uint32_t outPos_     = 0;
+    uint32_t blockSize_  = 0;
+    uint32_t frameBps_   = 16;
+    uint32_t scaleDown_  = 0;  ///< >16 бит → 16
+    uint32_t scaleUp_    = 0;  ///< <16 бит → 16
+    uint64_t frameStart_ = 0;  ///< номер первого сэмпла кадра
+    uint64_t skipTo_     = 0;  ///< после seek: отбросить сэмплы до этого
+    Assign   assign_     = Assign::Independent;
+
+    /* ── Субкадр: окно [история kMaxOrder | порция kChunk] ── */
+    static constexpr uint32_t kMaxOrder = 32;
+    static constexpr uint32_t kChunk    = 256;
+    int32_t win_[kMaxOrder + kChunk]{};
+    int32_t qlp_[kMaxOrder]{};
+
+    /* ── Residual: состояние разбиения ── */
+    struct Rice {
+        uint32_t paramBits   = 4;
+        uint32_t escape      = 15;
+        uint32_t partSamples = 0;
+        uint32_t partLeft    = 0;
+        uint32_t predOrder   = 0;
+        uint32_t k           = 0;
+        uint32_t escBits     = 0;
+        bool     first       = true;
+        bool     raw         = false;
+    } rice_;
+
+    bool decodeFrame_();
+    bool readFrameHeader_();
+    bool parseFrameHeader_(uint32_t b1);
+    bool decodeSubframe_(uint32_t bps, Sink sink);
+    bool startResidual_(uint32_t predOrder);
+    bool readResidual_(int32_t* dst, uint32_t n);
+    void emit_(Sink sink, const int32_t* s, uint32_t pos, uint32_t n, uint32_t wasted);
+};
+
+} // namespace ae2
@@ -0,0 +1,225 @@
+/// @file DecoderG711.cpp — G.711 A-law / μ-law
+#include "DecoderG711.hpp"
+#include "FsAdapter/FsAdapter.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__ARM_FEATURE_SIMD32)
+#  include <arm_acle.h>
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#  include <arm_neon.h>
+#endif
+
+namespace ae2 {
+
+static uint16_t r16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1]<<8)); }
+static uint32_t r32(const uint8_t* p) {
+    return p[0]|((uint32_t)p[1]<<8)|((uint32_t)p[2]<<16)|((uint32_t)p[3]<<24);
+}
+
+/* ── Таблицы: 256 значений на закон, считаются при компиляции ── */
+
+static constexpr s16 alawSample(uint8_t alaw) {
+    alaw ^= 0x55;
+    int sign = (alaw & 0x80) ? -1 : 1;
+    int exp  = (alaw >> 4) & 7;
+    int mant = alaw & 0x0F;
+    int val  = (exp == 0) ? ((mant << 4) + 8) : (((mant << 4) + 0x108) << (exp - 1));
+    return (s16)(sign * val);
+}
+
+static constexpr s16 ulawSample(uint8_t ulaw) {
+    ulaw = (uint8_t)~ulaw;
+    int sign = (ulaw & 0x80) ? -1 : 1;
+    int exp  = (ulaw >> 4) & 7;
+    int mant = ulaw & 0x0F;
+    int val  = (((mant << 3) + 0x84) << exp) - 0x84;
+    return (s16)(sign * val);
+}
+
+template<G711Law Law>
+static constexpr std::array<s16, 256> makeLut() {
+    std::array<s16, 256> t{};
+    for (int i = 0; i < 256; ++i)
+        t[i] = (Law == G711Law::Alaw) ? alawSample((uint8_t)i) : ulawSample((uint8_t)i);
+    return t;
+}
+
+template<G711Law Law>
+static constexpr std::array<s16, 256> kLut = makeLut<Law>();
+
+/* ── Ядра ── */
+
+/// Моно: raw лежит в верхней части dst (raw = (uint8_t*)dst + n).
+/// Читаем 4 байта раньше, чем пишем 8 — непрочитанное не затирается.
+static void expandMono(const s16* lut, const uint8_t* raw, s16* dst, uint32_t n) {
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint8_t a = raw[i], b = raw[i + 1], c = raw[i + 2], d = raw[i + 3];
+        dst[i]     = lut[a];
+        dst[i + 1] = lut[b];
+        dst[i + 2] = lut[c];
+        dst[i + 3] = lut[d];
+    }
+    for (; i < n; ++i) dst[i] = lut[raw[i]];
+}
+
+/// Стерео → моно на месте: кадр (2 байта) превращается в один s16
+/// по тому же адресу. Среднее — (L + R) >> 1 на всех платформах.
+static void expandStereo(const s16* lut, uint8_t* raw, s16* dst, uint32_t n) {
+    uint32_t i = 0;
+#if defined(__ARM_FEATURE_SIMD32)
+    /* Cortex-M4: два кадра за раз, SHADD16 усредняет обе половины слова */
+    for (; i + 2 <= n; i += 2) {
+        const uint8_t* f = raw + i * 2;
+        uint32_t l = (uint16_t)lut[f[0]] | ((uint32_t)(uint16_t)lut[f[2]] << 16);
+        uint32_t r = (uint16_t)lut[f[1]] | ((uint32_t)(uint16_t)lut[f[3]] << 16);
+        uint32_t m = (uint32_t)__shadd16((int16x2_t)l, (int16x2_t)r);
+        std::memcpy(dst + i, &m, sizeof(m));
+    }
+#elif defined(__SSE2__)
+    for (; i + 8 <= n; i += 8) {
+        uint8_t f[16];
+        std::memcpy(f, raw + i * 2, sizeof(f));
+        __m128i l = _mm_setr_epi16(lut[f[0]], lut[f[2]], lut[f[4]],  lut[f[6]],
+                                   lut[f[8]], lut[f[10]], lut[f[12]], lut[f[14]]);
+        __m128i r = _mm_setr_epi16(lut[f[1]], lut[f[3]], lut[f[5]],  lut[f[7]],
+                                   lut[f[9]], lut[f[11]], lut[f[13]], lut[f[15]]);
+        /* floor((l + r) / 2) без переполнения: (l>>1) + (r>>1) + (l & r & 1) */
+        __m128i m = _mm_add_epi16(_mm_add_epi16(_mm_srai_epi16(l, 1), _mm_srai_epi16(r, 1)),
+                                  _mm_and_si128(_mm_and_si128(l, r), _mm_set1_epi16(1)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), m);
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= n; i += 8) {
+        const uint8_t* f = raw + i * 2;
+        int16_t l[8];
+        int16_t r[8];
+        for (int k = 0; k < 8; ++k) { l[k] = lut[f[k * 2]]; r[k] = lut[f[(k * 2) + 1]]; }
+        vst1q_s16(dst + i, vhaddq_s16(vld1q_s16(l), vld1q_s16(r)));
+    }
+#endif
+    for (; i < n; ++i) {
+        uint8_t a = raw[i * 2], b = raw[(i * 2) + 1];
+        dst[i] = (s16)(((int32_t)lut[a] + lut[b]) >> 1);
+    }
+}
+
+/* ── DecoderG711 ── */
+
+template<G711Law Law>
+bool DecoderG711<Law>::open(FsAdapter& fs) {
+    close();
+    fs_ = &fs;
+    fs.seek(0);
+    uint8_t hdr[12];
+    size_t hn = fs.read(hdr, 12);
+
+    if (hn < 12 || std::memcmp(hdr,"RIFF",4) || std::memcmp(hdr+8,"WAVE",4)) {
+        /* Headerless: весь файл — данные, формат задан снаружи */
+        if (rawRate_ == 0 || fs.size() == 0) return false;
+        channels_   = rawChannels_;
+        sampleRate_ = rawRate_;
+        dataOffset_ = 0;
+        dataSize_   = fs.size();
+    } else {
+        uint32_t pos = 12;
+        bool gotFmt = false;
+        bool gotData = false;
+        while (pos+8 < fs.size()) {
+            fs.seek(pos);
+            uint8_t ch[8]; if (fs.read(ch,8)<8) break;
+            uint32_t sz = r32(ch+4);
+            if (!std::memcmp(ch,"fmt ",4) && sz>=16) {
+                uint8_t f[16]; if (fs.read(f,16)<16) break;
+                if (r16(f) != kWavFormat) return false;
+                channels_   = r16(f+2);
+                sampleRate_ = r32(f+4);
+                gotFmt = true;
+            } else if (!std::memcmp(ch,"data",4)) {
+                dataOffset_ = pos+8; dataSize_ = sz; gotData = true;
+            }
+            pos += 8+sz; if (sz&1) pos++;
+            if (gotFmt && gotData) break;
+        }
+        if (!gotFmt || !gotData || channels_ == 0) return false;
+    }
+    bytesRead_ = 0;
+    fs.seek(dataOffset_);
+    status_ = Status::Ready;
+    return true;
+}
+
+template<G711Law Law>
+uint32_t DecoderG711<Law>::decode(s16* buf, uint32_t maxSamples) {
+    if (!fs_ || (status_ != Status::Ready && status_ != Status::Playing)) return 0;
+    status_ = Status::Playing;
+    uint32_t bytesLeft = (dataSize_ > bytesRead_) ? (dataSize_ - bytesRead_) : 0;
+    uint32_t framesToRead = bytesLeft / channels_;
+	framesToRead		  = std::min(framesToRead, maxSamples);
+	if (framesToRead == 0) { status_ = Status::Closed; return 0; }
+
+    const s16* lut = kLut<Law>.data();
+
+    /* ≤2 каналов: сырые байты читаем прямо в выходной буфер, без tmp */
+    if (channels_ <= 2) {
+        uint32_t rawBytes = framesToRead * channels_;
+        uint8_t* raw = reinterpret_cast<uint8_t*>(buf) + ((framesToRead * 2) - rawBytes);
+        size_t rd = fs_->read(raw, rawBytes);
+        uint32_t frames = (uint32_t)(rd / channels_);
+        bytesRead_ += frames * channels_;
+        if (channels_ == 1) expandMono(lut, raw, buf, frames);
+        else                expandStereo(lut, raw, buf, frames);
+        return frames;
+    }
+
+    /* Многоканальный (редко): чанками через небольшой стековый буфер */
+    uint8_t chunk[240];
+    const uint32_t chunkFrames = (uint32_t)sizeof(chunk) / channels_;
+    uint32_t out = 0;
+    while (out < framesToRead && chunkFrames > 0) {
+        uint32_t want = std::min(chunkFrames, framesToRead - out);
+        size_t rd = fs_->read(chunk, want * channels_);
+        uint32_t frames = (uint32_t)(rd / channels_);
+        for (uint32_t i = 0; i < frames; ++i) {
+            const uint8_t* f = chunk + (i * channels_);
+            int32_t sum = 0;
+            for (uint16_t c = 0; c < channels_; ++c) sum += lut[f[c]];
+            buf[out + i] = (s16)(sum / channels_);
+        }
+        out += frames;
+        bytesRead_ += frames * channels_;
+        if (frames < want) break;
+    }
+    return out;
+}
+
+template<G711Law Law>
+void DecoderG711<Law>::seek(uint32_t sec) {
+    if (!fs_) return;
+    uint32_t bytePos = sec * sampleRate_ * channels_;
+	bytePos			 = std::min(bytePos, dataSize_);
+	bytesRead_ = bytePos;
+    fs_->seek(dataOffset_ + bytePos);
+}
+
+template<G711Law Law>
+uint32_t DecoderG711<Law>::position() const {
+    return (sampleRate_ && channels_) ? bytesRead_ / channels_ / sampleRate_ : 0;
+}
+
+template<G711Law Law>
+uint32_t DecoderG711<Law>::duration() const {
+    return (sampleRate_ && channels_) ? dataSize_ / channels_ / sampleRate_ : 0;
+}
+
+template<G711Law Law>
+void DecoderG711<Law>::close() { fs_ = nullptr; status_ = Status::Closed; bytesRead_ = 0; }
+
+template class DecoderG711<G711Law::Alaw>;
+template class DecoderG711<G711Law::Ulaw>;
+
+} // namespace ae2
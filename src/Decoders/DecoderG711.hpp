@@ -0,0 +1,61 @@
+#pragma once
+/// @file DecoderG711.hpp
+/// @brief G.711 A-law / μ-law: WAV (fmt 6/7) и headerless raw, декод по LUT.
+
+#include "DecoderBase.hpp"
+
+namespace ae2 {
+
+enum class G711Law : uint8_t { Alaw, Ulaw };
+
+template<G711Law Law>
+class DecoderG711 final : public DecoderBase {
+public:
+    static constexpr CodecDetect::Type kWavType = (Law == G711Law::Alaw) ? CodecDetect::Type::WavAlaw
+                                                                         : CodecDetect::Type::WavUlaw;
+    static constexpr CodecDetect::Type kRawType = (Law == G711Law::Alaw) ? CodecDetect::Type::RawAlaw
+                                                                         : CodecDetect::Type::RawUlaw;
+    static constexpr const char* kName = (Law == G711Law::Alaw) ? "alaw" : "ulaw";
+    static constexpr bool accepts(CodecDetect::Type t) { return t == kWavType || t == kRawType; }
+
+    DecoderG711() = default;
+    /// Headerless-тип получает формат из env.
+    explicit DecoderG711(const DecoderEnv& env) {
+        if (env.type == kRawType) setRawFormat(env.rawRate, env.rawChannels);
+    }
+
+    /// Формат headerless-потока (.alaw/.ulaw). Вызывать до open();
+    /// без него файл без RIFF-заголовка не открывается.
+    void setRawFormat(uint32_t sampleRate, uint16_t channels) {
+        rawRate_     = sampleRate;
+        rawChannels_ = channels ? channels : 1;
+    }
+
+    bool     open(FsAdapter& fs) override;
+    uint32_t decode(s16* buf, uint32_t maxSamples) override;
+    void     seek(uint32_t sec) override;
+	[[nodiscard]] uint32_t position() const override;
+	[[nodiscard]] uint32_t duration() const override;
+	[[nodiscard]] uint32_t sampleRate() const override { return sampleRate_; }
+	void     close() override;
+
+private:
+    FsAdapter* fs_ = nullptr;
+    uint16_t channels_    = 1;
+    uint32_t sampleRate_  = 8000;
+    uint32_t dataOffset_  = 0;
+    uint32_t dataSize_    = 0;
+    uint32_t bytesRead_   = 0;
+    uint32_t rawRate_     = 0;  ///< 0 — raw не разрешён
+    uint16_t rawChannels_ = 1;
+
+    static constexpr uint16_t kWavFormat = (Law == G711Law::Alaw) ? 6 : 7;
+};
+
+using DecoderAlaw = DecoderG711<G711Law::Alaw>;
+using DecoderUlaw = DecoderG711<G711Law::Ulaw>;
+
+extern template class DecoderG711<G711Law::Alaw>;
+extern template class DecoderG711<G711Law::Ulaw>;
+
+} // namespace ae2
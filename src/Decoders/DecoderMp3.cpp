@@ -11,14 +11,38 @@
 
 namespace ae2 {
 
+namespace {
+
+/// Free-format заголовок (индекс битрейта 0): длину кадра Helix находит
+/// сам по следующему sync, parseHeader такой отвергает.
+bool freeFormat(const uint8_t* p) {
+    return p[0] == 0xFF && (p[1] & 0xE0) == 0xE0 &&
+           ((p[1] >> 3) & 3) != 1 && ((p[1] >> 1) & 3) != 0 &&
+           (p[2] >> 4) == 0 && ((p[2] >> 2) & 3) != 3;
+}
+
+/// Смещение первого целого заголовка ID3v2 или APEv2 в [p, p + n);
+/// n — не найден.
+uint32_t findTag(const uint8_t* p, uint32_t n) {
+    for (uint32_t i = 0; i + 10 <= n; ++i) {
+        if (p[i] == 'I' && Mp3Duration::id3v2Size(p + i)) return i;
+        if (p[i] == 'A' && i + 32 <= n && Mp3Duration::apeTagSize(p + i)) return i;
+    }
+    return n;
+}
+
+} // namespace
+
 bool DecoderMp3::open(FsAdapter& fs) {
     close();
+    if (!pcm_) return false;
     fs_ = &fs;
 
     hDec_ = MP3InitDecoder();
     if (!hDec_) return false;
 
     inBufLen_ = inBufPos_ = 0;
+    tagAt_ = kTagUnknown;
     totalSamplesDecoded_ = 0;
 
     /* Оценка длительности без полного прохода */
@@ -27,75 +51,172 @@ bool DecoderMp3::open(FsAdapter& fs) {
     sampleRate_ = (dur.sampleRate > 0) ? dur.sampleRate : 44100;
     channels_   = (dur.channels > 0) ? dur.channels : 2;
 
-    /* Пропуск ID3v2 тега */
-    fs.seek(0);
-    uint8_t id3[10];
-    if (fs.read(id3, 10) >= 10 && id3[0]=='I' && id3[1]=='D' && id3[2]=='3') {
-        uint32_t sz = ((uint32_t)(id3[6]&0x7F)<<21) | ((uint32_t)(id3[7]&0x7F)<<14) |
-                      ((uint32_t)(id3[8]&0x7F)<<7)  | (uint32_t)(id3[9]&0x7F);
-        fs.seek(sz + 10);
-    } else {
-        fs.seek(0);
-    }
+    /* Звук без тегов в начале и в конце; оставляет позицию на start */
+    auto range = Mp3Duration::audioRange(fs, fs.size());
+    dataStart_ = range.start;
+    dataEnd_   = range.end;
+    synced_    = false;
 
     status_ = Status::Ready;
     return true;
 }
 
-bool DecoderMp3::refillInput_() {
-    if (!fs_) return false;
+uint32_t DecoderMp3::refillInput_() {
+    if (!fs_) return 0;
     /* Сдвигаем остаток в начало буфера */
     uint32_t remaining = inBufLen_ - inBufPos_;
     if (remaining > 0 && inBufPos_ > 0)
         std::memmove(inBuf_, inBuf_ + inBufPos_, remaining);
     inBufLen_ = remaining;
     inBufPos_ = 0;
-    /* Дочитываем */
-    size_t space = kInBufSize - inBufLen_;
-    if (space > 0) {
-        size_t rd = fs_->read(inBuf_ + inBufLen_, space);
-        inBufLen_ += (uint32_t)rd;
+    tagAt_    = kTagUnknown;
+    /* Дочитываем, но не хвостовые теги */
+    uint32_t pos   = fs_->tell();
+    size_t   space = std::min<size_t>(kInBufSize - inBufLen_, pos < dataEnd_ ? dataEnd_ - pos : 0);
+    if (space == 0) return 0;
+    size_t rd = fs_->read(inBuf_ + inBufLen_, space);
+    if (rd == 0) dataEnd_ = pos;  /* файл короче, чем казалось */
+    inBufLen_ += (uint32_t)rd;
+    return (uint32_t)rd;
+}
+
+bool DecoderMp3::atEnd_() const { return fs_->tell() >= dataEnd_; }
+
+void DecoderMp3::skip_(uint32_t bytes) {
+    uint32_t avail = inBufLen_ - inBufPos_;
+    if (bytes <= avail) {
+        inBufPos_ += bytes;
+        return;
     }
-    return inBufLen_ > 0;
+    /* Тег длиннее буфера (APIC на сотни КБ) — перескок без чтения */
+    uint32_t target = fs_->tell() + (bytes - avail);
+    fs_->seek(std::min(target, dataEnd_));
+    inBufLen_ = inBufPos_ = 0;
+    tagAt_    = kTagUnknown;
 }
 
-int DecoderMp3::findSyncAndDecode_(s16* pcm, MP3FrameInfo& info) {
-    /* Ищем sync word в доступных данных */
+bool DecoderMp3::junk_(uint32_t n) {
+    inBufPos_ += n;
+    if (n >= skipLeft_) {
+        skipLeft_ = 0;
+        return false;
+    }
+    skipLeft_ -= n;
+    return true;
+}
+
+int DecoderMp3::findSyncAndDecode_(MP3FrameInfo& info) {
     for (;;) {
-        int avail = (int)(inBufLen_ - inBufPos_);
-        if (avail < 4) return -1;  /* нужно больше данных */
-
-        int offset = MP3FindSyncWord(inBuf_ + inBufPos_, avail);
-        if (offset < 0) {
-            /* sync не найден — весь буфер мусор, сдвигаем */
-            inBufPos_ = inBufLen_;
-            return -1;
+        uint32_t avail = inBufLen_ - inBufPos_;
+        if (avail < 4) return kNeedData;
+        const uint8_t* p = inBuf_ + inBufPos_;
+
+        /* ── Теги посреди потока (склейка файлов, повторный ID3v2) ── */
+        if (p[0] == 'I' || p[0] == 'A' || p[0] == 'T') {
+            if (avail < 32 && !atEnd_()) return kNeedData;
+            uint32_t tag = 0;
+            bool isHeader = false;
+            if (avail >= 10) tag = Mp3Duration::id3v2Size(p);
+            if (!tag && avail >= 32) {
+                tag = Mp3Duration::apeTagSize(p, &isHeader);
+                if (tag && !isHeader) tag = 32;  /* footer: тело уже позади */
+            }
+            if (!tag && p[1] == 'A' && p[2] == 'G') tag = Mp3Duration::kId3v1Size;
+            if (tag) {
+                skip_(tag);
+                synced_ = false;
+                continue;
+            }
         }
-        inBufPos_ += (uint32_t)offset;
 
-        /* Декодируем фрейм */
-        unsigned char* ptr = inBuf_ + inBufPos_;
-        int bytesLeft = (int)(inBufLen_ - inBufPos_);
-        int err = MP3Decode(hDec_, &ptr, &bytesLeft, pcm, 0);
+        /* ── Поиск кандидата ── */
+        if (!synced_ || p[0] != 0xFF) {
+            int offset = MP3FindSyncWord(const_cast<unsigned char*>(p), (int)avail);
+            /* Тег в мусоре до sync: его содержимое (обложка) не сканируем */
+            uint32_t limit = offset < 0 ? avail : (uint32_t)offset;
+            if (tagAt_ == kTagUnknown || tagAt_ < inBufPos_)
+                tagAt_ = inBufPos_ + findTag(p, avail);
+            const uint32_t tag = tagAt_ - inBufPos_;
+            if (tag < limit && tag > 0) {
+                synced_ = false;
+                if (!junk_(tag)) return kBudget;
+                continue;
+            }
+            if (offset < 0) {
+                /* sync не найден — хвост оставляем: может быть началом тега */
+                const uint32_t n = avail > 32 ? avail - 32 : 0;
+                if (n == 0) return kNeedData;
+                return junk_(n) ? kNeedData : kBudget;
+            }
+            if (offset > 0) {
+                synced_ = false;
+                if (!junk_((uint32_t)offset)) return kBudget;
+                continue;
+            }
+        }
 
-        /* Обновляем позицию (MP3Decode двигает ptr) */
-        inBufPos_ = inBufLen_ - (uint32_t)bytesLeft;
+        /* ── Проверка кандидата: следующий кадр того же потока ── */
+        if (!synced_) {
+            const auto hdr = Mp3Duration::parseHeader(p);
+            if (hdr.valid) {
+                const uint32_t next = hdr.frameSize;
+                if (next + 4 > avail) {
+                    if (!atEnd_()) return kNeedData;
+                    /* Последний кадр файла: соседа нет */
+                } else {
+                    const uint8_t* q = p + next;
+                    if (!Mp3Duration::parseHeader(q).valid && !freeFormat(q)) {
+                        if (!junk_(1)) return kBudget;
+                        continue;
+                    }
+                    if (!Mp3Duration::sameStream(p, q)) {
+                        if (!junk_(1)) return kBudget;
+                        continue;
+                    }
+                }
+            } else if (!freeFormat(p)) {
+                if (!junk_(1)) return kBudget;
+                continue;
+            }
+        }
+
+        /* ── Декодируем фрейм ── */
+        unsigned char* ptr = inBuf_ + inBufPos_;
+        int bytesLeft = (int)avail;
+        int err = MP3Decode(hDec_, &ptr, &bytesLeft, pcm_, 0);
 
         if (err == ERR_MP3_NONE) {
+            inBufPos_ = inBufLen_ - (uint32_t)bytesLeft;
+            synced_ = true;
             MP3GetLastFrameInfo(hDec_, &info);
             return info.outputSamps;  /* total samples (channels * samplesPerCh) */
         }
-        if (err == ERR_MP3_INDATA_UNDERFLOW || err == ERR_MP3_MAINDATA_UNDERFLOW) {
-            return -1;  /* нужно больше данных */
+        if (err == ERR_MP3_INDATA_UNDERFLOW) {
+            /* Кадр не весь в буфере: позицию не двигаем, дочитаем и повторим.
+             * В конце файла это обрезанный последний кадр — decode() закончит */
+            return kNeedData;
         }
-        /* Другие ошибки — пропускаем байт и пробуем дальше */
-        if (inBufPos_ < inBufLen_) inBufPos_++;
+        if (err == ERR_MP3_MAINDATA_UNDERFLOW) {
+            /* Кадр съеден, но bit reservoir ещё пуст (после seek) — дальше */
+            inBufPos_ = inBufLen_ - (uint32_t)bytesLeft;
+            synced_ = true;
+            continue;
+        }
+        /* Битый кадр: пересинхронизация с проверкой соседа */
+        synced_ = false;
+        if (badLeft_ == 0 || --badLeft_ == 0) return kBudget;
+        const uint32_t pos = inBufLen_ - (uint32_t)bytesLeft;
+        if (pos > inBufPos_) inBufPos_ = pos;
+        else if (!junk_(1)) return kBudget;
     }
 }
 
 uint32_t DecoderMp3::decode(s16* buf, uint32_t maxSamples) {
     if (!hDec_ || !fs_ || (status_ != Status::Ready && status_ != Status::Playing)) return 0;
-    status_ = Status::Playing;
+    status_   = Status::Playing;
+    skipping_ = false;
+    skipLeft_ = kMaxSkipBytes;
+    badLeft_  = kMaxBadFrames;
 
     uint32_t totalOut = 0;
 
@@ -103,7 +224,7 @@ uint32_t DecoderMp3::decode(s16* buf, uint32_t maxSamples) {
     if (leftoverLen_ > leftoverPos_) {
         uint32_t avail = leftoverLen_ - leftoverPos_;
         uint32_t n = std::min(avail, maxSamples);
-        std::memcpy(buf, leftover_ + leftoverPos_, n * sizeof(s16));
+        std::memcpy(buf, pcm_ + leftoverPos_, n * sizeof(s16));
         leftoverPos_ += n;
         totalOut += n;
         totalSamplesDecoded_ += n;
@@ -111,23 +232,21 @@ uint32_t DecoderMp3::decode(s16* buf, uint32_t maxSamples) {
             leftoverLen_ = leftoverPos_ = 0;
     }
 
-    /* Helix декодирует до 1152 stereo сэмплов = 2304 s16 значений на фрейм */
-    s16 pcm[MAX_NSAMP * MAX_NCHAN * MAX_NGRAN];  /* 576*2*2 = 2304 */
-
     while (totalOut < maxSamples) {
-        if (inBufLen_ - inBufPos_ < MAINBUF_SIZE) {
-            if (!refillInput_()) break;
-            if (inBufLen_ == 0) break;
-        }
+        if (inBufLen_ - inBufPos_ < MAINBUF_SIZE) refillInput_();
 
         MP3FrameInfo info{};
-        int totalSamps = findSyncAndDecode_(pcm, info);
-        if (totalSamps <= 0) {
-            /* Попробуем дочитать */
-            if (!refillInput_() || inBufLen_ == 0) break;
-            totalSamps = findSyncAndDecode_(pcm, info);
-            if (totalSamps <= 0) break;
+        int totalSamps = findSyncAndDecode_(info);
+        if (totalSamps == kNeedData) {
+            if (refillInput_() == 0) break;  /* конец звука */
+            continue;
+        }
+        if (totalSamps == kBudget) {
+            /* Мусор не кончился — отдаём, что есть; 0 — ещё не конец */
+            skipping_ = (totalOut == 0);
+            break;
         }
+        if (totalSamps <= 0 || info.nChans <= 0) continue;
 
         /* Обновляем параметры из фактического фрейма */
         if (info.samprate > 0) sampleRate_ = (uint32_t)info.samprate;
@@ -137,14 +256,13 @@ uint32_t DecoderMp3::decode(s16* buf, uint32_t maxSamples) {
         uint32_t space = maxSamples - totalOut;
 
         if (monoSamples > space) {
-            /* Фрейм не помещается целиком — даунмикс в leftover_, вывод сколько есть места */
+            /* Фрейм не помещается целиком — даунмикс на месте в pcm_ (запись
+             * по i отстаёт от чтения по 2i), вывод сколько есть места */
             if (info.nChans == 2) {
                 for (uint32_t i = 0; i < monoSamples; ++i)
-					leftover_[i] = (s16)(((int32_t)pcm[i * 2] + pcm[(i * 2) + 1]) / 2);
-			} else {
-                std::memcpy(leftover_, pcm, monoSamples * sizeof(s16));
-            }
-            std::memcpy(buf + totalOut, leftover_, space * sizeof(s16));
+					pcm_[i] = (s16)(((int32_t)pcm_[i * 2] + pcm_[(i * 2) + 1]) / 2);
+			}
+            std::memcpy(buf + totalOut, pcm_, space * sizeof(s16));
             totalOut += space;
             totalSamplesDecoded_ += space;
             leftoverPos_ = space;
@@ -155,29 +273,32 @@ uint32_t DecoderMp3::decode(s16* buf, uint32_t maxSamples) {
         /* Весь фрейм помещается */
         if (info.nChans == 2) {
             for (uint32_t i = 0; i < monoSamples; ++i)
-				buf[totalOut + i] = (s16)(((int32_t)pcm[i * 2] + pcm[(i * 2) + 1]) / 2);
+				buf[totalOut + i] = (s16)(((int32_t)pcm_[i * 2] + pcm_[(i * 2) + 1]) / 2);
 		} else {
-            std::memcpy(buf + totalOut, pcm, monoSamples * sizeof(s16));
+            std::memcpy(buf + totalOut, pcm_, monoSamples * sizeof(s16));
         }
         totalOut += monoSamples;
         totalSamplesDecoded_ += monoSamples;
     }
 
-    if (totalOut == 0) status_ = Status::Closed;
+    if (totalOut == 0 && !skipping_) status_ = Status::Closed;
     return totalOut;
 }
 
 void DecoderMp3::seek(uint32_t sec) {
     if (!fs_) return;
-    /* Грубый seek по среднему битрейту */
-    uint32_t fileSize = fs_->size();
-    if (duration_ > 0) {
-        uint32_t bytePos = (uint32_t)((uint64_t)fileSize * sec / duration_);
+    /* Грубый seek по среднему битрейту; попадаем в середину кадра —
+     * синхронизация с проверкой соседа */
+    uint32_t audioSize = dataEnd_ - dataStart_;
+    if (duration_ > 0 && sec < duration_) {
+        uint32_t bytePos = dataStart_ + (uint32_t)((uint64_t)audioSize * sec / duration_);
         fs_->seek(bytePos);
     } else {
-        fs_->seek(0);
+        fs_->seek(duration_ > 0 ? dataEnd_ : dataStart_);
     }
     inBufLen_ = inBufPos_ = 0;
+    tagAt_ = kTagUnknown;
+    synced_ = false;
     leftoverLen_ = leftoverPos_ = 0;
     /* Helix не имеет mp3dec_init; пересоздаём декодер для сброса состояния */
     if (hDec_) { MP3FreeDecoder(hDec_); }
@@ -198,7 +319,11 @@ void DecoderMp3::close() {
     }
     fs_ = nullptr;
     status_ = Status::Closed;
+    skipping_ = false;
     inBufLen_ = inBufPos_ = 0;
+    tagAt_ = kTagUnknown;
+    dataStart_ = dataEnd_ = 0;
+    synced_ = false;
     leftoverLen_ = leftoverPos_ = 0;
     totalSamplesDecoded_ = 0;
 }
@@ -4,6 +4,18 @@
 ///
 /// Helix специально оптимизирован для ARM: fixed-point DSP, ~6KB RAM,
 /// в 2-5x быстрее minimp3 на Cortex-M4.
+///
+/// PCM фрейма (до 1152 стерео-сэмплов) декодируется в общий scratch, а не
+/// на стек; там же после сведения в моно лежит недоотданный остаток.
+///
+/// Синхронизация: кандидат в заголовок принимается, только если за ним
+/// (через frameSize) стоит заголовок того же потока, — MP3Decode не
+/// зовётся на случайных 0xFF в мусоре. Теги (ID3v2, APEv2, ID3v1) в начале,
+/// в конце и посреди потока пропускаются целиком через seek. На один
+/// decode() — не больше kMaxSkipBytes мусора и kMaxBadFrames битых кадров;
+/// упёрлись — decode() возвращает что есть, при 0 — skipping(). Работа на
+/// мусоре линейна по пропущенным байтам: поиск sync продолжается с
+/// отвергнутого кандидата, позиция тега в буфере запоминается.
 
 #include "DecoderBase.hpp"
 #include "mp3dec.h"   // Helix public API
@@ -12,6 +24,14 @@ namespace ae2 {
 
 class DecoderMp3 final : public DecoderBase {
 public:
+    static constexpr const char* kName = "mp3";
+    static constexpr bool accepts(CodecDetect::Type t) { return t == CodecDetect::Type::Mp3; }
+
+    /// Helix: до 1152 сэмплов × 2 канала на фрейм
+    static constexpr uint32_t kFramePcm     = MAX_NSAMP * MAX_NCHAN * MAX_NGRAN;
+    static constexpr size_t   kScratchBytes = kFramePcm * sizeof(s16);
+
+    explicit DecoderMp3(const DecoderEnv& env) : pcm_(env.scratch.as<s16>(kFramePcm)) {}
     ~DecoderMp3() override { close(); }
 
     bool     open(FsAdapter& fs) override;
@@ -31,19 +51,45 @@ private:
     uint32_t inBufLen_  = 0;
     uint32_t inBufPos_  = 0;
 
+    uint32_t dataStart_ = 0;   ///< звук — [dataStart_, dataEnd_) без тегов
+    uint32_t dataEnd_   = 0;
+    bool     synced_    = false;  ///< inBufPos_ — начало кадра; соседа не проверяем
+
+    /* Лимиты на один decode(): повреждённый файл не должен съесть тик */
+    static constexpr uint32_t kMaxSkipBytes = 16384;
+    static constexpr uint32_t kMaxBadFrames = 8;
+    uint32_t skipLeft_ = 0;
+    uint32_t badLeft_  = 0;
+
+    /* Результат findTag с прошлой итерации: индекс в inBuf_ первого тега
+     * за курсором или inBufLen_, если до конца буфера тегов нет. Годен,
+     * пока курсор не прошёл его и буфер не перечитан, — пропуск мусора
+     * по байту не пересканирует весь буфер. */
+    static constexpr uint32_t kTagUnknown = UINT32_MAX;
+    uint32_t tagAt_ = kTagUnknown;
+
     uint32_t sampleRate_  = 44100;
     uint32_t channels_    = 2;
     uint32_t duration_    = 0;
     uint64_t totalSamplesDecoded_ = 0;
 
-    /// Буфер остатка фрейма (макс. 1152 mono сэмплов для MPEG1 Layer3)
-    static constexpr uint32_t kMaxFrameMono = 1152;
-    s16 leftover_[kMaxFrameMono]{};
+    /// PCM фрейма в scratch; остаток — моно-сэмплы [leftoverPos_, leftoverLen_)
+    s16*     pcm_;
     uint32_t leftoverLen_ = 0;
     uint32_t leftoverPos_ = 0;
 
-    bool refillInput_();
-    int  findSyncAndDecode_(s16* pcm, MP3FrameInfo& info);
+    /// Дочитать вход (не дальше dataEnd_). @return байт дочитано
+    uint32_t refillInput_();
+    [[nodiscard]] bool atEnd_() const;
+    /// Пропустить bytes вперёд; дальше буфера — seek без чтения.
+    void skip_(uint32_t bytes);
+    /// Отбросить n байт мусора из буфера. false — лимит вызова исчерпан.
+    bool junk_(uint32_t n);
+
+    static constexpr int kNeedData = -1;  ///< дочитать вход
+    static constexpr int kBudget   = -2;  ///< лимит мусора/ошибок на вызов
+    /// @return сэмплов (все каналы) или kNeedData / kBudget
+    int  findSyncAndDecode_(MP3FrameInfo& info);
 };
 
 } // namespace ae2
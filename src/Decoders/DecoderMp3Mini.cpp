@@ -0,0 +1,201 @@
+/// @file DecoderMp3Mini.cpp
+/// @brief MP3-декодер на базе minimp3.
+#include "DecoderMp3Mini.hpp"
+#include "FsAdapter/FsAdapter.hpp"
+#include "Mp3Duration/Mp3Duration.hpp"
+#include <cstring>
+#include <algorithm>
+
+namespace ae2 {
+
+bool DecoderMp3Mini::open(FsAdapter& fs) {
+    close();
+    if (!pcm_) return false;
+    fs_ = &fs;
+
+    mp3dec_init(&dec_);
+    inBufLen_ = inBufPos_ = 0;
+    totalSamplesDecoded_ = 0;
+
+    /* Оценка длительности без полного прохода */
+    auto dur = Mp3Duration::estimate(fs, fs.size());
+    duration_   = dur.durationSec;
+    sampleRate_ = (dur.sampleRate > 0) ? dur.sampleRate : 44100;
+
+    /* Звук без тегов в начале и в конце; оставляет позицию на start */
+    auto range = Mp3Duration::audioRange(fs, fs.size());
+    dataStart_ = range.start;
+    dataEnd_   = range.end;
+
+    status_ = Status::Ready;
+    return true;
+}
+
+uint32_t DecoderMp3Mini::refillInput_() {
+    if (!fs_) return 0;
+    /* Сдвигаем остаток в начало буфера */
+    uint32_t remaining = inBufLen_ - inBufPos_;
+    if (remaining > 0 && inBufPos_ > 0)
+        std::memmove(inBuf_, inBuf_ + inBufPos_, remaining);
+    inBufLen_ = remaining;
+    inBufPos_ = 0;
+    /* Дочитываем, но не хвостовые теги */
+    uint32_t pos   = fs_->tell();
+    size_t   space = std::min<size_t>(kInBufSize - inBufLen_, pos < dataEnd_ ? dataEnd_ - pos : 0);
+    if (space == 0) return 0;
+    size_t rd = fs_->read(inBuf_ + inBufLen_, space);
+    if (rd == 0) dataEnd_ = pos;  /* файл короче, чем казалось */
+    inBufLen_ += (uint32_t)rd;
+    return (uint32_t)rd;
+}
+
+bool DecoderMp3Mini::skipTag_() {
+    uint32_t avail = inBufLen_ - inBufPos_;
+    const uint8_t* p = inBuf_ + inBufPos_;
+    uint32_t tag = 0;
+    bool isHeader = false;
+    if (avail >= 10) tag = Mp3Duration::id3v2Size(p);
+    if (!tag && avail >= 32) {
+        tag = Mp3Duration::apeTagSize(p, &isHeader);
+        if (tag && !isHeader) tag = 32;  /* footer: тело уже позади */
+    }
+    if (!tag) return false;
+    if (tag <= avail) {
+        inBufPos_ += tag;
+    } else {
+        /* Обложка на сотни КБ — перескок без чтения */
+        fs_->seek(std::min(fs_->tell() + (tag - avail), dataEnd_));
+        inBufLen_ = inBufPos_ = 0;
+    }
+    return true;
+}
+
+int DecoderMp3Mini::frameBytes_() const {
+    /* minimp3 принимает кадр, только если за ним следующий заголовок или
+     * кадр ровно до конца входа. Перед тегом склейки отдаём кадр точно по
+     * длине — иначе последний кадр трека уходит в мусор вместе с тегом */
+    const uint32_t avail = inBufLen_ - inBufPos_;
+    const uint8_t* p = inBuf_ + inBufPos_;
+    if (avail < 4) return (int)avail;
+    const auto hdr = Mp3Duration::parseHeader(p);
+    const uint32_t next = hdr.frameSize;
+    if (!hdr.valid || next + 10 > avail) return (int)avail;
+    const uint8_t* q = p + next;
+    if ((q[0] == 'I' && Mp3Duration::id3v2Size(q)) ||
+        (q[0] == 'A' && next + 32 <= avail && Mp3Duration::apeTagSize(q)))
+        return (int)next;
+    return (int)avail;
+}
+
+uint32_t DecoderMp3Mini::decode(s16* buf, uint32_t maxSamples) {
+    if (!fs_ || (status_ != Status::Ready && status_ != Status::Playing)) return 0;
+    status_   = Status::Playing;
+    skipping_ = false;
+
+    uint32_t totalOut = 0;
+    uint32_t skipLeft = kMaxSkipBytes;
+
+    /* ── Сначала отдаём остаток от предыдущего кадра ── */
+    if (leftoverLen_ > leftoverPos_) {
+        uint32_t avail = leftoverLen_ - leftoverPos_;
+        uint32_t n = std::min(avail, maxSamples);
+        std::memcpy(buf, pcm_ + leftoverPos_, n * sizeof(s16));
+        leftoverPos_ += n;
+        totalOut += n;
+        totalSamplesDecoded_ += n;
+        if (leftoverPos_ >= leftoverLen_)
+            leftoverLen_ = leftoverPos_ = 0;
+    }
+
+    while (totalOut < maxSamples) {
+        if (inBufLen_ - inBufPos_ < kInBufSize / 2) refillInput_();
+        if (inBufLen_ == inBufPos_) break;  /* конец звука */
+        if (skipTag_()) continue;
+
+        mp3dec_frame_info_t info{};
+        int samples = mp3dec_decode_frame(&dec_, inBuf_ + inBufPos_, frameBytes_(), pcm_, &info);
+        if (info.frame_bytes == 0) {
+            /* Кадр не весь в буфере — дочитать; нечего — обрезанный хвост */
+            if (refillInput_() == 0) break;
+            continue;
+        }
+        inBufPos_ += (uint32_t)info.frame_bytes;
+        if (samples == 0) {
+            /* Мусор до sync или кадр без выхода (bit reservoir после seek) */
+            if ((uint32_t)info.frame_bytes >= skipLeft) {
+                skipping_ = (totalOut == 0);
+                break;
+            }
+            skipLeft -= (uint32_t)info.frame_bytes;
+            continue;
+        }
+
+        /* Обновляем параметры из фактического кадра */
+        if (info.hz > 0) sampleRate_ = (uint32_t)info.hz;
+
+        uint32_t monoSamples = (uint32_t)samples;  /* minimp3 — на канал */
+        uint32_t space = maxSamples - totalOut;
+
+        if (monoSamples > space) {
+            /* Кадр не помещается целиком — даунмикс на месте в pcm_ (запись
+             * по i отстаёт от чтения по 2i), вывод сколько есть места */
+            if (info.channels == 2) {
+                for (uint32_t i = 0; i < monoSamples; ++i)
+                    pcm_[i] = (s16)(((int32_t)pcm_[i * 2] + pcm_[(i * 2) + 1]) / 2);
+            }
+            std::memcpy(buf + totalOut, pcm_, space * sizeof(s16));
+            totalOut += space;
+            totalSamplesDecoded_ += space;
+            leftoverPos_ = space;
+            leftoverLen_ = monoSamples;
+            break;
+        }
+
+        /* Весь кадр помещается */
+        if (info.channels == 2) {
+            for (uint32_t i = 0; i < monoSamples; ++i)
+                buf[totalOut + i] = (s16)(((int32_t)pcm_[i * 2] + pcm_[(i * 2) + 1]) / 2);
+        } else {
+            std::memcpy(buf + totalOut, pcm_, monoSamples * sizeof(s16));
+        }
+        totalOut += monoSamples;
+        totalSamplesDecoded_ += monoSamples;
+    }
+
+    if (totalOut == 0 && !skipping_) status_ = Status::Closed;
+    return totalOut;
+}
+
+void DecoderMp3Mini::seek(uint32_t sec) {
+    if (!fs_) return;
+    /* Грубый seek по среднему битрейту; minimp3 синхронизируется сам */
+    uint32_t audioSize = dataEnd_ - dataStart_;
+    if (duration_ > 0 && sec < duration_) {
+        uint32_t bytePos = dataStart_ + (uint32_t)((uint64_t)audioSize * sec / duration_);
+        fs_->seek(bytePos);
+    } else {
+        fs_->seek(duration_ > 0 ? dataEnd_ : dataStart_);
+    }
+    inBufLen_ = inBufPos_ = 0;
+    leftoverLen_ = leftoverPos_ = 0;
+    mp3dec_init(&dec_);
+    totalSamplesDecoded_ = (uint64_t)sec * sampleRate_;
+}
+
+uint32_t DecoderMp3Mini::position() const {
+    return (sampleRate_ > 0) ? (uint32_t)(totalSamplesDecoded_ / sampleRate_) : 0;
+}
+
+uint32_t DecoderMp3Mini::duration() const { return duration_; }
+
+void DecoderMp3Mini::close() {
+    fs_ = nullptr;
+    status_ = Status::Closed;
+    skipping_ = false;
+    inBufLen_ = inBufPos_ = 0;
+    leftoverLen_ = leftoverPos_ = 0;
+    dataStart_ = dataEnd_ = 0;
+    totalSamplesDecoded_ = 0;
+}
+
+} // namespace ae2
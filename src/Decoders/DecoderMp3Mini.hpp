@@ -0,0 +1,78 @@
+#pragma once
+/// @file DecoderMp3Mini.hpp
+/// @brief MP3-декодер на базе minimp3 (float, SSE2/NEON на хосте).
+///
+/// Альтернатива Helix (DecoderMp3), выбирается при сборке:
+/// -DAE2_MP3_MINIMP3=1 (см. AudioCodecs.hpp). На x86-64 и AArch64 minimp3
+/// берёт SIMD-путь, на Cortex-M без NEON — скалярный float; что быстрее на
+/// конкретной цели — показывает ae2_bench (кейсы mp3/helix и mp3/minimp3).
+///
+/// Состояние minimp3 (~6,5 КБ: overlap MDCT, QMF, bit reservoir) живёт в
+/// объекте; PCM кадра и входной буфер — в общем scratch, ровно 8 КБ. Рабочий
+/// буфер кадра (mp3dec_scratch_t, ~16 КБ) minimp3 кладёт на стек
+/// вызывающего таска — это kCodecsStackBytes, стек AudioMgr его включает.
+/// Синхронизацию с проверкой соседних заголовков minimp3 делает сам;
+/// теги по краям отрезаются Mp3Duration::audioRange, теги на границе кадра
+/// посреди потока пропускаются целиком. Мусор — не больше kMaxSkipBytes
+/// на decode(), дальше skipping().
+
+#include "DecoderBase.hpp"
+#include "minimp3.h"
+
+namespace ae2 {
+
+class DecoderMp3Mini final : public DecoderBase {
+public:
+    static constexpr const char* kName = "minimp3";
+    static constexpr bool accepts(CodecDetect::Type t) { return t == CodecDetect::Type::Mp3; }
+
+    /// До 1152 сэмплов × 2 канала на кадр
+    static constexpr uint32_t kFramePcm  = MINIMP3_MAX_SAMPLES_PER_FRAME;
+    /// Вход: кадр до 1441 байт (free format — до 2304) и заголовки соседей
+    static constexpr uint32_t kInBufSize = 3584;
+    static constexpr size_t   kScratchBytes = kFramePcm * sizeof(s16) + kInBufSize;
+
+    explicit DecoderMp3Mini(const DecoderEnv& env)
+        : pcm_(env.scratch.as<s16>(kScratchBytes / sizeof(s16))),
+          inBuf_(pcm_ ? reinterpret_cast<uint8_t*>(pcm_ + kFramePcm) : nullptr) {}
+    ~DecoderMp3Mini() override { close(); }
+
+    bool     open(FsAdapter& fs) override;
+    uint32_t decode(s16* buf, uint32_t maxSamples) override;
+    void     seek(uint32_t sec) override;
+	[[nodiscard]] uint32_t position() const override;
+	[[nodiscard]] uint32_t duration() const override;
+	[[nodiscard]] uint32_t sampleRate() const override { return sampleRate_; }
+	void     close() override;
+
+private:
+    FsAdapter* fs_ = nullptr;
+    mp3dec_t   dec_{};
+
+    /// PCM кадра и вход — в scratch; остаток — моно-сэмплы [leftoverPos_, leftoverLen_)
+    s16*     pcm_;
+    uint8_t* inBuf_;
+    uint32_t inBufLen_ = 0;
+    uint32_t inBufPos_ = 0;
+    uint32_t leftoverLen_ = 0;
+    uint32_t leftoverPos_ = 0;
+
+    uint32_t dataStart_ = 0;   ///< звук — [dataStart_, dataEnd_) без тегов
+    uint32_t dataEnd_   = 0;
+
+    /// Лимит мусора на один decode(): повреждённый файл не должен съесть тик
+    static constexpr uint32_t kMaxSkipBytes = 16384;
+
+    uint32_t sampleRate_ = 44100;
+    uint32_t duration_   = 0;
+    uint64_t totalSamplesDecoded_ = 0;
+
+    /// Дочитать вход (не дальше dataEnd_). @return байт дочитано
+    uint32_t refillInput_();
+    /// Тег ID3v2/APEv2 с начала буфера: пропустить. @return был тег
+    bool skipTag_();
+    /// Сколько входа отдать mp3dec_decode_frame.
+    [[nodiscard]] int frameBytes_() const;
+};
+
+} // namespace ae2
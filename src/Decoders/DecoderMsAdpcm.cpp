@@ -0,0 +1,270 @@
+/// @file DecoderMsAdpcm.cpp — Microsoft ADPCM
+#include "DecoderMsAdpcm.hpp"
+#include "FsAdapter/FsAdapter.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__ARM_FEATURE_SAT)
+#  include <arm_acle.h>
+#endif
+
+namespace ae2 {
+
+static const int16_t kAdaptTable[16] = {
+    230,230,230,230,307,409,512,614,
+    768,614,512,409,307,230,230,230
+};
+
+/* Стандартные коэффициенты — если fmt их не содержит */
+static const int16_t kDefaultCoefs[7][2] = {
+    {256,0},{512,-256},{0,0},{192,64},{240,0},{460,-208},{392,-232}
+};
+
+static uint16_t r16(const uint8_t* p) { return (uint16_t)(p[0]|(p[1]<<8)); }
+static uint32_t r32(const uint8_t* p) {
+    return p[0]|((uint32_t)p[1]<<8)|((uint32_t)p[2]<<16)|((uint32_t)p[3]<<24);
+}
+
+/* Верхняя граница delta (как в ffmpeg): kAdaptTable[nib] * delta ≤ 768 * delta
+ * и snib * delta не выходят за int32 на любом, в том числе битом, потоке. */
+static constexpr int32_t kMaxDelta = INT32_MAX / 768;
+
+static inline int32_t sat16(int32_t v) {
+#if defined(__ARM_FEATURE_SAT)
+    return __ssat(v, 16);
+#else
+    return std::min(std::max(v, -32768), 32767);
+#endif
+}
+
+/* Шаг MS-ADPCM: одно умножение-сложение на предсказание,
+ * без ветвлений кроме границ delta (min/max). */
+static inline int32_t msStep(uint32_t nib, int32_t c1, int32_t c2,
+                             int32_t& s1, int32_t& s2, int32_t& delta) {
+    const int32_t snib = (int32_t)(nib ^ 8) - 8;  /* 4-битное знаковое */
+    const int32_t pred = ((s1 * c1) + (s2 * c2)) >> 8;
+    const int32_t s = sat16(pred + (snib * delta));
+    s2 = s1;
+    s1 = s;
+    delta = std::min(std::max((kAdaptTable[nib] * delta) >> 8, 16), kMaxDelta);
+    return s;
+}
+
+bool DecoderMsAdpcm::open(FsAdapter& fs) {
+    close();
+    fs_ = &fs;
+    fs.seek(0);
+    uint8_t hdr[12];
+    if (fs.read(hdr,12)<12) return false;
+    if (std::memcmp(hdr,"RIFF",4)||std::memcmp(hdr+8,"WAVE",4)) return false;
+
+    uint32_t pos = 12;
+    bool gotFmt = false;
+    bool gotData = false;
+    while (pos+8 < fs.size()) {
+        fs.seek(pos);
+        uint8_t ch[8]; if (fs.read(ch,8)<8) break;
+        uint32_t sz = r32(ch+4);
+        if (!std::memcmp(ch,"fmt ",4) && sz >= 16) {
+            uint8_t f[22] = {};
+            if (fs.read(f, std::min(sz,(uint32_t)22)) < 16) break;
+            if (r16(f) != 0x0002) return false; /* MS ADPCM */
+            channels_   = r16(f+2);
+            sampleRate_ = r32(f+4);
+            blockAlign_ = r16(f+12);
+            if (sz >= 20) samplesPerBlock_ = r16(f+18);
+            uint16_t nc = (sz >= 22) ? r16(f+20) : 0;
+            /* Таблица коэффициентов идёт сразу за numCoef */
+            for (uint16_t i = 0; i < nc && numCoefs_ < kMaxCoefs && 22u + (i * 4u) + 4u <= sz; ++i) {
+                uint8_t c[4]; if (fs.read(c,4)<4) break;
+                coefs_[numCoefs_][0] = (int16_t)r16(c);
+                coefs_[numCoefs_][1] = (int16_t)r16(c+2);
+                numCoefs_++;
+            }
+            gotFmt = true;
+        } else if (!std::memcmp(ch,"data",4)) {
+            dataOffset_ = pos+8; dataSize_ = sz; gotData = true;
+        }
+        pos += 8+sz; if (sz&1) pos++;
+        if (gotFmt && gotData) break;
+    }
+    if (!gotFmt || !gotData || channels_ == 0 || channels_ > 2) return false;
+    if (blockAlign_ < 7u * channels_) return false;
+    if (numCoefs_ == 0) {
+        std::memcpy(coefs_, kDefaultCoefs, sizeof(kDefaultCoefs));
+        numCoefs_ = 7;
+    }
+    if (samplesPerBlock_ == 0)
+        samplesPerBlock_ = (uint16_t)(((blockAlign_ - (7 * channels_)) * 2 / channels_) + 2);
+    totalBlocks_ = dataSize_ / blockAlign_;
+    blocksRead_ = 0;
+    blockBytesLeft_ = 0;
+    carryLen_ = carryPos_ = 0;
+    fs.seek(dataOffset_);
+    status_ = Status::Ready;
+    return true;
+}
+
+uint32_t DecoderMsAdpcm::decode(s16* buf, uint32_t maxSamples) {
+    if (!fs_ || (status_ != Status::Ready && status_ != Status::Playing)) return 0;
+    status_ = Status::Playing;
+
+    uint32_t out = 0;
+
+    /* ── Сначала перенос с прошлого вызова ── */
+    while (carryPos_ < carryLen_ && out < maxSamples)
+        buf[out++] = carry_[carryPos_++];
+
+    while (out < maxSamples) {
+        if (blockBytesLeft_ == 0) {
+            if (!startBlock_(buf, maxSamples, out)) break;
+            continue;
+        }
+        uint32_t n = (channels_ == 1) ? decodeMono_(buf + out, maxSamples - out)
+                                      : decodeStereo_(buf + out, maxSamples - out);
+        out += n;
+        if (carryPos_ < carryLen_) break;  /* буфер заполнен */
+        if (n == 0 && blockBytesLeft_ != 0) break;
+    }
+
+    if (out == 0) status_ = Status::Closed;
+    return out;
+}
+
+bool DecoderMsAdpcm::startBlock_(s16* dst, uint32_t room, uint32_t& out) {
+    if (blocksRead_ >= totalBlocks_) return false;
+    carryLen_ = carryPos_ = 0;
+    /* Заголовок: predictor[ch], delta[ch], sample1[ch], sample2[ch] */
+    uint8_t hdr[14];
+    const uint32_t hdrLen = 7u * channels_;
+    if (fs_->read(hdr, hdrLen) < hdrLen) return false;
+    blocksRead_++;
+
+    const uint8_t* p = hdr + channels_;
+    for (uint16_t c = 0; c < channels_; ++c) {
+        const uint32_t ci = std::min<uint32_t>(hdr[c], numCoefs_ - 1u);
+        ChState& st = states_[c];
+        st.c1    = coefs_[ci][0];
+        st.c2    = coefs_[ci][1];
+        /* delta в заголовке — int16; отрицательная бывает только в битом
+         * блоке и дала бы переполнение в msStep: поднимаем до минимума */
+        st.delta = std::max<int32_t>((int16_t)r16(p + (c * 2)), 16);
+        st.s1    = (int16_t)r16(p + (2 * channels_) + (c * 2));
+        st.s2    = (int16_t)r16(p + (4 * channels_) + (c * 2));
+    }
+    blockBytesLeft_ = blockAlign_ - hdrLen;
+
+    /* Первые два сэмпла блока — sample2, затем sample1 */
+    s16 first[2];
+    if (channels_ == 1) {
+        first[0] = (s16)states_[0].s2;
+        first[1] = (s16)states_[0].s1;
+    } else {
+        first[0] = (s16)((states_[0].s2 + states_[1].s2) / 2);
+        first[1] = (s16)((states_[0].s1 + states_[1].s1) / 2);
+    }
+    for (uint32_t i = 0; i < 2; ++i) {
+        if (out < room) dst[out++] = first[i];
+        else            carry_[carryLen_++] = first[i];
+    }
+    if (carryLen_ > 0) carryPos_ = 0;
+    return true;
+}
+
+uint32_t DecoderMsAdpcm::decodeMono_(s16* dst, uint32_t room) {
+    ChState st = states_[0];
+    uint32_t out = 0;
+
+    while (out < room && blockBytesLeft_ > 0) {
+        const uint8_t* p = nullptr;
+        size_t span = fs_->peek(p);
+        if (span == 0) { blockBytesLeft_ = 0; break; }  /* обрезанный файл */
+
+        uint32_t bytes = (uint32_t)std::min<size_t>(span, blockBytesLeft_);
+        bytes = std::min(bytes, (room - out) / 2);
+        if (bytes == 0) {
+            /* Одно место: второй nibble — в перенос */
+            const uint32_t b = p[0];
+            dst[out++] = (s16)msStep(b >> 4,   st.c1, st.c2, st.s1, st.s2, st.delta);
+            carry_[0]  = (s16)msStep(b & 0x0F, st.c1, st.c2, st.s1, st.s2, st.delta);
+            carryPos_ = 0;
+            carryLen_ = 1;
+            fs_->consume(1);
+            blockBytesLeft_--;
+            break;
+        }
+
+        /* Старший nibble — первый сэмпл */
+        s16* o = dst + out;
+        for (uint32_t i = 0; i < bytes; ++i) {
+            const uint32_t b = p[i];
+            o[i * 2]       = (s16)msStep(b >> 4,   st.c1, st.c2, st.s1, st.s2, st.delta);
+            o[(i * 2) + 1] = (s16)msStep(b & 0x0F, st.c1, st.c2, st.s1, st.s2, st.delta);
+        }
+        out += bytes * 2;
+        fs_->consume(bytes);
+        blockBytesLeft_ -= bytes;
+    }
+
+    states_[0] = st;
+    return out;
+}
+
+uint32_t DecoderMsAdpcm::decodeStereo_(s16* dst, uint32_t room) {
+    /* Байт = кадр: старший nibble — L, младший — R; две независимые цепочки */
+    ChState l = states_[0];
+    ChState r = states_[1];
+    uint32_t out = 0;
+
+    while (out < room && blockBytesLeft_ > 0) {
+        const uint8_t* p = nullptr;
+        size_t span = fs_->peek(p);
+        if (span == 0) { blockBytesLeft_ = 0; break; }
+
+        uint32_t bytes = (uint32_t)std::min<size_t>(span, blockBytesLeft_);
+        bytes = std::min(bytes, room - out);
+        for (uint32_t i = 0; i < bytes; ++i) {
+            const uint32_t b = p[i];
+            int32_t sl = msStep(b >> 4,   l.c1, l.c2, l.s1, l.s2, l.delta);
+            int32_t sr = msStep(b & 0x0F, r.c1, r.c2, r.s1, r.s2, r.delta);
+            dst[out + i] = (s16)((sl + sr) / 2);
+        }
+        out += bytes;
+        fs_->consume(bytes);
+        blockBytesLeft_ -= bytes;
+    }
+
+    states_[0] = l;
+    states_[1] = r;
+    return out;
+}
+
+void DecoderMsAdpcm::seek(uint32_t sec) {
+    if (!fs_ || blockAlign_ == 0 || samplesPerBlock_ == 0) return;
+    uint32_t targetSample = sec * sampleRate_;
+    uint32_t targetBlock = targetSample / samplesPerBlock_;
+    if (targetBlock >= totalBlocks_) targetBlock = totalBlocks_ > 0 ? totalBlocks_ - 1 : 0;
+    blocksRead_ = targetBlock;
+    blockBytesLeft_ = 0;                /* блок начнётся заново */
+    carryLen_ = carryPos_ = 0;
+	fs_->seek(dataOffset_ + (targetBlock * blockAlign_));
+}
+
+uint32_t DecoderMsAdpcm::position() const {
+    if (sampleRate_ == 0 || samplesPerBlock_ == 0) return 0;
+    return (blocksRead_ * samplesPerBlock_) / sampleRate_;
+}
+
+uint32_t DecoderMsAdpcm::duration() const {
+    if (sampleRate_ == 0 || samplesPerBlock_ == 0) return 0;
+    return (totalBlocks_ * samplesPerBlock_) / sampleRate_;
+}
+
+void DecoderMsAdpcm::close() {
+    fs_ = nullptr; status_ = Status::Closed; blocksRead_ = 0;
+    numCoefs_ = 0;
+    blockBytesLeft_ = 0;
+    carryLen_ = carryPos_ = 0;
+}
+
+} // namespace ae2
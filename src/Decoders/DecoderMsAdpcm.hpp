@@ -0,0 +1,54 @@
+#pragma once
+/// @file DecoderMsAdpcm.hpp
+/// @brief Microsoft ADPCM (WAV format 0x0002), потоковый разбор блоков.
+
+#include "DecoderBase.hpp"
+
+namespace ae2 {
+
+class DecoderMsAdpcm final : public DecoderBase {
+public:
+    static constexpr const char* kName = "ms-adpcm";
+    static constexpr bool accepts(CodecDetect::Type t) { return t == CodecDetect::Type::WavMsAdpcm; }
+
+    bool     open(FsAdapter& fs) override;
+    uint32_t decode(s16* buf, uint32_t maxSamples) override;
+    void     seek(uint32_t sec) override;
+	[[nodiscard]] uint32_t position() const override;
+	[[nodiscard]] uint32_t duration() const override;
+	[[nodiscard]] uint32_t sampleRate() const override { return sampleRate_; }
+	void     close() override;
+
+private:
+    FsAdapter* fs_ = nullptr;
+    uint16_t channels_        = 1;
+    uint32_t sampleRate_      = 22050;
+    uint16_t blockAlign_      = 256;
+    uint16_t samplesPerBlock_ = 0;
+    uint32_t dataOffset_      = 0;
+    uint32_t dataSize_        = 0;
+    uint32_t blocksRead_      = 0;
+    uint32_t totalBlocks_     = 0;
+
+    /// Коэффициенты предсказателя из fmt (стандартный набор — 7 пар).
+    static constexpr uint32_t kMaxCoefs = 32;
+    int16_t  coefs_[kMaxCoefs][2]{};
+    uint16_t numCoefs_ = 0;
+
+    /* Потоковое состояние, как в DecoderAdpcm: блок читается прямо
+     * из буфера FsAdapter, копии блока нет. */
+    struct ChState { int32_t c1, c2, delta, s1, s2; };
+    ChState  states_[2]{};
+    uint32_t blockBytesLeft_ = 0;  ///< байт nibble-данных до конца текущего блока
+
+    /// Сэмплы, не поместившиеся в выходной буфер (≤ 2).
+    s16 carry_[2]{};
+    uint8_t carryLen_ = 0;
+    uint8_t carryPos_ = 0;
+
+    bool     startBlock_(s16* dst, uint32_t room, uint32_t& out);
+    uint32_t decodeMono_(s16* dst, uint32_t room);
+    uint32_t decodeStereo_(s16* dst, uint32_t room);
+};
+
+} // namespace ae2
@@ -0,0 +1,42 @@
+/// @file DecoderRamPcm.cpp
+#include "DecoderRamPcm.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace ae2 {
+
+bool DecoderRamPcm::open(FsAdapter& /*fs*/) {
+    if (!pcm_ || samples_ == 0 || rate_ == 0) return false;
+    pos_ = 0;
+    status_ = Status::Ready;
+    return true;
+}
+
+uint32_t DecoderRamPcm::decode(s16* buf, uint32_t maxSamples) {
+    if (status_ != Status::Ready && status_ != Status::Playing) return 0;
+    const uint32_t n = std::min(maxSamples, samples_ - pos_);
+    if (n == 0) {
+        status_ = Status::Closed;
+        return 0;
+    }
+    status_ = Status::Playing;
+    std::memcpy(buf, pcm_ + pos_, n * sizeof(s16));
+    pos_ += n;
+    return n;
+}
+
+void DecoderRamPcm::seek(uint32_t sec) {
+    pos_ = (uint32_t)std::min<uint64_t>((uint64_t)sec * rate_, samples_);
+}
+
+uint32_t DecoderRamPcm::duration() const {
+    /* Вверх: подсказка на полсекунды — не «0 с» */
+    return rate_ ? (samples_ + rate_ - 1) / rate_ : 0;
+}
+
+void DecoderRamPcm::close() {
+    status_ = Status::Closed;
+    pos_ = 0;
+}
+
+} // namespace ae2
@@ -0,0 +1,37 @@
+#pragma once
+/// @file DecoderRamPcm.hpp
+/// @brief «Декодер» готового моно PCM в памяти — попадание PcmCache.
+///
+/// Файл не открывается: open() ничего не читает, decode() — memcpy из
+/// записи кэша. Запись живёт, пока декодер открыт (PcmCache вытесняет
+/// только при старте следующего трека).
+
+#include "DecoderBase.hpp"
+
+namespace ae2 {
+
+class DecoderRamPcm final : public DecoderBase {
+public:
+    static constexpr const char* kName = "ram-pcm";
+    static constexpr bool accepts(CodecDetect::Type t) { return t == CodecDetect::Type::RamPcm; }
+
+    explicit DecoderRamPcm(const DecoderEnv& env)
+        : pcm_(env.pcm), samples_(env.pcm ? env.pcmSamples : 0), rate_(env.pcmRate) {}
+    ~DecoderRamPcm() override { close(); }
+
+    bool     open(FsAdapter& fs) override;
+    uint32_t decode(s16* buf, uint32_t maxSamples) override;
+    void     seek(uint32_t sec) override;
+	[[nodiscard]] uint32_t position() const override { return rate_ ? pos_ / rate_ : 0; }
+	[[nodiscard]] uint32_t duration() const override;
+	[[nodiscard]] uint32_t sampleRate() const override { return rate_; }
+	void     close() override;
+
+private:
+    const s16* pcm_;
+    uint32_t   samples_;
+    uint32_t   rate_;
+    uint32_t   pos_ = 0;
+};
+
+} // namespace ae2
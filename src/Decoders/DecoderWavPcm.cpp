@@ -2,8 +2,17 @@
 #include "DecoderWavPcm.hpp"
 #include "FsAdapter/FsAdapter.hpp"
 #include <algorithm>
+#include <array>
 #include <cstring>
-#include <algorithm>
+#include <utility>
+
+#if defined(__ARM_FEATURE_SIMD32)
+#  include <arm_acle.h>
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#  include <arm_neon.h>
+#endif
 
 namespace ae2 {
 
@@ -12,6 +21,190 @@ static uint32_t r32(const uint8_t* p) {
     return (uint32_t)p[0] | ((uint32_t)p[1]<<8) | ((uint32_t)p[2]<<16) | ((uint32_t)p[3]<<24);
 }
 
+/* ── Отсчёты: целые приводятся к шкале 16 бит, float — как есть ── */
+
+using SampleFmt = DecoderWavPcm::SampleFmt;
+
+template<SampleFmt F> struct PcmSample;
+
+template<> struct PcmSample<SampleFmt::U8> {
+    static constexpr uint32_t kBytes = 1;
+    static int32_t load(const uint8_t* p) { return ((int32_t)p[0] - 128) * 256; }
+};
+template<> struct PcmSample<SampleFmt::S16> {
+    static constexpr uint32_t kBytes = 2;
+    static int32_t load(const uint8_t* p) { return (int16_t)r16(p); }
+};
+template<> struct PcmSample<SampleFmt::S24> {
+    static constexpr uint32_t kBytes = 3;
+    static int32_t load(const uint8_t* p) {
+        return (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) >> 16;
+    }
+};
+template<> struct PcmSample<SampleFmt::S32> {
+    static constexpr uint32_t kBytes = 4;
+    static int32_t load(const uint8_t* p) { return (int32_t)r32(p) >> 16; }
+};
+template<> struct PcmSample<SampleFmt::F32> {
+    static constexpr uint32_t kBytes = 4;
+    static float load(const uint8_t* p) { float f; std::memcpy(&f, p, sizeof(f)); return f; }
+};
+
+/// Среднее каналов с масштабом 32768 (Ch учтён в множителе), усечение к нулю.
+static inline s16 floatToS16(float v) {
+    v = (v > -32768.0f) ? v : -32768.0f;  /* NaN → -32768, как _mm_max_ps */
+    v = (v < 32767.0f)  ? v : 32767.0f;
+    return (s16)(int32_t)v;
+}
+
+/* ── SIMD-ядра: возвращают число обработанных кадров, хвост — скаляром ── */
+
+template<SampleFmt F, uint32_t Ch>
+static uint32_t convertSimd(const uint8_t*, s16*, uint32_t) { return 0; }
+
+#if defined(__ARM_FEATURE_SIMD32)
+/* Cortex-M4: SMUAD складывает обе половины слова L|R за такт */
+template<>
+uint32_t convertSimd<SampleFmt::S16, 2>(const uint8_t* raw, s16* dst, uint32_t frames) {
+    for (uint32_t i = 0; i < frames; ++i) {
+        uint32_t w;
+        std::memcpy(&w, raw + (i * 4), sizeof(w));
+        dst[i] = (s16)(__smuad((int16x2_t)w, (int16x2_t)0x00010001) / 2);
+    }
+    return frames;
+}
+#elif defined(__SSE2__)
+/* (a + b) / 2 с усечением к нулю, как в скалярном пути */
+static inline __m128i halfTrunc(__m128i s) {
+    return _mm_srai_epi32(_mm_add_epi32(s, _mm_srli_epi32(s, 31)), 1);
+}
+
+template<>
+uint32_t convertSimd<SampleFmt::S16, 2>(const uint8_t* raw, s16* dst, uint32_t frames) {
+    const __m128i ones = _mm_set1_epi16(1);
+    uint32_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + (i * 4)));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + (i * 4) + 16));
+        /* madd с единицами: L + R каждой пары в int32 */
+        const __m128i lo = halfTrunc(_mm_madd_epi16(a, ones));
+        const __m128i hi = halfTrunc(_mm_madd_epi16(b, ones));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(lo, hi));
+    }
+    return i;
+}
+
+static inline __m128i floatToS16x4(__m128 v) {
+    v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f));
+    return _mm_cvttps_epi32(v);
+}
+
+template<>
+uint32_t convertSimd<SampleFmt::F32, 1>(const uint8_t* raw, s16* dst, uint32_t frames) {
+    const __m128 k = _mm_set1_ps(32768.0f);
+    uint32_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        const float* f = reinterpret_cast<const float*>(raw) + i;
+        const __m128i lo = floatToS16x4(_mm_mul_ps(_mm_loadu_ps(f), k));
+        const __m128i hi = floatToS16x4(_mm_mul_ps(_mm_loadu_ps(f + 4), k));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(lo, hi));
+    }
+    return i;
+}
+
+template<>
+uint32_t convertSimd<SampleFmt::F32, 2>(const uint8_t* raw, s16* dst, uint32_t frames) {
+    const __m128 k = _mm_set1_ps(32768.0f / 2);
+    uint32_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        const float* f = reinterpret_cast<const float*>(raw) + (i * 2);
+        __m128i out[2];
+        for (int h = 0; h < 2; ++h) {
+            const __m128 a = _mm_loadu_ps(f + (h * 8));
+            const __m128 b = _mm_loadu_ps(f + (h * 8) + 4);
+            const __m128 l = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 r = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            out[h] = floatToS16x4(_mm_mul_ps(_mm_add_ps(l, r), k));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(out[0], out[1]));
+    }
+    return i;
+}
+#elif defined(__ARM_NEON)
+template<>
+uint32_t convertSimd<SampleFmt::S16, 2>(const uint8_t* raw, s16* dst, uint32_t frames) {
+    uint32_t i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        int16_t lr[16];
+        std::memcpy(lr, raw + (i * 4), sizeof(lr));
+        const int16x8x2_t v = vld2q_s16(lr);
+        int32x4_t lo = vaddl_s16(vget_low_s16(v.val[0]),  vget_low_s16(v.val[1]));
+        int32x4_t hi = vaddl_s16(vget_high_s16(v.val[0]), vget_high_s16(v.val[1]));
+        /* усечение к нулю: +1 для отрицательных перед сдвигом */
+        lo = vaddq_s32(lo, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(lo), 31)));
+        hi = vaddq_s32(hi, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(hi), 31)));
+        vst1q_s16(dst + i, vcombine_s16(vshrn_n_s32(lo, 1), vshrn_n_s32(hi, 1)));
+    }
+    return i;
+}
+
+template<>
+uint32_t convertSimd<SampleFmt::F32, 2>(const uint8_t* raw, s16* dst, uint32_t frames) {
+    const float32x4_t lim = vdupq_n_f32(32767.0f);
+    const float32x4_t neg = vdupq_n_f32(-32768.0f);
+    uint32_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        float lr[8];
+        std::memcpy(lr, raw + (i * 8), sizeof(lr));
+        const float32x4x2_t v = vld2q_f32(lr);
+        float32x4_t m = vmulq_n_f32(vaddq_f32(v.val[0], v.val[1]), 32768.0f / 2);
+        m = vminq_f32(vmaxq_f32(m, neg), lim);
+        vst1_s16(dst + i, vmovn_s32(vcvtq_s32_f32(m)));
+    }
+    return i;
+}
+#endif
+
+/* ── Общее ядро: число каналов известно при компиляции,
+ *    деление на Ch сводится к умножению/сдвигу ── */
+
+template<SampleFmt F, uint32_t Ch>
+static void convertFrames(const uint8_t* raw, s16* dst, uint32_t frames) {
+    using S = PcmSample<F>;
+    constexpr uint32_t kFrame = S::kBytes * Ch;
+    uint32_t i = convertSimd<F, Ch>(raw, dst, frames);
+    for (; i < frames; ++i) {
+        const uint8_t* f = raw + (i * kFrame);
+        if constexpr (F == SampleFmt::F32) {
+            float sum = 0.0f;
+            for (uint32_t c = 0; c < Ch; ++c) sum += S::load(f + (c * S::kBytes));
+            dst[i] = floatToS16(sum * (32768.0f / Ch));
+        } else {
+            int32_t sum = 0;
+            for (uint32_t c = 0; c < Ch; ++c) sum += S::load(f + (c * S::kBytes));
+            dst[i] = (s16)(sum / (int32_t)Ch);
+        }
+    }
+}
+
+using ConvertFn = void (*)(const uint8_t*, s16*, uint32_t);
+
+template<SampleFmt F, size_t... I>
+static constexpr std::array<ConvertFn, sizeof...(I)> convertRow(std::index_sequence<I...>) {
+    return {{ &convertFrames<F, (uint32_t)I + 1>... }};
+}
+
+template<SampleFmt F>
+static constexpr auto kRow = convertRow<F>(std::make_index_sequence<DecoderWavPcm::kMaxChannels>{});
+
+/// [формат][каналы - 1]
+static const std::array<ConvertFn, DecoderWavPcm::kMaxChannels>* const kConverters[] = {
+    &kRow<SampleFmt::U8>, &kRow<SampleFmt::S16>, &kRow<SampleFmt::S24>,
+    &kRow<SampleFmt::S32>, &kRow<SampleFmt::F32>,
+};
+
+/* ── DecoderWavPcm ── */
+
 bool DecoderWavPcm::open(FsAdapter& fs) {
     close();
     fs_ = &fs;
@@ -32,14 +225,31 @@ bool DecoderWavPcm::open(FsAdapter& fs) {
         uint32_t chSize = r32(ch + 4);
 
         if (std::memcmp(ch, "fmt ", 4) == 0 && chSize >= 16) {
-            uint8_t fmt[16];
-            if (fs.read(fmt, 16) < 16) break;
+            uint8_t fmt[26] = {};
+            if (fs.read(fmt, std::min<uint32_t>(chSize, sizeof(fmt))) < 16) break;
             uint16_t audioFmt = r16(fmt);
             channels_ = r16(fmt + 2);
             sampleRate_ = r32(fmt + 4);
             bitsPerSample_ = r16(fmt + 14);
-            if (audioFmt != 1) return false;  /* only PCM */
-            if (channels_ == 0 || bitsPerSample_ == 0) return false;
+            /* WAVE_FORMAT_EXTENSIBLE: реальный код — первые 2 байта SubFormat GUID */
+            if (audioFmt == 0xFFFE) {
+                if (chSize < 26) return false;
+                audioFmt = r16(fmt + 24);
+            }
+            if (channels_ == 0 || channels_ > kMaxChannels) return false;
+            if (audioFmt == 1) {
+                switch (bitsPerSample_) {
+                    case 8:  fmt_ = SampleFmt::U8;  break;
+                    case 16: fmt_ = SampleFmt::S16; break;
+                    case 24: fmt_ = SampleFmt::S24; break;
+                    case 32: fmt_ = SampleFmt::S32; break;
+                    default: return false;
+                }
+            } else if (audioFmt == 3 && bitsPerSample_ == 32) {
+                fmt_ = SampleFmt::F32;  /* IEEE float */
+            } else {
+                return false;
+            }
             fmtFound = true;
         } else if (std::memcmp(ch, "data", 4) == 0) {
             dataOffset_ = pos + 8;
@@ -53,6 +263,7 @@ bool DecoderWavPcm::open(FsAdapter& fs) {
     }
 
     if (!fmtFound || !dataFound) return false;
+    convert_ = (*kConverters[(int)fmt_])[channels_ - 1];
     bytesRead_ = 0;
     fs.seek(dataOffset_);
     status_ = Status::Ready;
@@ -62,10 +273,9 @@ bool DecoderWavPcm::open(FsAdapter& fs) {
 uint32_t DecoderWavPcm::decode(s16* buf, uint32_t maxSamples) {
     if (status_ != Status::Ready && status_ != Status::Playing) return 0;
     status_ = Status::Playing;
-    if (!fs_) return 0;
+    if (!fs_ || !convert_) return 0;
 
     uint32_t bpf = bytesPerFrame_();
-    if (bpf == 0) return 0;
     uint32_t framesToRead = maxSamples;
     uint32_t bytesLeft = (dataSize_ > bytesRead_) ? (dataSize_ - bytesRead_) : 0;
     uint32_t framesLeft = bytesLeft / bpf;
@@ -73,7 +283,7 @@ uint32_t DecoderWavPcm::decode(s16* buf, uint32_t maxSamples) {
 	if (framesToRead == 0) { status_ = Status::Closed; return 0; }
 
     /* ── Быстрый путь: 16-bit mono — читаем напрямую в выходной буфер ── */
-    if (bitsPerSample_ == 16 && channels_ == 1) {
+    if (fmt_ == SampleFmt::S16 && channels_ == 1) {
         uint32_t rawBytes = framesToRead * 2;
         size_t read = fs_->read(reinterpret_cast<uint8_t*>(buf), rawBytes);
         if (read == 0) { status_ = Status::Closed; return 0; }
@@ -82,71 +292,29 @@ uint32_t DecoderWavPcm::decode(s16* buf, uint32_t maxSamples) {
         return actualFrames;
     }
 
-    /* Читаем сырые данные */
-    uint32_t rawBytes = framesToRead * bpf;
-    /* Используем стек для небольших чанков, иначе временный буфер */
-    uint8_t tmpStack[4096];
-    uint8_t* raw = tmpStack;
-    bool allocated = false;
-    if (rawBytes > sizeof(tmpStack)) {
-        raw = new uint8_t[rawBytes];
-        allocated = true;
-    }
-
-    size_t read = fs_->read(raw, rawBytes);
-    if (read == 0) {
-        if (allocated) delete[] raw;
-        status_ = Status::Closed;
-        return 0;
-    }
-    uint32_t actualFrames = (uint32_t)(read / bpf);
-    bytesRead_ += (uint32_t)(actualFrames * bpf);
-
-    /* ── Быстрый путь: 16-bit stereo → mono даунмикс ── */
-    if (bitsPerSample_ == 16 && channels_ == 2) {
-        const s16* samples = reinterpret_cast<const s16*>(raw);
-        for (uint32_t i = 0; i < actualFrames; ++i) {
-			buf[i] = (s16)(((int32_t)samples[i * 2] + (int32_t)samples[(i * 2) + 1]) / 2);
-		}
-        if (allocated) delete[] raw;
-        return actualFrames;
-    }
-
-    /* ── Общий путь: любая комбинация bps/channels ── */
-    for (uint32_t i = 0; i < actualFrames; ++i) {
-		const uint8_t *frame = raw + (i * bpf);
-		int32_t monoSum = 0;
-        for (uint16_t ch = 0; ch < channels_; ++ch) {
-			const uint8_t *sample = frame + (ch * (bitsPerSample_ / 8));
-			int32_t val = 0;
-            switch (bitsPerSample_) {
-                case 8:
-                    val = ((int32_t)sample[0] - 128) << 8;
-                    break;
-                case 16:
-                    val = (int16_t)(sample[0] | (sample[1] << 8));
-                    break;
-                case 24:
-                    val = (int32_t)((uint32_t)sample[0] | ((uint32_t)sample[1] << 8) |
-                          ((uint32_t)sample[2] << 16));
-                    if (val & 0x800000) val |= (int32_t)0xFF000000u;
-                    val >>= 8;
-                    break;
-                case 32:
-                    val = (int32_t)(sample[0] | ((uint32_t)sample[1]<<8) |
-                          ((uint32_t)sample[2]<<16) | ((uint32_t)sample[3]<<24));
-                    val >>= 16;
-                    break;
-                default:
-                    break;
-            }
-            monoSum += val;
+    /* ── Остальное: конвертируем прямо из буфера FsAdapter, порциями ── */
+    uint32_t out = 0;
+    while (out < framesToRead) {
+        const uint8_t* raw = nullptr;
+        size_t span = fs_->peek(raw);
+        if (span == 0) break;
+        uint32_t frames = std::min((uint32_t)(span / bpf), framesToRead - out);
+        if (frames == 0) {
+            /* Кадр разрезан границей буфера — собираем его отдельно */
+            uint8_t edge[kMaxChannels * 4];
+            if (fs_->read(edge, bpf) < bpf) break;
+            convert_(edge, buf + out, 1);
+            out++;
+            continue;
         }
-        buf[i] = (s16)(monoSum / channels_);
+        convert_(raw, buf + out, frames);
+        fs_->consume(frames * bpf);
+        out += frames;
     }
 
-    if (allocated) delete[] raw;
-    return actualFrames;
+    bytesRead_ += out * bpf;
+    if (out == 0) status_ = Status::Closed;
+    return out;
 }
 
 void DecoderWavPcm::seek(uint32_t sec) {
@@ -175,6 +343,7 @@ uint32_t DecoderWavPcm::duration() const {
 
 void DecoderWavPcm::close() {
     fs_ = nullptr;
+    convert_ = nullptr;
     status_ = Status::Closed;
     bytesRead_ = 0;
 }
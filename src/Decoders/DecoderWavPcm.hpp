@@ -5,6 +5,9 @@ namespace ae2 {
 
 class DecoderWavPcm final : public DecoderBase {
 public:
+    static constexpr const char* kName = "wav-pcm";
+    static constexpr bool accepts(CodecDetect::Type t) { return t == CodecDetect::Type::WavPcm; }
+
     bool     open(FsAdapter& fs) override;
     uint32_t decode(s16* buf, uint32_t maxSamples) override;
     void     seek(uint32_t sec) override;
@@ -13,8 +16,17 @@ public:
 	[[nodiscard]] uint32_t sampleRate() const override { return sampleRate_; }
 	void     close() override;
 
+    /// Формат отсчёта в data-чанке.
+    enum class SampleFmt : uint8_t { U8, S16, S24, S32, F32 };
+    static constexpr uint16_t kMaxChannels = 8;
+
 private:
+    /// Конвертер кадров → моно s16; по инстансу на (формат, число каналов).
+    using ConvertFn = void (*)(const uint8_t* raw, s16* dst, uint32_t frames);
+
     FsAdapter* fs_ = nullptr;
+    ConvertFn convert_ = nullptr;
+    SampleFmt fmt_ = SampleFmt::S16;
     uint16_t channels_      = 1;
     uint16_t bitsPerSample_  = 16;
     uint32_t sampleRate_     = 44100;
@@ -1,7 +1,17 @@
 /// @file minimp3_impl.c
 /// Единственная единица трансляции, содержащая реализацию minimp3
+///
+/// SIMD minimp3 выбирает сам: SSE2 на x86-64, NEON на AArch64/ARMv7-A,
+/// на Cortex-M — скалярный путь. -DAE2_MINIMP3_NO_SIMD=1 — всегда скалярный
+/// (сравнение бит-в-бит с прошивкой).
 
 #define MINIMP3_IMPLEMENTATION
 #define MINIMP3_ONLY_MP3
-#define MINIMP3_NO_SIMD
+#if defined(AE2_MINIMP3_NO_SIMD) && AE2_MINIMP3_NO_SIMD
+#  define MINIMP3_NO_SIMD
+#endif
 #include "minimp3.h"
+
+/* Scratch кадра minimp3 — на стеке вызывающего (mp3dec_decode_frame);
+ * стек таска AudioMgr рассчитан под kCodecsStackBytes (Types.hpp) */
+_Static_assert(sizeof(mp3dec_scratch_t) <= 16384, "kCodecsStackBytes (Types.hpp) мал для mp3dec_scratch_t");
@@ -1,9 +1,26 @@
 /// @file FsAdapter.cpp
 #include "FsAdapter.hpp"
+#include "Profiler/Profiler.hpp"
+#include "Trace/Trace.hpp"
+#if AE2_HW_SIM
+#  include "AudioHw/AudioHw.hpp"
+#endif
 #include <algorithm>
 #include <cctype>
+#include <new>
 #include <string_view>
 
+/* Каталоги: FatFS на цели, POSIX dirent на хосте */
+#if defined(__has_include)
+#  if __has_include("ff.h")
+#    include "ff.h"
+#    define AE2_FS_FATFS 1
+#  elif __has_include(<dirent.h>)
+#    include <dirent.h>
+#    define AE2_FS_DIRENT 1
+#  endif
+#endif
+
 namespace ae2 {
 
 FsAdapter::FsAdapter(uint8_t* buf, size_t bufSize)
@@ -54,6 +71,16 @@ size_t FsAdapter::read(uint8_t* dst, size_t len) {
     return total;
 }
 
+size_t FsAdapter::peek(const uint8_t*& ptr) {
+    if (bufPos_ >= bufLen_ && !refill_()) { ptr = nullptr; return 0; }
+    ptr = buf_ + bufPos_;
+    return bufLen_ - bufPos_;
+}
+
+void FsAdapter::consume(size_t n) {
+    bufPos_ += std::min(n, bufLen_ - bufPos_);
+}
+
 bool FsAdapter::seek(uint32_t pos) {
     if (!file_) return false;
     /* В пределах буфера? */
@@ -95,10 +122,134 @@ std::string_view FsAdapter::extension() const {
 
 bool FsAdapter::refill_() {
     if (!file_) return false;
+    AE2_PROF_SCOPE(FsRefill);
+    AE2_TRACE_SPAN(span, FsRead);
     fileOffset_ += (uint32_t)bufLen_;
+#if AE2_HW_SIM
+    AudioHw::instance().simStorageRead();  /* латентность карты на виртуальных часах */
+#endif
     bufLen_ = std::fread(buf_, 1, bufSize_, file_);
+    AE2_TRACE_SET(span, bufLen_);
     bufPos_ = 0;
     return bufLen_ > 0;
 }
 
+/* ═══ FsDir ═══ */
+
+#if AE2_FS_FATFS
+
+const bool FsDir::kSupported = true;
+static_assert(sizeof(DIR) <= FsDir::kDirBytes, "FsDir::kDirBytes мал для DIR FatFS");
+
+bool FsDir::open(const char* path) {
+    close();
+    DIR* d = new (dirMem_) DIR();
+    if (f_opendir(d, path) != FR_OK) return false;
+    open_  = true;
+    index_ = 0;
+    return true;
+}
+
+void FsDir::close() {
+    if (open_) f_closedir(reinterpret_cast<DIR*>(dirMem_));
+    open_ = false;
+}
+
+bool FsDir::next(char* name, size_t cap) {
+    if (!open_) return false;
+    FILINFO fi;
+    for (;;) {
+        if (f_readdir(reinterpret_cast<DIR*>(dirMem_), &fi) != FR_OK || fi.fname[0] == 0)
+            return false;
+        index_++;
+        if (fi.fattrib & (AM_DIR | AM_HID | AM_SYS)) continue;
+        const size_t n = std::strlen(fi.fname);
+        if (n == 0 || n >= cap) continue;
+        std::memcpy(name, fi.fname, n + 1);
+        return true;
+    }
+}
+
+long FsDir::tell() const { return index_; }
+
+bool FsDir::seek(long pos) {
+    /* У FatFS нет seekdir: с начала и пропустить pos элементов */
+    rewind();
+    FILINFO fi;
+    while (index_ < pos) {
+        if (f_readdir(reinterpret_cast<DIR*>(dirMem_), &fi) != FR_OK || fi.fname[0] == 0)
+            return false;
+        index_++;
+    }
+    return true;
+}
+
+void FsDir::rewind() {
+    if (open_) f_readdir(reinterpret_cast<DIR*>(dirMem_), nullptr);
+    index_ = 0;
+}
+
+#elif AE2_FS_DIRENT
+
+const bool FsDir::kSupported = true;
+static_assert(sizeof(DIR*) <= FsDir::kDirBytes, "FsDir::kDirBytes мал для DIR*");
+
+static DIR*& dirOf(uint8_t* mem) { return *reinterpret_cast<DIR**>(mem); }
+static DIR*  dirOf(const uint8_t* mem) { return *reinterpret_cast<DIR* const*>(mem); }
+
+bool FsDir::open(const char* path) {
+    close();
+    DIR* d = opendir(path);
+    if (!d) return false;
+    dirOf(dirMem_) = d;
+    open_ = true;
+    return true;
+}
+
+void FsDir::close() {
+    if (open_) closedir(dirOf(dirMem_));
+    open_ = false;
+}
+
+bool FsDir::next(char* name, size_t cap) {
+    if (!open_) return false;
+    for (;;) {
+        const struct dirent* de = readdir(dirOf(dirMem_));
+        if (!de) return false;
+        if (de->d_name[0] == '.') continue;  /* ".", ".." и скрытые */
+#ifdef DT_DIR
+        if (de->d_type == DT_DIR) continue;
+#endif
+        const size_t n = std::strlen(de->d_name);
+        if (n >= cap) continue;
+        std::memcpy(name, de->d_name, n + 1);
+        return true;
+    }
+}
+
+long FsDir::tell() const { return open_ ? telldir(dirOf(dirMem_)) : 0; }
+
+bool FsDir::seek(long pos) {
+    if (!open_) return false;
+    seekdir(dirOf(dirMem_), pos);
+    return true;
+}
+
+void FsDir::rewind() {
+    if (open_) rewinddir(dirOf(dirMem_));
+}
+
+#else
+
+const bool FsDir::kSupported = false;
+
+bool FsDir::open(const char*) { return false; }
+void FsDir::close() {}
+bool FsDir::next(char*, size_t) { return false; }
+long FsDir::tell() const { return 0; }
+bool FsDir::seek(long) { return false; }
+void FsDir::rewind() {}
+
+#endif
+
 } // namespace ae2
@@ -1,6 +1,7 @@
 #pragma once
 /// @file FsAdapter.hpp
-/// @brief Буферизованный адаптер файловой системы (FILE* на хосте).
+/// @brief Буферизованный адаптер файловой системы (FILE* на хосте) и
+///        перечисление каталогов (FsDir).
 
 #include <cstdint>
 #include <cstdio>
@@ -25,6 +26,11 @@ public:
 
     /// Прочитать len байт в dst.
     size_t read(uint8_t* dst, size_t len);
+    /// Непрерывный участок внутреннего буфера с текущей позиции (0 копий).
+    /// Подкачивает буфер, если он исчерпан. Позиция не двигается до consume().
+    size_t peek(const uint8_t*& ptr);
+    /// Продвинуть позицию после peek() (не дальше буферизованного).
+    void consume(size_t n);
     /// Переместить позицию.
     bool seek(uint32_t pos);
     /// Текущая позиция.
@@ -58,4 +64,39 @@ private:
     mutable char ext_[16]{};  ///< кеш для extension()
 };
 
+/// Перечисление каталога без аллокаций. Бэкенд — при сборке: FatFS
+/// (f_opendir/f_readdir, если есть ff.h), иначе POSIX dirent; без обоих
+/// open() возвращает false (kSupported == false). Позиция tell()/seek() —
+/// telldir() у dirent, номер элемента у FatFS (seek — перечитывание с
+/// начала каталога).
+class FsDir {
+public:
+    static const bool kSupported;
+
+    FsDir() = default;
+    ~FsDir() { close(); }
+
+    FsDir(const FsDir&) = delete;
+    FsDir& operator=(const FsDir&) = delete;
+
+    bool open(const char* path);
+    void close();
+    [[nodiscard]] bool isOpen() const { return open_; }
+
+    /// Имя следующего файла (без каталога) в name; подкаталоги, "." и
+    /// "..", имена длиннее cap - 1 пропускаются. false — конец каталога.
+    bool next(char* name, size_t cap);
+    /// Позиция перед следующим элементом — для seek().
+    [[nodiscard]] long tell() const;
+    bool seek(long pos);
+    void rewind();
+
+    static constexpr size_t kDirBytes = 96;
+
+private:
+    alignas(8) uint8_t dirMem_[kDirBytes]{};  ///< DIR FatFS или DIR* dirent
+    bool open_  = false;
+    long index_ = 0;  ///< элементов прочитано с начала (FatFS)
+};
+
 } // namespace ae2
@@ -1,6 +1,7 @@
 /// @file Mp3Duration.cpp
 #include "Mp3Duration.hpp"
 #include "FsAdapter/FsAdapter.hpp"
+#include "Profiler/Profiler.hpp"
 #include <algorithm>
 #include <cstring>
 
@@ -39,17 +40,8 @@ static const uint16_t kSamplesPerFrame[4][3] = {
     /* MPEG1   */ {384, 1152, 1152}
 };
 
-struct FrameInfo {
-    uint32_t bitrate;    /* bps */
-    uint32_t sampleRate;
-    uint16_t samplesPerFrame;
-    uint16_t frameSize;
-    uint8_t  channels;
-    bool     valid;
-};
-
-static FrameInfo parseFrame(const uint8_t* h) {
-    FrameInfo fi{};
+Frame parseHeader(const uint8_t* h) {
+    Frame fi{};
     if (h[0] != 0xFF || (h[1] & 0xE0) != 0xE0) return fi;
 
     uint8_t versionBits = (h[1] >> 3) & 3;
@@ -80,36 +72,86 @@ static FrameInfo parseFrame(const uint8_t* h) {
     return fi;
 }
 
-static uint32_t skipId3v2(FsAdapter& fs) {
-    fs.seek(0);
-    uint8_t hdr[10];
-    if (fs.read(hdr, 10) < 10) return 0;
-    if (hdr[0] == 'I' && hdr[1] == 'D' && hdr[2] == '3') {
-        uint32_t sz = ((uint32_t)(hdr[6] & 0x7F) << 21) |
-                      ((uint32_t)(hdr[7] & 0x7F) << 14) |
-                      ((uint32_t)(hdr[8] & 0x7F) << 7) |
-                      (uint32_t)(hdr[9] & 0x7F);
-        return sz + 10;
+bool sameStream(const uint8_t* a, const uint8_t* b) {
+    /* sync + версия + слой (без бита CRC), индекс частоты */
+    return (a[1] & 0xFE) == (b[1] & 0xFE) && (a[2] & 0x0C) == (b[2] & 0x0C);
+}
+
+uint32_t id3v2Size(const uint8_t* h) {
+    if (h[0] != 'I' || h[1] != 'D' || h[2] != '3') return 0;
+    if ((h[6] | h[7] | h[8] | h[9]) & 0x80) return 0;  /* не syncsafe */
+    uint32_t sz = ((uint32_t)(h[6] & 0x7F) << 21) |
+                  ((uint32_t)(h[7] & 0x7F) << 14) |
+                  ((uint32_t)(h[8] & 0x7F) << 7) |
+                  (uint32_t)(h[9] & 0x7F);
+    /* ID3v2.4: флаг footer — ещё 10 байт */
+    return sz + 10 + ((h[3] == 4 && (h[5] & 0x10)) ? 10 : 0);
+}
+
+uint32_t apeTagSize(const uint8_t* h, bool* isHeader) {
+    if (std::memcmp(h, "APETAGEX", 8) != 0) return 0;
+    auto le32 = [h](uint32_t o) {
+        return (uint32_t)h[o] | ((uint32_t)h[o + 1] << 8) |
+               ((uint32_t)h[o + 2] << 16) | ((uint32_t)h[o + 3] << 24);
+    };
+    uint32_t size  = le32(12);  /* элементы + footer */
+    uint32_t flags = le32(20);
+    bool hasHeader = (flags >> 31) & 1;
+    if (isHeader) *isHeader = (flags >> 29) & 1;
+    return size + (hasHeader ? 32u : 0u);
+}
+
+Range audioRange(FsAdapter& fs, uint32_t fileSize) {
+    Range r{0, fileSize};
+    uint8_t h[32];
+
+    /* Ведущие теги: ID3v2 (бывает несколько подряд), APEv2 с header */
+    for (int guard = 0; guard < 4 && r.start + 32 <= fileSize; ++guard) {
+        fs.seek(r.start);
+        if (fs.read(h, 32) < 32) break;
+        bool isHeader = false;
+        uint32_t sz = id3v2Size(h);
+        if (!sz && (sz = apeTagSize(h, &isHeader)) && !isHeader) sz = 0;
+        if (!sz) break;
+        r.start += sz;
+    }
+
+    /* Хвост: ID3v1 последним, перед ним APEv2 (footer) */
+    if (fileSize >= kId3v1Size) {
+        fs.seek(fileSize - kId3v1Size);
+        if (fs.read(h, 3) == 3 && h[0] == 'T' && h[1] == 'A' && h[2] == 'G')
+            r.end -= kId3v1Size;
+    }
+    if (r.end >= 32) {
+        fs.seek(r.end - 32);
+        bool isHeader = true;
+        uint32_t sz = 0;
+        if (fs.read(h, 32) == 32 && (sz = apeTagSize(h, &isHeader)) && !isHeader && sz <= r.end)
+            r.end -= sz;
     }
-    return 0;
+    if (r.end < r.start) r.end = r.start;
+    fs.seek(r.start);
+    return r;
 }
 
 Result estimate(FsAdapter& fs, uint32_t fileSize) {
+    AE2_PROF_SCOPE(Mp3Duration);
     Result res{};
 
-    uint32_t dataStart = skipId3v2(fs);
-    fs.seek(dataStart);
+    const Range range = audioRange(fs, fileSize);
+    const uint32_t dataStart = range.start;
+    fileSize = range.end;
 
     /* Найти первый валидный фрейм */
     uint8_t buf[4];
     uint32_t scanLimit = 8192;
     uint32_t pos = dataStart;
-    FrameInfo first{};
+    Frame first{};
 
     while (pos < dataStart + scanLimit) {
         fs.seek(pos);
         if (fs.read(buf, 4) < 4) return res;
-        first = parseFrame(buf);
+        first = parseHeader(buf);
         if (first.valid) break;
         pos++;
     }
@@ -164,7 +206,7 @@ Result estimate(FsAdapter& fs, uint32_t fileSize) {
     while (frameCount < kMaxFrames && pos + 4 < fileSize) {
         fs.seek(pos);
         if (fs.read(buf, 4) < 4) break;
-        FrameInfo fi = parseFrame(buf);
+        Frame fi = parseHeader(buf);
         if (!fi.valid) { pos++; continue; }
 
         totalBitrate += fi.bitrate;
@@ -1,6 +1,7 @@
 #pragma once
 /// @file Mp3Duration.hpp
-/// @brief Быстрая оценка длительности MP3 без полного прохода.
+/// @brief Быстрая оценка длительности MP3 без полного прохода; разбор
+///        заголовков кадров и тегов (ID3v2, APEv2, ID3v1) для DecoderMp3.
 
 #include <cstdint>
 
@@ -19,5 +20,34 @@ struct Result {
 /// Оценить длительность. Xing/VBRI → точно. Иначе — средний битрейт.
 Result estimate(FsAdapter& fs, uint32_t fileSize);
 
+/// Заголовок MPEG-кадра.
+struct Frame {
+    uint32_t bitrate         = 0;  ///< bps
+    uint32_t sampleRate      = 0;
+    uint16_t samplesPerFrame = 0;
+    uint16_t frameSize       = 0;  ///< байт, с заголовком и padding
+    uint8_t  channels        = 0;
+    bool     valid           = false;
+};
+/// Разобрать 4 байта заголовка. Free-format (bitrate 0) — невалиден.
+Frame parseHeader(const uint8_t* h);
+/// Два заголовка одного потока: версия, слой и частота совпадают.
+bool sameStream(const uint8_t* a, const uint8_t* b);
+
+/// Размер тега ID3v2 с заголовком и footer по его первым 10 байтам;
+/// 0 — не ID3v2.
+uint32_t id3v2Size(const uint8_t* h);
+/// Размер тега APEv2 по 32 байтам "APETAGEX" (header или footer) с
+/// header и footer; 0 — не APEv2. isHeader — блок в начале тега.
+uint32_t apeTagSize(const uint8_t* h, bool* isHeader = nullptr);
+static constexpr uint32_t kId3v1Size = 128;
+
+/// Байты звука [start, end): без ведущих ID3v2/APEv2 и хвостовых APEv2/ID3v1.
+struct Range {
+    uint32_t start = 0;
+    uint32_t end   = 0;
+};
+Range audioRange(FsAdapter& fs, uint32_t fileSize);
+
 } // namespace Mp3Duration
 } // namespace ae2
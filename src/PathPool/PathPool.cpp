@@ -0,0 +1,171 @@
+/// @file PathPool.cpp
+#include "PathPool.hpp"
+#include <cstring>
+
+namespace ae2 {
+
+namespace {
+
+class Lock {
+public:
+    explicit Lock(SemaphoreHandle_t h) : h_(h) { if (h_) xSemaphoreTake(h_, portMAX_DELAY); }
+    ~Lock() { if (h_) xSemaphoreGive(h_); }
+    Lock(const Lock&) = delete;
+    Lock& operator=(const Lock&) = delete;
+private:
+    SemaphoreHandle_t h_;
+};
+
+} // namespace
+
+PathPool::PathPool() {
+    lock_ = xSemaphoreCreateMutexStatic(&lockBuf_);
+}
+
+PathPool::Id PathPool::findChild_(Id parent, const char* seg, uint32_t len) const {
+    for (uint32_t i = 1; i < kMaxNodes; ++i) {
+        const Node& n = nodes_[i];
+        if (n.len == len && n.parent == parent &&
+            std::memcmp(arena_ + n.off, seg, len) == 0)
+            return (Id)i;
+    }
+    return kInvalid;
+}
+
+PathPool::Id PathPool::addChild_(Id parent, const char* seg, uint32_t len) {
+    if (nodesUsed_ >= kMaxNodes - 1) return kInvalid;
+    if (arenaTop_ + len > kArenaSize) {
+        if (arenaTop_ - arenaFree_ + len > kArenaSize) return kInvalid;
+        compact_();
+    }
+    Id id = kInvalid;
+    for (uint32_t i = 1; i < kMaxNodes; ++i) {
+        if (nodes_[i].len == 0) { id = (Id)i; break; }
+    }
+    if (id == kInvalid) return kInvalid;
+
+    Node& n = nodes_[id];
+    n.parent = parent;
+    n.refs   = 0;
+    n.off    = (uint16_t)arenaTop_;
+    n.len    = (uint8_t)len;
+    std::memcpy(arena_ + arenaTop_, seg, len);
+    arenaTop_ += len;
+    nodesUsed_++;
+    if (parent != kInvalid) nodes_[parent].refs++;
+    return id;
+}
+
+PathPool::Id PathPool::intern(const char* path) {
+    if (!path || !path[0]) return kInvalid;
+    Lock lk(lock_);
+
+    /* Сегмент = текст до '/' включительно; последний — остаток */
+    Id cur = kInvalid;
+    uint32_t depth = 0;
+    const char* p = path;
+    while (*p) {
+        const char* slash = std::strchr(p, '/');
+        uint32_t len = slash ? (uint32_t)(slash - p + 1) : (uint32_t)std::strlen(p);
+        if (len > 255) len = 255;  /* длинные имена режем на несколько узлов */
+
+        Id child = kInvalid;
+        if (++depth <= kMaxDepth) {
+            child = findChild_(cur, p, len);
+            if (child == kInvalid) child = addChild_(cur, p, len);
+        }
+        if (child == kInvalid) {
+            /* Откатываем только что созданные узлы без ссылок */
+            while (cur != kInvalid && nodes_[cur].refs == 0) {
+                Id parent = nodes_[cur].parent;
+                arenaFree_ += nodes_[cur].len;
+                nodes_[cur] = Node{};
+                nodesUsed_--;
+                if (parent != kInvalid) nodes_[parent].refs--;
+                cur = parent;
+            }
+            if (nodesUsed_ == 0) arenaTop_ = arenaFree_ = 0;
+            return kInvalid;
+        }
+        cur = child;
+        p += len;
+    }
+    nodes_[cur].refs++;
+    return cur;
+}
+
+void PathPool::retain(Id id) {
+    if (id == kInvalid || id >= kMaxNodes) return;
+    Lock lk(lock_);
+    nodes_[id].refs++;
+}
+
+void PathPool::release(Id id) {
+    if (id == kInvalid || id >= kMaxNodes) return;
+    Lock lk(lock_);
+    releaseLocked_(id);
+}
+
+void PathPool::releaseLocked_(Id id) {
+    if (nodes_[id].refs == 0) return;
+    nodes_[id].refs--;
+    while (id != kInvalid && nodes_[id].refs == 0) {
+        Id parent = nodes_[id].parent;
+        arenaFree_ += nodes_[id].len;
+        nodes_[id] = Node{};
+        nodesUsed_--;
+        if (parent != kInvalid) nodes_[parent].refs--;
+        id = parent;
+    }
+    if (nodesUsed_ == 0) arenaTop_ = arenaFree_ = 0;
+}
+
+size_t PathPool::resolve(Id id, char* out, size_t cap) const {
+    if (!out || cap == 0) return 0;
+    out[0] = '\0';
+    if (id == kInvalid || id >= kMaxNodes) return 0;
+    Lock lk(lock_);
+
+    Id chain[kMaxDepth];
+    uint32_t depth = 0;
+    for (Id n = id; n != kInvalid && depth < kMaxDepth; n = nodes_[n].parent)
+        chain[depth++] = n;
+
+    size_t len = 0;
+    while (depth > 0) {
+        const Node& n = nodes_[chain[--depth]];
+        size_t chunk = n.len;
+        if (len + chunk > cap - 1) chunk = cap - 1 - len;
+        std::memcpy(out + len, arena_ + n.off, chunk);
+        len += chunk;
+        if (len == cap - 1) break;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+/* Сдвигаем живые сегменты к началу арены в порядке смещений.
+ * O(n²) по узлам, но вызывается только при исчерпании арены
+ * и только из intern() (командный путь, не hot path). */
+void PathPool::compact_() {
+    uint32_t cursor = 0;
+    int32_t  lastOff = -1;
+    for (;;) {
+        Id best = kInvalid;
+        for (uint32_t i = 1; i < kMaxNodes; ++i) {
+            const Node& n = nodes_[i];
+            if (n.len == 0 || (int32_t)n.off <= lastOff) continue;
+            if (best == kInvalid || n.off < nodes_[best].off) best = (Id)i;
+        }
+        if (best == kInvalid) break;
+        Node& n = nodes_[best];
+        lastOff = n.off;
+        if (n.off != cursor) std::memmove(arena_ + cursor, arena_ + n.off, n.len);
+        n.off = (uint16_t)cursor;
+        cursor += n.len;
+    }
+    arenaTop_  = cursor;
+    arenaFree_ = 0;
+}
+
+} // namespace ae2
@@ -0,0 +1,70 @@
+#pragma once
+/// @file PathPool.hpp
+/// @brief Пул интернированных путей с общими префиксами и счётчиком ссылок.
+///
+/// Путь хранится как цепочка сегментов ("/", "sd/", "music/", "a.mp3"),
+/// каждый сегмент — узел со ссылкой на родителя. Одинаковые каталоги
+/// разделяются между всеми путями, поэтому очередь из альбома стоит
+/// ~8 байт узла + длина имени файла на трек. Копия пути — это копия Id
+/// плюс retain(), без strncpy.
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace ae2 {
+
+class PathPool {
+public:
+    using Id = uint16_t;
+    static constexpr Id kInvalid = 0;
+
+    static constexpr uint32_t kMaxNodes  = 256;
+    static constexpr uint32_t kArenaSize = 3072;
+    static constexpr size_t   kMaxPath   = 256;
+    static constexpr uint32_t kMaxDepth  = 32;
+
+    PathPool();
+
+    PathPool(const PathPool&) = delete;
+    PathPool& operator=(const PathPool&) = delete;
+
+    /// Интернировать путь. Возвращает Id с одной ссылкой или kInvalid,
+    /// если пул переполнен / путь пуст / слишком глубокий.
+    Id intern(const char* path);
+    /// +1 ссылка.
+    void retain(Id id);
+    /// -1 ссылка; узлы без ссылок возвращаются в пул.
+    void release(Id id);
+    /// Собрать полный путь в out (всегда с '\0'). Возвращает длину.
+    size_t resolve(Id id, char* out, size_t cap) const;
+
+    [[nodiscard]] uint32_t nodesUsed() const { return nodesUsed_; }
+    [[nodiscard]] uint32_t arenaUsed() const { return arenaTop_ - arenaFree_; }
+
+private:
+    struct Node {
+        uint16_t parent = 0;   ///< индекс родителя (0 = корень)
+        uint16_t refs   = 0;   ///< внешние ссылки + число детей; 0 = свободен
+        uint16_t off    = 0;   ///< смещение сегмента в arena_
+        uint8_t  len    = 0;   ///< длина сегмента
+    };
+
+    /* Узел 0 зарезервирован (kInvalid / корень) */
+    Node     nodes_[kMaxNodes]{};
+    char     arena_[kArenaSize]{};
+    uint32_t arenaTop_  = 0;   ///< bump-указатель
+    uint32_t arenaFree_ = 0;   ///< байт мёртвых сегментов ниже arenaTop_
+    uint32_t nodesUsed_ = 0;
+
+    StaticSemaphore_t lockBuf_{};
+    SemaphoreHandle_t lock_ = nullptr;
+
+    Id   findChild_(Id parent, const char* seg, uint32_t len) const;
+    Id   addChild_(Id parent, const char* seg, uint32_t len);
+    void releaseLocked_(Id id);
+    void compact_();
+};
+
+} // namespace ae2
@@ -0,0 +1,241 @@
+/// @file PcmCache.cpp
+#include "PcmCache.hpp"
+#include <cstring>
+
+namespace ae2 {
+
+void PcmCache::attach(void* mem, uint32_t bytes) {
+    abortFill();
+    for (auto& e : entries_) e = Entry{};
+    top_ = 0;
+    useClock_ = 0;
+    pinned_ = -1;  /* играющий трек дочитывает старый блок: его не трогаем */
+    stats_ = Stats{};
+
+    /* Записи выровнены на 4 от начала блока */
+    const uintptr_t raw = reinterpret_cast<uintptr_t>(mem);
+    const uintptr_t pad = (4u - (raw & 3u)) & 3u;
+    if (!mem || bytes <= pad + 4u) {
+        mem_ = nullptr;
+        capacity_ = 0;
+        return;
+    }
+    mem_      = static_cast<uint8_t*>(mem) + pad;
+    capacity_ = (bytes - (uint32_t)pad) & ~3u;
+}
+
+uint32_t PcmCache::hash_(const char* path, size_t len) {
+    uint32_t h = 2166136261u;  /* FNV-1a */
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (uint8_t)path[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+int32_t PcmCache::find_(const char* path, size_t len) const {
+    const uint32_t h = hash_(path, len);
+    for (uint32_t i = 0; i < kMaxEntries; ++i) {
+        const Entry& e = entries_[i];
+        if (e.used && !e.stale && e.hash == h && e.pathLen == len &&
+            std::memcmp(mem_ + e.off, path, len) == 0)
+            return (int32_t)i;
+    }
+    return -1;
+}
+
+int32_t PcmCache::oldest_() const {
+    int32_t best = -1;
+    for (uint32_t i = 0; i < kMaxEntries; ++i) {
+        if (!entries_[i].used || entries_[i].stale || (int32_t)i == pinned_) continue;
+        if (best < 0 || entries_[i].lastUse < entries_[best].lastUse)
+            best = (int32_t)i;
+    }
+    return best;
+}
+
+void PcmCache::compact_() {
+    /* Вызывается только без активного заполнения: выше top_ данных нет.
+     * Живые записи — вниз по порядку смещений, один проход по блоку */
+    if (pinned_ >= 0) return;
+    uint32_t dst = 0;
+    for (;;) {
+        Entry* next = nullptr;
+        for (auto& e : entries_) {
+            if (e.used && e.off >= dst && (!next || e.off < next->off)) next = &e;
+        }
+        if (!next) break;
+        const uint32_t span = span_(*next);
+        if (next->off != dst) {
+            std::memmove(mem_ + dst, mem_ + next->off, span);
+            next->off = dst;
+        }
+        dst += span;
+    }
+    top_ = dst;
+}
+
+bool PcmCache::lookup(const char* path, View& out) {
+    if (!mem_ || !path) return false;
+    const int32_t i = find_(path, std::strlen(path));
+    if (i < 0) {
+        stats_.misses++;
+        return false;
+    }
+    Entry& e = entries_[i];
+    e.lastUse = ++useClock_;
+    out.pcm     = pcm_(e);
+    out.samples = e.samples;
+    out.rate    = e.rate;
+    stats_.hits++;
+    return true;
+}
+
+void PcmCache::invalidate(const char* path) {
+    if (!mem_ || !path) return;
+    abortFill();
+    const int32_t i = find_(path, std::strlen(path));
+    if (i < 0) return;
+    if (i == pinned_) {
+        entries_[i].stale = true;
+        return;
+    }
+    entries_[i] = Entry{};
+    compact_();
+}
+
+void PcmCache::clear() {
+    abortFill();
+    for (uint32_t i = 0; i < kMaxEntries; ++i) {
+        if ((int32_t)i == pinned_) entries_[i].stale = true;
+        else                       entries_[i] = Entry{};
+    }
+    if (pinned_ < 0) top_ = 0;
+}
+
+void PcmCache::pin(const View& v) {
+    unpin();
+    for (uint32_t i = 0; i < kMaxEntries; ++i) {
+        if (entries_[i].used && pcm_(entries_[i]) == v.pcm) {
+            pinned_ = (int32_t)i;
+            return;
+        }
+    }
+}
+
+void PcmCache::unpin() {
+    if (pinned_ < 0) return;
+    Entry& e = entries_[pinned_];
+    pinned_ = -1;
+    if (e.stale) e = Entry{};
+    compact_();  /* отложенный сдвиг после invalidate/clear/вытеснения */
+}
+
+bool PcmCache::beginFill(const char* path, uint32_t minSamples) {
+    abortFill();
+    if (!mem_ || !path) return false;
+    const size_t len = std::strlen(path);
+    if (len == 0 || len >= kMaxPath) return false;
+    const uint64_t need = header_((uint32_t)len) + (uint64_t)minSamples * sizeof(s16);
+    if (need > capacity_) return false;
+
+    /* Старая запись того же пути (после invalidate её нет) */
+    int32_t slot = find_(path, len);
+    if (slot >= 0 && slot == pinned_) return false;  /* играет сейчас */
+    uint32_t live = top_;
+    bool dirty = false;
+    if (slot >= 0) {
+        live -= span_(entries_[slot]);
+        entries_[slot] = Entry{};
+        dirty = true;
+    }
+
+    /* Вытесняем давно не игравшие, пока не хватит слота и места; сдвиг
+     * оставшихся — одним проходом после выбора всех жертв */
+    slot = -1;
+    for (uint32_t i = 0; i < kMaxEntries && slot < 0; ++i) {
+        if (!entries_[i].used) slot = (int32_t)i;
+    }
+    while (slot < 0 || capacity_ - live < need) {
+        const int32_t victim = oldest_();
+        if (victim < 0) break;
+        live -= span_(entries_[victim]);
+        entries_[victim] = Entry{};
+        stats_.evictions++;
+        dirty = true;
+        if (slot < 0) slot = victim;
+    }
+    if (dirty) compact_();
+    if (slot < 0 || capacity_ - top_ < need) return false;
+
+    Entry& e = entries_[slot];
+    e = Entry{};
+    e.off     = top_;
+    e.pathLen = (uint16_t)len;
+    e.hash    = hash_(path, len);
+    std::memcpy(mem_ + top_, path, len);
+    fillEntry_ = slot;
+    fillCap_   = (capacity_ - top_ - header_((uint32_t)len)) / (uint32_t)sizeof(s16);
+    return true;
+}
+
+s16* PcmCache::fillSpace(uint32_t& cap) {
+    if (fillEntry_ < 0) {
+        cap = 0;
+        return nullptr;
+    }
+    const Entry& e = entries_[fillEntry_];
+    cap = fillCap_ - e.samples;
+    return pcm_(e) + e.samples;
+}
+
+void PcmCache::fillAdvance(uint32_t n) {
+    if (fillEntry_ >= 0) entries_[fillEntry_].samples += n;
+}
+
+bool PcmCache::fillAppend(const s16* src, uint32_t n) {
+    uint32_t cap = 0;
+    s16* dst = fillSpace(cap);
+    if (!dst) return false;
+    if (n > cap) {
+        abortFill();  /* файл длиннее оценки и хвоста блока */
+        return false;
+    }
+    std::memcpy(dst, src, n * sizeof(s16));
+    fillAdvance(n);
+    return true;
+}
+
+bool PcmCache::commitFill(uint32_t rate) {
+    if (fillEntry_ < 0) return false;
+    Entry& e = entries_[fillEntry_];
+    if (e.samples == 0 || rate == 0) {
+        abortFill();
+        return false;
+    }
+    e.rate    = rate;
+    e.used    = true;
+    e.lastUse = ++useClock_;
+    top_ += span_(e);
+    fillEntry_ = -1;
+    stats_.fills++;
+    return true;
+}
+
+void PcmCache::abortFill() {
+    if (fillEntry_ < 0) return;
+    entries_[fillEntry_] = Entry{};
+    fillEntry_ = -1;
+    stats_.aborts++;
+}
+
+PcmCache::Stats PcmCache::stats() const {
+    Stats s = stats_;
+    s.capacity = capacity_;
+    s.used     = top_;
+    s.entries  = 0;
+    for (const auto& e : entries_) s.entries += (e.used && !e.stale) ? 1u : 0u;
+    return s;
+}
+
+} // namespace ae2
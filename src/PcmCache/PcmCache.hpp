@@ -0,0 +1,127 @@
+#pragma once
+/// @file PcmCache.hpp
+/// @brief LRU-кэш декодированного PCM коротких файлов (подсказки, диагностика).
+///
+/// Память — один блок снаружи (attach): прошивка берёт его из нужной зоны
+/// RegionAlloc (SRAM для частых подсказок, внешняя PSRAM для объёма).
+/// Запись — путь и моно s16 PCM подряд; записи лежат плотно от начала
+/// блока, вытеснение LRU сдвигает оставшиеся вниз (один memmove-проход
+/// на старте трека, не на hot path). Заполнение идёт в свободный хвост блока по ходу
+/// обычного декодирования; запись появляется только после конца файла.
+///
+/// Запись, которую играет DecoderRamPcm, закрепляется (pin): пока она
+/// закреплена, её память не двигается и не освобождается — invalidate и
+/// clear только помечают её, а сдвиг остальных откладывается до unpin().
+///
+/// Без блокировок: все методы — из одного таска (AudioMgr). stats()
+/// читается из любого таска (снимок счётчиков, рваный — допустимо).
+
+#include "AudioEngineV2/Types.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace ae2 {
+
+class PcmCache {
+public:
+    static constexpr uint32_t kMaxEntries = 16;
+    static constexpr size_t   kMaxPath    = 256;  ///< = PathPool::kMaxPath
+
+    struct View {
+        const s16* pcm     = nullptr;
+        uint32_t   samples = 0;
+        uint32_t   rate    = 0;
+    };
+
+    struct Stats {
+        uint32_t capacity  = 0;  ///< байт блока
+        uint32_t used      = 0;  ///< байт под записями
+        uint32_t entries   = 0;
+        uint32_t hits      = 0;
+        uint32_t misses    = 0;  ///< lookup без записи (при подключённом блоке)
+        uint32_t fills     = 0;  ///< записей добавлено
+        uint32_t aborts    = 0;  ///< заполнений прервано (seek, стоп, не влезло)
+        uint32_t evictions = 0;
+    };
+
+    PcmCache() = default;
+    PcmCache(const PcmCache&) = delete;
+    PcmCache& operator=(const PcmCache&) = delete;
+
+    /// Подключить блок (nullptr/0 — выключить). Содержимое сбрасывается.
+    void attach(void* mem, uint32_t bytes);
+    [[nodiscard]] bool enabled() const { return mem_ != nullptr; }
+    [[nodiscard]] uint32_t capacity() const { return capacity_; }
+
+    /// Найти запись по пути; попадание делает её самой свежей.
+    bool lookup(const char* path, View& out);
+    /// Удалить запись (файл изменился на носителе).
+    void invalidate(const char* path);
+    /// Удалить все записи.
+    void clear();
+
+    /// Закрепить запись из lookup() на время проигрывания (одна за раз).
+    void pin(const View& v);
+    /// Снять закрепление; отложенные удаление и сдвиг выполняются здесь.
+    void unpin();
+
+    /* ── Заполнение: begin → (space/advance)* → commit | abort ── */
+
+    /// Начать запись для path. minSamples — оценка длины: LRU вытесняется,
+    /// пока в хвосте не станет столько места. @return false — не влезет
+    bool beginFill(const char* path, uint32_t minSamples);
+    [[nodiscard]] bool filling() const { return fillEntry_ >= 0; }
+    /// Куда писать следующую порцию; cap — сколько сэмплов туда влезет.
+    s16* fillSpace(uint32_t& cap);
+    /// Дописано n сэмплов в fillSpace().
+    void fillAdvance(uint32_t n);
+    /// Скопировать порцию; не влезла — заполнение прерывается.
+    bool fillAppend(const s16* src, uint32_t n);
+    /// Завершить запись с частотой rate. @return false — пусто или прервано
+    bool commitFill(uint32_t rate);
+    void abortFill();
+
+    [[nodiscard]] Stats stats() const;
+
+private:
+    struct Entry {
+        uint32_t off     = 0;  ///< начало записи в блоке (путь, затем PCM)
+        uint32_t samples = 0;
+        uint32_t rate    = 0;
+        uint32_t lastUse = 0;  ///< useClock_ последнего попадания
+        uint32_t hash    = 0;
+        uint16_t pathLen = 0;
+        bool     used    = false;
+        bool     stale   = false;  ///< удалена, пока закреплена; освобождается в unpin()
+    };
+
+    uint8_t* mem_      = nullptr;
+    uint32_t capacity_ = 0;
+    uint32_t top_      = 0;  ///< конец последней записи (записи плотные)
+    uint32_t useClock_ = 0;
+    Entry    entries_[kMaxEntries]{};
+
+    int32_t  fillEntry_ = -1;  ///< слот заполняемой записи, -1 — нет
+    uint32_t fillCap_   = 0;   ///< сэмплов до конца блока
+    int32_t  pinned_    = -1;  ///< закреплённый слот, -1 — нет
+
+    Stats stats_{};
+
+    static uint32_t hash_(const char* path, size_t len);
+    static uint32_t header_(uint32_t pathLen) { return (pathLen + 3u) & ~3u; }
+    /// Байт записи в блоке, с выравниванием следующей на 4.
+    static uint32_t span_(const Entry& e) {
+        return (header_(e.pathLen) + e.samples * (uint32_t)sizeof(s16) + 3u) & ~3u;
+    }
+    [[nodiscard]] s16* pcm_(const Entry& e) const {
+        return reinterpret_cast<s16*>(mem_ + e.off + header_(e.pathLen));
+    }
+    int32_t find_(const char* path, size_t len) const;
+    /// Сдвинуть живые записи вниз, без дыр от удалённых. При закреплённой
+    /// записи не делает ничего: дыры остаются до unpin().
+    void compact_();
+    /// Самая старая готовая незакреплённая запись; -1 — нет.
+    [[nodiscard]] int32_t oldest_() const;
+};
+
+} // namespace ae2
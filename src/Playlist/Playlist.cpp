@@ -0,0 +1,357 @@
+/// @file Playlist.cpp
+#include "Playlist.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace ae2 {
+
+namespace {
+
+bool extIs(const char* name, const char* ext) {
+    const char* dot = std::strrchr(name, '.');
+    if (!dot || dot == name) return false;
+    ++dot;
+    while (*dot && *ext) {
+        if (std::tolower((unsigned char)*dot) != *ext) return false;
+        ++dot; ++ext;
+    }
+    return *dot == '\0' && *ext == '\0';
+}
+
+bool isAudioName(const char* name) {
+    return extIs(name, "mp3") || extIs(name, "wav") || extIs(name, "flac") ||
+           extIs(name, "alaw") || extIs(name, "ulaw");
+}
+
+bool isAbsolute(const char* p) {
+    return p[0] == '/' || p[0] == '\\' || std::strchr(p, ':') != nullptr;
+}
+
+/* Глубже PathPool::kMaxDepth путь не интернируется никогда — пропускаем,
+ * иначе такой элемент ждал бы места в пуле вечно */
+bool tooDeep(const char* p) {
+    uint32_t segs = 1;
+    for (; *p; ++p) segs += (*p == '/' && p[1]) ? 1u : 0u;
+    return segs > PathPool::kMaxDepth;
+}
+
+/* murmur3 fmix32 — раунд-функция Feistel */
+uint32_t mix(uint32_t h) {
+    h ^= h >> 16; h *= 0x85EBCA6Bu;
+    h ^= h >> 13; h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+} // namespace
+
+Playlist::Playlist(PathPool& pool) : pool_(pool) {}
+
+bool Playlist::open(const char* path, bool shuffle, uint32_t seed) {
+    close();
+    if (!path || !path[0]) return false;
+
+    size_t len = std::strlen(path);
+    if (len >= sizeof(base_) - 1) return false;
+
+    if (extIs(path, "m3u") || extIs(path, "m3u8")) {
+        if (!list_.open(path)) return false;
+        kind_ = Kind::M3u;
+        /* Относительные пути — от каталога плейлиста */
+        const char* slash = std::strrchr(path, '/');
+        size_t baseLen = slash ? (size_t)(slash - path + 1) : 0;
+        std::memcpy(base_, path, baseLen);
+        base_[baseLen] = '\0';
+    } else {
+        if (!dir_.open(path)) return false;
+        kind_ = Kind::Dir;
+        std::memcpy(base_, path, len + 1);
+        if (base_[len - 1] != '/') { base_[len] = '/'; base_[len + 1] = '\0'; }
+    }
+
+    shuffle_ = shuffle;
+    seed_    = seed;
+
+    if (shuffle_) {
+        scanning_ = true;  /* длина и контрольные точки — в scanStep() */
+        return true;
+    }
+
+    fillWindow_();
+    if (winCount_ == 0 && rawEof_) { close(); return false; }
+    return true;
+}
+
+void Playlist::scanStep(uint32_t budget) {
+    if (!scanning_) return;
+    /* Проход пути не сохраняет: только длина и контрольные точки */
+    char tmp[PathPool::kMaxPath];
+    while (budget--) {
+        if (readRaw_(tmp, sizeof(tmp))) continue;
+        scanning_ = false;
+        count_ = rawPos_;
+        rewindRaw_();
+        if (count_ == 0) { close(); return; }
+        fillWindow_();
+        return;
+    }
+}
+
+void Playlist::close() {
+    for (uint32_t i = 0; i < winCount_; ++i)
+        pool_.release(window_[(winHead_ + i) % kWindow].path);
+    for (auto& e : window_) e = Entry{};
+    winHead_ = winCount_ = 0;
+
+    list_.close();
+    dir_.close();
+    probe_.close();
+    nProvisional_ = 0;
+    kind_ = Kind::None;
+    base_[0] = '\0';
+    rawPos_ = 0;
+    rawEof_ = false;
+    scanning_ = false;
+    nCheckpoints_ = 0;
+    stride_ = 1;
+    count_ = produced_ = played_ = 0;
+}
+
+/* ═══ Перечислитель ═══ */
+
+long Playlist::tellRaw_() const {
+    if (kind_ == Kind::M3u) return (long)list_.tell();
+    if (kind_ == Kind::Dir) return dir_.tell();
+    return 0;
+}
+
+bool Playlist::seekRaw_(long pos) {
+    rawEof_ = false;
+    if (kind_ == Kind::M3u) return list_.seek((uint32_t)pos);
+    if (kind_ == Kind::Dir) return dir_.seek(pos);
+    return false;
+}
+
+void Playlist::rewindRaw_() {
+    if (kind_ == Kind::M3u) list_.seek(0);
+    if (kind_ == Kind::Dir) dir_.rewind();
+    rawPos_ = 0;
+    rawEof_ = false;
+}
+
+bool Playlist::readLine_(char* out, size_t cap) {
+    /* Прямо из буфера FsAdapter: memchr по участку, без побайтового read() */
+    size_t n = 0;
+    bool got = false;
+    for (;;) {
+        const uint8_t* p = nullptr;
+        const size_t avail = list_.peek(p);
+        if (avail == 0) break;
+        got = true;
+        const auto* nl = static_cast<const uint8_t*>(std::memchr(p, '\n', avail));
+        const size_t len = nl ? (size_t)(nl - p) : avail;
+        const size_t copy = std::min(len, cap - 1 - n);
+        std::memcpy(out + n, p, copy);
+        n += copy;
+        list_.consume(nl ? len + 1 : len);
+        if (nl) break;
+    }
+    out[n] = '\0';
+    return got;
+}
+
+bool Playlist::readRaw_(char* out, size_t cap) {
+    if (rawEof_) return false;
+    size_t baseLen = std::strlen(base_);
+
+    for (;;) {
+        long pos = tellRaw_();
+
+        if (kind_ == Kind::M3u) {
+            /* Строка целиком; хвост длинной строки отбрасываем */
+            if (!readLine_(out, cap)) { rawEof_ = true; return false; }
+            size_t n = std::strlen(out);
+            while (n > 0 && std::isspace((unsigned char)out[n - 1])) n--;
+            out[n] = '\0';
+            size_t skip = 0;
+            while (skip < n && std::isspace((unsigned char)out[skip])) skip++;
+            if (skip == n || out[skip] == '#') continue;
+            if (skip > 0) { std::memmove(out, out + skip, n - skip + 1); n -= skip; }
+            if (!isAudioName(out)) continue;
+            if (!isAbsolute(out)) {
+                if (baseLen + n >= cap) continue;
+                std::memmove(out + baseLen, out, n + 1);
+                std::memcpy(out, base_, baseLen);
+            }
+        } else {
+            if (baseLen >= cap || !dir_.next(out + baseLen, cap - baseLen)) {
+                rawEof_ = true;
+                return false;
+            }
+            if (!isAudioName(out + baseLen)) continue;
+            std::memcpy(out, base_, baseLen);
+        }
+        if (tooDeep(out)) continue;
+
+        addCheckpoint_(rawPos_, pos);
+        rawPos_++;
+        return true;
+    }
+}
+
+void Playlist::addCheckpoint_(uint32_t idx, long pos) {
+    if (idx != nCheckpoints_ * stride_) return;
+    if (nCheckpoints_ == kCheckpoints) {
+        /* Прореживаем вдвое — индекс остаётся O(1) по памяти */
+        for (uint32_t i = 0; i < kCheckpoints / 2; ++i)
+            checkpoints_[i] = checkpoints_[i * 2];
+        nCheckpoints_ = kCheckpoints / 2;
+        stride_ *= 2;
+        if (idx != nCheckpoints_ * stride_) return;
+    }
+    checkpoints_[nCheckpoints_++] = pos;
+}
+
+bool Playlist::readAt_(uint32_t idx, char* out, size_t cap) {
+    if (idx != rawPos_ && nCheckpoints_ > 0) {
+        uint32_t c = idx / stride_;
+        if (c >= nCheckpoints_) c = nCheckpoints_ - 1;
+        /* Перематываем, только если текущий курсор не ближе */
+        if (rawPos_ > idx || rawPos_ < c * stride_) {
+            if (!seekRaw_(checkpoints_[c])) return false;
+            rawPos_ = c * stride_;
+        }
+    }
+    while (rawPos_ < idx) {
+        if (!readRaw_(out, cap)) return false;
+    }
+    return readRaw_(out, cap);
+}
+
+/* ═══ Окно ═══ */
+
+void Playlist::fillWindow_() {
+    char path[PathPool::kMaxPath];
+    while (winCount_ < kWindow) {
+        if (shuffle_ && produced_ >= count_) return;
+        uint32_t idx = shuffle_ ? permute_(produced_) : produced_;
+        if (shuffle_ && isProvisional_(idx)) { produced_++; continue; }  /* уже отдан при подсчёте */
+
+        long     savedPos = tellRaw_();
+        uint32_t savedRaw = rawPos_;
+        if (!readAt_(idx, path, sizeof(path))) {
+            if (!shuffle_) return;  /* конец списка */
+            produced_++;            /* список укоротился после подсчёта */
+            continue;
+        }
+
+        PathPool::Id id = pool_.intern(path);
+        if (id == PathPool::kInvalid) {
+            /* Пул занят очередью — вернёмся к этому элементу позже */
+            seekRaw_(savedPos);
+            rawPos_ = savedRaw;
+            return;
+        }
+        Entry& e = window_[(winHead_ + winCount_) % kWindow];
+        e = Entry{};
+        e.path  = id;
+        e.index = produced_++;
+        winCount_++;
+    }
+}
+
+bool Playlist::next(Entry& out) {
+    if (kind_ == Kind::None) return false;  /* без open() — не читаем */
+    if (scanning_) return nextProvisional_(out);
+    fillWindow_();
+    if (winCount_ == 0) return false;
+    out = window_[winHead_];
+    window_[winHead_] = Entry{};
+    winHead_ = (winHead_ + 1) % kWindow;
+    winCount_--;
+    played_++;
+    fillWindow_();
+    return true;
+}
+
+bool Playlist::probeStep() {
+    for (uint32_t i = 0; i < winCount_; ++i) {
+        Entry& e = window_[(winHead_ + i) % kWindow];
+        if (e.probed) continue;
+        char path[PathPool::kMaxPath];
+        pool_.resolve(e.path, path, sizeof(path));
+        e.probed = true;
+        if (probe_.open(path)) {
+            e.codec = CodecDetect::detect(probe_);
+            probe_.close();
+        }
+        return true;
+    }
+    return false;
+}
+
+bool Playlist::exhausted() const {
+    if (kind_ == Kind::None) return true;
+    if (scanning_ || winCount_ > 0) return false;
+    return shuffle_ ? produced_ >= count_ : rawEof_;
+}
+
+/* ═══ Shuffle ═══ */
+
+/* Подсчёт ещё идёт: случайный элемент среди уже посчитанных (временное
+ * N = rawPos_). Курсор подсчёта сохраняется и возвращается на место. */
+bool Playlist::nextProvisional_(Entry& out) {
+    const uint32_t n = rawPos_;
+    if (nProvisional_ == kProvisional || nProvisional_ >= n) return false;
+    uint32_t idx = mix(seed_ ^ ((nProvisional_ + 1) * 0x9E3779B9u)) % n;
+    while (isProvisional_(idx)) idx = (idx + 1) % n;
+
+    char path[PathPool::kMaxPath];
+    const long     savedPos = tellRaw_();
+    const uint32_t savedRaw = rawPos_;
+    const bool     ok = readAt_(idx, path, sizeof(path));
+    seekRaw_(savedPos);
+    rawPos_ = savedRaw;
+    if (!ok) return false;
+
+    PathPool::Id id = pool_.intern(path);
+    if (id == PathPool::kInvalid) return false;
+    provisional_[nProvisional_++] = idx;
+    out = Entry{};
+    out.path  = id;
+    out.index = played_++;
+    return true;
+}
+
+bool Playlist::isProvisional_(uint32_t idx) const {
+    for (uint32_t i = 0; i < nProvisional_; ++i)
+        if (provisional_[i] == idx) return true;
+    return false;
+}
+
+/* Feistel-сеть на чётном числе бит + cycle walking: биекция [0,count_),
+ * зависящая только от seed_. Список в памяти не нужен. */
+uint32_t Playlist::permute_(uint32_t i) const {
+    uint32_t bits = 2;
+    while (bits < 32 && (1u << bits) < count_) bits++;
+    if (bits & 1) bits++;
+    const uint32_t half = bits / 2;
+    const uint32_t mask = (1u << half) - 1;
+
+    uint32_t x = i;
+    do {
+        uint32_t l = x >> half;
+        uint32_t r = x & mask;
+        for (uint32_t round = 0; round < 4; ++round) {
+            uint32_t f = mix(r ^ seed_ ^ (round * 0x9E3779B9u)) & mask;
+            uint32_t nl = r;
+            r = l ^ f;
+            l = nl;
+        }
+        x = (l << half) | r;
+    } while (x >= count_);
+    return x;
+}
+
+} // namespace ae2
@@ -0,0 +1,128 @@
+#pragma once
+/// @file Playlist.hpp
+/// @brief Ленивый источник треков: M3U-файл или каталог.
+///
+/// Список не материализуется: держим курсор перечисления, окно из
+/// kWindow ближайших элементов (Id в PathPool) и, для shuffle,
+/// разреженный индекс позиций. Память константна при любом числе треков.
+///
+/// Каталог перечисляется через FsDir (FatFS или dirent); без них
+/// open() каталога возвращает false. Подсчёт длины для shuffle идёт
+/// порциями (scanStep), а не внутри open(): таск AudioMgr не замирает на
+/// больших списках. Пока он идёт, next() отдаёт до kProvisional случайных
+/// элементов из уже посчитанных — shuffle стартует сразу; итоговая
+/// перестановка их пропускает.
+///
+/// Элементы окна заранее проверяются (probeStep: CodecDetect по
+/// заголовку) — вне hot path, пока ring полон; непроигрываемые AudioMgr
+/// пропускает без открытия декодера.
+
+#include "CodecDetect/CodecDetect.hpp"
+#include "FsAdapter/FsAdapter.hpp"
+#include "PathPool/PathPool.hpp"
+#include <cstdint>
+
+namespace ae2 {
+
+class Playlist {
+public:
+    struct Entry {
+        PathPool::Id path = PathPool::kInvalid;  ///< владеет одной ссылкой
+        bool     probed = false;  ///< probeStep уже смотрел файл
+        CodecDetect::Type codec = CodecDetect::Type::Unknown;  ///< Unknown — не открылся или не распознан
+        uint32_t index = 0;  ///< порядковый номер в воспроизведении
+    };
+
+    explicit Playlist(PathPool& pool);
+    ~Playlist() { close(); }
+
+    Playlist(const Playlist&) = delete;
+    Playlist& operator=(const Playlist&) = delete;
+
+    /// Открыть .m3u/.m3u8 или каталог. При shuffle список ещё надо один
+    /// раз пройти (scanStep), чтобы узнать длину и расставить контрольные
+    /// точки; пустой shuffle-список закрывается по концу подсчёта.
+    bool open(const char* path, bool shuffle, uint32_t seed);
+    void close();
+    [[nodiscard]] bool isOpen() const { return kind_ != Kind::None; }
+
+    /// Идёт подсчёт длины для shuffle: next() отдаёт только временные
+    /// элементы (не больше kProvisional).
+    [[nodiscard]] bool scanning() const { return scanning_; }
+    /// Пройти до budget элементов подсчёта.
+    void scanStep(uint32_t budget);
+
+    /// Забрать следующий элемент; ссылка на путь переходит вызывающему.
+    /// false при !exhausted() — элемент есть, но сейчас недоступен
+    /// (подсчёт ещё ничего не нашёл или PathPool занят очередью):
+    /// повторить позже.
+    bool next(Entry& out);
+    /// Проверить кодек одного ещё не проверенного элемента окна (открытие
+    /// и заголовок файла). false — проверять нечего.
+    bool probeStep();
+    /// Все элементы отданы — список кончился.
+    [[nodiscard]] bool exhausted() const;
+
+    /// Длина списка (0, если не считали — последовательный режим).
+    [[nodiscard]] uint32_t count() const { return count_; }
+    /// Сколько элементов уже отдано.
+    [[nodiscard]] uint32_t position() const { return played_; }
+
+    static constexpr uint32_t kWindow      = 4;
+    static constexpr uint32_t kCheckpoints = 32;
+    static constexpr uint32_t kProvisional = 4;
+
+private:
+    enum class Kind : uint8_t { None, M3u, Dir };
+
+    PathPool& pool_;
+    Kind      kind_    = Kind::None;
+    bool      shuffle_ = false;
+    uint32_t  seed_    = 0;
+
+    /* Перечислитель */
+    uint8_t   listBuf_[256]{};
+    FsAdapter list_{listBuf_, sizeof(listBuf_)};  ///< чтение M3U
+    FsDir     dir_;                                ///< перечисление каталога
+    char      base_[PathPool::kMaxPath]{};         ///< каталог для относительных путей
+    uint32_t  rawPos_  = 0;  ///< индекс следующего элемента перечислителя
+    bool      rawEof_  = false;
+    bool      scanning_ = false;  ///< shuffle: длина ещё считается
+
+    /* Упреждающая проверка окна */
+    uint8_t   probeBuf_[128]{};
+    FsAdapter probe_{probeBuf_, sizeof(probeBuf_)};
+
+    /* Отданные во время подсчёта: индексы, итоговая перестановка их пропускает */
+    uint32_t  provisional_[kProvisional]{};
+    uint32_t  nProvisional_ = 0;
+
+    /* Разреженный индекс: позиция перед элементом i*stride_ */
+    long      checkpoints_[kCheckpoints]{};
+    uint32_t  nCheckpoints_ = 0;
+    uint32_t  stride_       = 1;
+
+    uint32_t  count_    = 0;
+    uint32_t  produced_ = 0;  ///< сколько элементов поставлено в окно
+    uint32_t  played_   = 0;
+
+    /* Окно упреждения */
+    Entry     window_[kWindow]{};
+    uint32_t  winHead_  = 0;
+    uint32_t  winCount_ = 0;
+
+    long tellRaw_() const;
+    bool seekRaw_(long pos);
+    void rewindRaw_();
+    /// Строка M3U без '\n' (хвост длиннее cap - 1 отбрасывается).
+    bool readLine_(char* out, size_t cap);
+    bool readRaw_(char* out, size_t cap);
+    bool readAt_(uint32_t idx, char* out, size_t cap);
+    void addCheckpoint_(uint32_t idx, long pos);
+    void fillWindow_();
+    bool nextProvisional_(Entry& out);
+    [[nodiscard]] bool isProvisional_(uint32_t idx) const;
+    [[nodiscard]] uint32_t permute_(uint32_t i) const;
+};
+
+} // namespace ae2
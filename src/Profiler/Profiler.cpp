@@ -0,0 +1,148 @@
+/// @file Profiler.cpp
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+/* Хост — std::chrono; на МК — счётчик тактов DWT */
+#if defined(__arm__) && !defined(__linux__)
+#  include "FreeRTOS.h"
+#  define AE2_PROF_DWT 1
+#else
+#  include <chrono>
+#  define AE2_PROF_DWT 0
+#endif
+
+namespace ae2 {
+
+namespace {
+
+const char* const kNames[Profiler::kScopes] = {
+    "Decode", "Resample", "Enqueue", "Volume", "FsRefill",
+    "CodecDetect", "Mp3Duration", "DecoderOpen", "DecoderSeek",
+};
+
+#if AE2_PROFILER
+
+struct Counter {
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> min{UINT32_MAX};
+    std::atomic<uint32_t> max{0};
+    /* 64-битный atomic на M4 не lock-free: сумма — две половины, перенос
+     * после fetch_add младшей. Читатель может поймать момент переноса. */
+    std::atomic<uint32_t> totalLo{0};
+    std::atomic<uint32_t> totalHi{0};
+    std::atomic<uint32_t> hist[Profiler::kBuckets]{};
+};
+
+Counter gCounters[Profiler::kScopes];
+
+uint32_t bucketOf(uint32_t ticks) {
+    return ticks ? 32u - (uint32_t)__builtin_clz(ticks) : 0u;
+}
+
+#endif
+
+#if AE2_PROF_DWT
+volatile uint32_t* const kDemcr    = reinterpret_cast<volatile uint32_t*>(0xE000EDFCu);
+volatile uint32_t* const kDwtCtrl  = reinterpret_cast<volatile uint32_t*>(0xE0001000u);
+volatile uint32_t* const kDwtCycle = reinterpret_cast<volatile uint32_t*>(0xE0001004u);
+#endif
+
+} // namespace
+
+uint32_t Profiler::now() {
+#if AE2_PROF_DWT
+    if (!(*kDwtCtrl & 1u)) {
+        *kDemcr   |= 1u << 24;  /* TRCENA */
+        *kDwtCycle = 0;
+        *kDwtCtrl |= 1u;        /* CYCCNTENA */
+    }
+    return *kDwtCycle;
+#else
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+uint32_t Profiler::tickHz() {
+#if AE2_PROF_DWT
+    return configCPU_CLOCK_HZ;
+#else
+    return 1000000000u;
+#endif
+}
+
+const char* Profiler::name(Id id) {
+    return (uint32_t)id < kScopes ? kNames[(uint32_t)id] : "?";
+}
+
+uint32_t Profiler::Stats::percentileBound(uint32_t p) const {
+    if (count == 0) return 0;
+    uint64_t want = ((uint64_t)count * p + 99) / 100;
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < kBuckets; ++b) {
+        seen += hist[b];
+        if (seen < want) continue;
+        if (b == 0) return 0;
+        return b >= 32 ? max : std::min<uint32_t>((1u << b) - 1, max);
+    }
+    return max;
+}
+
+#if AE2_PROFILER
+
+void Profiler::record(Id id, uint32_t ticks) {
+    if ((uint32_t)id >= kScopes) return;
+    Counter& c = gCounters[(uint32_t)id];
+    c.count.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t lo = c.totalLo.fetch_add(ticks, std::memory_order_relaxed);
+    if (lo + ticks < lo) c.totalHi.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t m = c.min.load(std::memory_order_relaxed);
+    while (ticks < m && !c.min.compare_exchange_weak(m, ticks, std::memory_order_relaxed)) {}
+    m = c.max.load(std::memory_order_relaxed);
+    while (ticks > m && !c.max.compare_exchange_weak(m, ticks, std::memory_order_relaxed)) {}
+
+    c.hist[bucketOf(ticks)].fetch_add(1, std::memory_order_relaxed);
+}
+
+Profiler::Stats Profiler::stats(Id id) {
+    Stats s;
+    if ((uint32_t)id >= kScopes) return s;
+    const Counter& c = gCounters[(uint32_t)id];
+    s.name  = kNames[(uint32_t)id];
+    s.count = c.count.load(std::memory_order_relaxed);
+    s.min   = s.count ? c.min.load(std::memory_order_relaxed) : 0;
+    s.max   = c.max.load(std::memory_order_relaxed);
+    s.total = ((uint64_t)c.totalHi.load(std::memory_order_relaxed) << 32) |
+              c.totalLo.load(std::memory_order_relaxed);
+    for (uint32_t b = 0; b < kBuckets; ++b) s.hist[b] = c.hist[b].load(std::memory_order_relaxed);
+    return s;
+}
+
+void Profiler::reset() {
+    for (Counter& c : gCounters) {
+        c.count.store(0, std::memory_order_relaxed);
+        c.min.store(UINT32_MAX, std::memory_order_relaxed);
+        c.max.store(0, std::memory_order_relaxed);
+        c.totalLo.store(0, std::memory_order_relaxed);
+        c.totalHi.store(0, std::memory_order_relaxed);
+        for (auto& h : c.hist) h.store(0, std::memory_order_relaxed);
+    }
+}
+
+#else
+
+void Profiler::record(Id, uint32_t) {}
+Profiler::Stats Profiler::stats(Id id) {
+    Stats s;
+    s.name = name(id);
+    return s;
+}
+void Profiler::reset() {}
+
+#endif
+
+} // namespace ae2
@@ -0,0 +1,99 @@
+#pragma once
+/// @file Profiler.hpp
+/// @brief Встроенный профайлер: счётчики и log2-гистограммы по скоупам.
+///
+/// Включается -DAE2_PROFILER=1. Тогда APROF_SCOPE/BEGIN/END в AudioMgr
+/// пишут сюда (если прошивка не подключила свой AudioProfiler.hpp), а
+/// AE2_PROF_* — скоупы за пределами AudioMgr: FsAdapter, CodecDetect,
+/// Mp3Duration, open/seek декодера. Без флага всё компилируется в ничто.
+///
+/// Запись lock-free: атомарные счётчики на скоуп, min/max через CAS, без
+/// блокировок и аллокаций — можно из любого таска. Время в тиках:
+/// на хосте — наносекунды, на Cortex-M — такты DWT->CYCCNT (tickHz()).
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef AE2_PROFILER
+#  define AE2_PROFILER 0
+#endif
+
+namespace ae2 {
+
+class Profiler {
+public:
+    enum class Id : uint8_t {
+        Decode,       ///< decode() порции (AudioMgr)
+        Resample,
+        Enqueue,      ///< запись в ring AudioHw
+        Volume,
+        FsRefill,     ///< fread буфера FsAdapter — I/O карты
+        CodecDetect,
+        Mp3Duration,
+        DecoderOpen,  ///< включает разбор заголовков и оценку длительности
+        DecoderSeek,
+        Count
+    };
+    static constexpr uint32_t kScopes  = (uint32_t)Id::Count;
+    /// Корзина b: длительность в [2^(b-1), 2^b) тиков; 0 — ровно 0.
+    static constexpr uint32_t kBuckets = 33;
+
+    static constexpr bool kEnabled = AE2_PROFILER != 0;
+
+    struct Stats {
+        const char* name  = nullptr;
+        uint32_t    count = 0;
+        uint32_t    min   = 0;
+        uint32_t    max   = 0;
+        uint64_t    total = 0;
+        uint32_t    hist[kBuckets]{};
+
+        [[nodiscard]] uint32_t mean() const { return count ? (uint32_t)(total / count) : 0; }
+        /// Верхняя граница корзины, в которую попадает перцентиль p (0..100).
+        [[nodiscard]] uint32_t percentileBound(uint32_t p) const;
+    };
+
+    /// Текущее время в тиках. На Cortex-M первый вызов включает DWT.
+    static uint32_t now();
+    /// Частота тиков now().
+    static uint32_t tickHz();
+
+    static void record(Id id, uint32_t ticks);
+
+    /// Снимок скоупа. Читатель может увидеть count и total из разных
+    /// записей — для диагностики достаточно.
+    [[nodiscard]] static Stats stats(Id id);
+    static void reset();
+    [[nodiscard]] static const char* name(Id id);
+
+    /// Отмеряет время жизни объекта.
+    class Scope {
+    public:
+        explicit Scope(Id id) : id_(id), t0_(now()) {}
+        ~Scope() { record(id_, now() - t0_); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        Id       id_;
+        uint32_t t0_;
+    };
+};
+
+} // namespace ae2
+
+#if AE2_PROFILER
+#  define AE2_PROF_SCOPE(name) ::ae2::Profiler::Scope aeProfScope_##name(::ae2::Profiler::Id::name)
+#  define AE2_PROF_BEGIN(name) const uint32_t aeProfT0_##name = ::ae2::Profiler::now()
+#  define AE2_PROF_END(name) \
+       ::ae2::Profiler::record(::ae2::Profiler::Id::name, ::ae2::Profiler::now() - aeProfT0_##name)
+/* Профайлер прошивки, если подключён раньше, имеет приоритет */
+#  ifndef APROF_SCOPE
+#    define APROF_SCOPE(name) AE2_PROF_SCOPE(name)
+#    define APROF_BEGIN(name) AE2_PROF_BEGIN(name)
+#    define APROF_END(name)   AE2_PROF_END(name)
+#  endif
+#else
+#  define AE2_PROF_SCOPE(name) ((void)0)
+#  define AE2_PROF_BEGIN(name) ((void)0)
+#  define AE2_PROF_END(name)   ((void)0)
+#endif
@@ -0,0 +1,242 @@
+/// @file Render.cpp
+/// @brief Офлайн-рендер и его C-обёртки (отдельный объект — линкуется,
+///        только если используется).
+#include "AudioEngineV2/Render.hpp"
+#include "AudioEngineV2/AudioEngine_C.h"
+#include "AudioMgr/AudioCodecs.hpp"
+#include "AudioMgr/Volume.hpp"
+#include "CodecDetect/CodecDetect.hpp"
+#include "FsAdapter/FsAdapter.hpp"
+#include "Resampler/Resampler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+/* Хост — std::chrono; на МК — тики FreeRTOS */
+#if defined(__arm__) && !defined(__linux__)
+#  include "FreeRTOS.h"
+#  include "task.h"
+#else
+#  include <chrono>
+#endif
+
+namespace ae2 {
+
+static_assert(sizeof(FsAdapter) <= 1152, "fsMem_ слишком мал для FsAdapter");
+static_assert(sizeof(Resampler) <= 32, "resamplerMem_ слишком мал для Resampler");
+
+namespace {
+
+uint64_t nowUs() {
+#if defined(__arm__) && !defined(__linux__)
+    return (uint64_t)xTaskGetTickCount() * 1000000u / configTICK_RATE_HZ;
+#else
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void put16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+void put32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+/// Заголовок WAV PCM 16 бит моно; dataBytes — размер чанка data.
+void wavHeader(uint8_t (&h)[44], uint32_t rate, uint32_t dataBytes) {
+    std::memcpy(h, "RIFF", 4);      put32(h + 4, 36 + dataBytes);
+    std::memcpy(h + 8, "WAVEfmt ", 8);
+    put32(h + 16, 16);              put16(h + 20, 1);   /* PCM */
+    put16(h + 22, 1);               put32(h + 24, rate);
+    put32(h + 28, rate * 2);        put16(h + 32, 2);
+    put16(h + 34, 16);
+    std::memcpy(h + 36, "data", 4); put32(h + 40, dataBytes);
+}
+
+struct WavSink {
+    FILE*    f     = nullptr;
+    uint32_t bytes = 0;
+    static bool write(void* ctx, const s16* pcm, uint32_t n) {
+        auto* w = static_cast<WavSink*>(ctx);
+        /* WAV little-endian — как s16 на всех целевых платформах */
+        if (std::fwrite(pcm, sizeof(s16), n, w->f) != n) return false;
+        w->bytes += n * (uint32_t)sizeof(s16);
+        return true;
+    }
+};
+
+struct MemSink {
+    s16*     buf = nullptr;
+    uint32_t cap = 0;
+    uint32_t len = 0;
+    static bool write(void* ctx, const s16* pcm, uint32_t n) {
+        auto* m = static_cast<MemSink*>(ctx);
+        uint32_t k = std::min(n, m->cap - m->len);
+        std::memcpy(m->buf + m->len, pcm, k * sizeof(s16));
+        m->len += k;
+        return k == n;
+    }
+};
+
+} // namespace
+
+Render::Render() {
+    codecs_    = new (codecsMem_) AudioCodecs();
+    fs_        = new (fsMem_) FsAdapter(fsBuf_, sizeof(fsBuf_));
+    resampler_ = new (resamplerMem_) Resampler();
+}
+
+Render::~Render() {
+    codecs_->~AudioCodecs();
+    fs_->~FsAdapter();
+    resampler_->~Resampler();
+}
+
+bool Render::renderTrack_(const char* path, const Options& opt, Sink sink, Stats& st) {
+    if (!fs_->open(path)) { st.failed++; return true; }
+
+    DecoderEnv env;
+    env.type        = CodecDetect::detect(*fs_);
+    env.scratch     = ScratchArena{scratch_, sizeof(scratch_)};
+    env.rawRate     = opt.rawG711Rate;
+    env.rawChannels = opt.rawG711Channels;
+    DecoderBase* dec = codecs_->emplace(env);
+    if (!dec || !dec->open(*fs_)) {
+        codecs_->reset();
+        fs_->close();
+        st.failed++;
+        return true;
+    }
+
+    bool ok = true;
+    for (;;) {
+        uint32_t n = codecs_->decode(inBuf_, kInChunk);
+        if (n == 0 && dec->skipping()) continue;  /* мусор в потоке */
+        if (n == 0) break;
+        st.inSamples += n;
+        applyVolume(inBuf_, n, opt.volume);
+
+        /* Порции входа, дающие не больше kOutChunk выхода */
+        resampler_->setRates(codecs_->sampleRate(), opt.outRate);
+        uint32_t step = std::max<uint32_t>(resampler_->maxInput(kOutChunk), 1);
+        for (uint32_t pos = 0; pos < n && ok; ) {
+            uint32_t take = std::min(step, n - pos);
+            uint32_t out = resampler_->process(inBuf_ + pos, take, outBuf_, kOutChunk, nullptr, 0);
+            ok = sink.write(sink.ctx, outBuf_, out);
+            st.outSamples += out;
+            pos += take;
+        }
+        if (!ok) break;
+    }
+    codecs_->reset();
+    fs_->close();
+    st.tracks++;
+    return ok;
+}
+
+bool Render::renderQueue(const char* const* paths, uint32_t count, const Options& opt,
+                         Sink sink, Stats* stats) {
+    Stats st;
+    uint64_t t0 = nowUs();
+    resampler_->setAlgorithm(opt.linear ? Resampler::Algorithm::Linear
+                                        : Resampler::Algorithm::Nearest);
+    bool ok = (sink.write != nullptr && opt.outRate > 0);
+    for (uint32_t i = 0; ok && i < count; ++i) {
+        if (paths[i]) ok = renderTrack_(paths[i], opt, sink, st);
+    }
+    st.wallUs  = nowUs() - t0;
+    st.audioUs = opt.outRate ? st.outSamples * 1000000u / opt.outRate : 0;
+    if (stats) *stats = st;
+    return ok && st.failed == 0;
+}
+
+bool Render::renderToWav(const char* const* paths, uint32_t count, const char* wavPath,
+                         const Options& opt, Stats* stats) {
+    WavSink w;
+    w.f = std::fopen(wavPath, "wb");
+    if (!w.f) return false;
+    uint8_t h[44];
+    wavHeader(h, opt.outRate, 0);
+    bool ok = std::fwrite(h, 1, sizeof(h), w.f) == sizeof(h);
+    if (ok) ok = renderQueue(paths, count, opt, Sink{&WavSink::write, &w}, stats);
+    /* Размеры известны только в конце — переписываем заголовок */
+    wavHeader(h, opt.outRate, w.bytes);
+    if (std::fseek(w.f, 0, SEEK_SET) != 0 || std::fwrite(h, 1, sizeof(h), w.f) != sizeof(h)) ok = false;
+    if (std::fclose(w.f) != 0) ok = false;
+    return ok;
+}
+
+bool Render::renderToMemory(const char* const* paths, uint32_t count, s16* buf, uint32_t cap,
+                            uint32_t* written, const Options& opt, Stats* stats) {
+    MemSink m;
+    m.buf = buf;
+    m.cap = buf ? cap : 0;
+    bool ok = renderQueue(paths, count, opt, Sink{&MemSink::write, &m}, stats);
+    if (written) *written = m.len;
+    return ok;
+}
+
+} // namespace ae2
+
+/* ═══ C API ═══ */
+
+using ae2::Render;
+
+namespace {
+
+/* Один экземпляр на процесс: ~26 КБ, не реентерабельно */
+Render& cRender() {
+    static Render r;
+    return r;
+}
+
+Render::Options cOptions(const ae_render_options_t* opt) {
+    Render::Options o;
+    if (!opt) return o;
+    o.outRate         = opt->out_rate;
+    o.volume          = opt->volume;
+    o.linear          = opt->resample != AE_RESAMPLE_NEAREST;
+    o.rawG711Rate     = opt->g711_rate;
+    o.rawG711Channels = opt->g711_channels;
+    return o;
+}
+
+void cStats(const Render::Stats& s, ae_render_stats_t* out) {
+    if (!out) return;
+    out->tracks      = s.tracks;
+    out->failed      = s.failed;
+    out->in_samples  = s.inSamples;
+    out->out_samples = s.outSamples;
+    out->audio_ms    = (uint32_t)(s.audioUs / 1000);
+    out->wall_ms     = (uint32_t)(s.wallUs / 1000);
+    out->x_realtime  = s.xRealtime();
+}
+
+} // namespace
+
+void aeRenderOptionsInit(ae_render_options_t* opt) {
+    if (!opt) return;
+    const Render::Options o;
+    opt->out_rate      = o.outRate;
+    opt->volume        = o.volume;
+    opt->resample      = o.linear ? AE_RESAMPLE_LINEAR : AE_RESAMPLE_NEAREST;
+    opt->g711_rate     = o.rawG711Rate;
+    opt->g711_channels = o.rawG711Channels;
+}
+
+bool aeRenderToWav(const char* const* paths, uint32_t count, const char* wav_path,
+                   const ae_render_options_t* opt, ae_render_stats_t* st) {
+    Render::Stats s;
+    bool ok = cRender().renderToWav(paths, count, wav_path, cOptions(opt), &s);
+    cStats(s, st);
+    return ok;
+}
+
+bool aeRenderToMemory(const char* const* paths, uint32_t count, int16_t* buf, uint32_t cap,
+                      const ae_render_options_t* opt, uint32_t* written, ae_render_stats_t* st) {
+    Render::Stats s;
+    bool ok = cRender().renderToMemory(paths, count, buf, cap, written, cOptions(opt), &s);
+    cStats(s, st);
+    return ok;
+}
@@ -13,6 +13,7 @@ void Resampler::setRates(uint32_t inRate, uint32_t outRate) {
     /* Предвычисляем Q16 шаг: сколько входных сэмплов (×2^16) приходится на
      * один выходной сэмпл. Используется в process() вместо умножения double. */
     phaseStep_ = (uint32_t)(((uint64_t)inRate << 16) / outRate);
+    intRatio_  = (outRate > inRate && outRate % inRate == 0) ? outRate / inRate : 0;
 }
 
 uint32_t Resampler::outputLength(uint32_t inLen) const {
@@ -56,6 +57,29 @@ static inline void resampleNearest_(const s16* src, uint32_t srcLen,
     }
 }
 
+/* ── Вспомогательная: целое отношение k, k выходных на входной ──
+ * Положение (i, j) — входной сэмпл и номер выхода внутри него — переносится
+ * между сегментами. Дробь j/k в Q15, как frac в resampleLinear_. */
+static inline void upsampleInt_(const s16* src, uint32_t srcLen,
+                                s16* dst, uint32_t count,
+                                uint32_t& i, uint32_t& j,
+                                uint32_t k, bool linear) {
+    const int32_t fracStep = (int32_t)(32768u / k);
+    for (uint32_t n = 0; n < count; ++n) {
+        const int32_t a = src[i];
+        if (linear && i + 1 < srcLen) {
+            const int32_t diff = (int32_t)src[i + 1] - a;
+            dst[n] = (s16)(a + ((diff * ((int32_t)j * fracStep)) >> 15));
+        } else {
+            dst[n] = (s16)a;
+        }
+        if (++j == k) {
+            j = 0;
+            if (i + 1 < srcLen) ++i;
+        }
+    }
+}
+
 uint32_t Resampler::process(const s16* src, uint32_t srcLen,
                             s16* dst1, uint32_t dst1Cap,
                             s16* dst2, uint32_t dst2Cap) const {
@@ -82,7 +106,14 @@ uint32_t Resampler::process(const s16* src, uint32_t srcLen,
     uint32_t seg2 = outTotal - seg1;
     uint64_t phase = 0;
 
-    if (alg_ == Algorithm::Linear) {
+    if (intRatio_ != 0) {
+        const bool linear = (alg_ == Algorithm::Linear);
+        uint32_t i = 0;
+        uint32_t j = 0;
+        upsampleInt_(src, srcLen, dst1, seg1, i, j, intRatio_, linear);
+        if (seg2 > 0 && dst2)
+            upsampleInt_(src, srcLen, dst2, seg2, i, j, intRatio_, linear);
+    } else if (alg_ == Algorithm::Linear) {
         resampleLinear_(src, srcLen, dst1, seg1, phase, phaseStep_);
         if (seg2 > 0 && dst2)
             resampleLinear_(src, srcLen, dst2, seg2, phase, phaseStep_);
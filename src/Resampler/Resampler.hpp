@@ -32,6 +32,9 @@ private:
      *  phaseStep_ = (inRate << 16) / outRate.
      *  Предвычисляется в setRates(), устраняет double из горячего пути. */
     uint32_t phaseStep_ = 65536u;  /* 44100/44100 * 2^16 = 1.0 */
+    /** outRate = inRate × intRatio_ (0 — отношение нецелое). Тогда на каждый
+     *  входной сэмпл ровно intRatio_ выходных, без дрейфа фазы Q16. */
+    uint32_t intRatio_  = 0;
     Algorithm alg_ = Algorithm::Linear;
 };
 
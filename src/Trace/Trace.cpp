@@ -0,0 +1,178 @@
+/// @file Trace.cpp
+#include "Trace.hpp"
+#include "Profiler/Profiler.hpp"
+
+#include <atomic>
+#include <cstdio>
+
+namespace ae2 {
+
+namespace {
+
+const char* const kNames[(uint32_t)Trace::Ev::Count] = {
+    "tick", "cmd", "decode", "resample", "wait", "fs_read", "open", "ring", "event",
+};
+
+#if AE2_TRACE
+
+/* В порядке AudioMgr::Cmd::Type и AudioMgr::Event::Type — AudioMgr.cpp
+ * проверяет количество static_assert'ами */
+const char* const kCmdText[Trace::kCommandNames] = {
+    "Play", "Pause", "Stop", "AddFile", "AddFileFront", "ClearQueue",
+    "Seek", "Forward", "Rewind", "Activate", "Deactivate",
+    "SetVolume", "SetSampleRate", "VolumeChanged", "RemoveQueueItem",
+    "PlayPlaylist", "SetRawFormat", "SetRatePolicy", "SetPcmCache",
+    "DropPcmCache",
+};
+const char* const kEventText[Trace::kEventNames] = {
+    "TrackStarted", "TrackEnded", "QueueEnded", "SourceSwitched",
+    "Underrun", "QueueChanged", "PositionTick",
+};
+
+/// Ключ value в args Chrome; nullptr — value не выводится.
+const char* valueKey(Trace::Ev ev, Trace::Phase ph) {
+    switch (ev) {
+    case Trace::Ev::Decode:   return ph == Trace::Phase::End ? "samples" : nullptr;
+    case Trace::Ev::Resample: return ph == Trace::Phase::End ? "out" : nullptr;
+    case Trace::Ev::Wait:     return ph == Trace::Phase::Begin ? "want" : "got";
+    case Trace::Ev::FsRead:   return ph == Trace::Phase::End ? "bytes" : nullptr;
+    case Trace::Ev::RingFill: return "fill";
+    case Trace::Ev::Event:    return "value";
+    default:                  return nullptr;
+    }
+}
+
+Trace::Record         gRing[Trace::kCapacity];
+std::atomic<uint32_t> gHead{0};
+std::atomic<bool>     gOn{true};
+
+bool writeFile(void* ctx, const char* data, uint32_t len) {
+    return std::fwrite(data, 1, len, static_cast<FILE*>(ctx)) == len;
+}
+
+#endif
+
+} // namespace
+
+const char* Trace::name(Ev ev) {
+    return (uint32_t)ev < (uint32_t)Ev::Count ? kNames[(uint32_t)ev] : "?";
+}
+
+#if AE2_TRACE
+
+void Trace::record(Ev ev, Phase phase, uint8_t arg, uint32_t value) {
+    if (!gOn.load(std::memory_order_relaxed)) return;
+    uint32_t i = gHead.fetch_add(1, std::memory_order_relaxed);
+    Record& r = gRing[i & (kCapacity - 1)];
+    r.ts    = Profiler::now();
+    r.value = value;
+    r.ev    = (uint8_t)ev;
+    r.phase = (uint8_t)phase;
+    r.arg   = arg;
+    r.pad   = 0;
+}
+
+void Trace::setEnabled(bool on) { gOn.store(on, std::memory_order_relaxed); }
+bool Trace::enabled() { return gOn.load(std::memory_order_relaxed); }
+void Trace::clear() { gHead.store(0, std::memory_order_relaxed); }
+
+uint32_t Trace::total() { return gHead.load(std::memory_order_relaxed); }
+
+uint32_t Trace::size() {
+    uint32_t n = total();
+    return n < kCapacity ? n : kCapacity;
+}
+
+bool Trace::exportChrome(WriteFn write, void* ctx) {
+    if (!write) return false;
+    /* Запись стоит, пока обходим кольцо; писатель, уже взявший слот,
+     * может успеть его дописать — для диагностики допустимо */
+    const bool wasOn = gOn.exchange(false, std::memory_order_relaxed);
+    const uint32_t head  = gHead.load(std::memory_order_relaxed);
+    const uint32_t count = head < kCapacity ? head : kCapacity;
+    const uint32_t hz    = Profiler::tickHz();
+
+    char line[192];
+    int len = std::snprintf(line, sizeof(line),
+        "{\"traceEvents\":[\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"AudioMgr\"}}");
+    bool ok = write(ctx, line, (uint32_t)len);
+
+    uint32_t depth[(uint32_t)Ev::Count]{};
+    uint64_t ts64 = 0;
+    uint32_t prev = count ? gRing[(head - count) & (kCapacity - 1)].ts : 0;
+
+    for (uint32_t k = 0; ok && k < count; ++k) {
+        const Record& r = gRing[(head - count + k) & (kCapacity - 1)];
+        if (r.ev >= (uint8_t)Ev::Count) continue;
+        /* Разворот 32-битной метки; знаковая разница — на случай двух
+         * писателей, записавших метки не в порядке слотов */
+        int32_t d = (int32_t)(r.ts - prev);
+        prev = r.ts;
+        ts64 = (d < 0 && (uint64_t)-(int64_t)d > ts64) ? 0 : ts64 + d;
+
+        const Ev    ev = (Ev)r.ev;
+        const Phase ph = (Phase)r.phase;
+        const char* code = "i";
+        switch (ph) {
+        case Phase::Begin:   code = "B"; depth[r.ev]++; break;
+        case Phase::End:
+            if (depth[r.ev] == 0) continue;  /* начало перезаписано */
+            code = "E"; depth[r.ev]--; break;
+        case Phase::Instant: code = "i"; break;
+        case Phase::Counter: code = "C"; break;
+        }
+
+        const char* nm = kNames[r.ev];
+        if (ev == Ev::Command && r.arg < kCommandNames) nm = kCmdText[r.arg];
+        if (ev == Ev::Event   && r.arg < kEventNames)   nm = kEventText[r.arg];
+
+        /* Микросекунды от первой записи без double: целая часть + нс */
+        const uint64_t whole = ts64 / hz;
+        const uint64_t rem   = ts64 % hz;
+        const uint32_t us    = (uint32_t)(whole * 1000000u + rem * 1000000u / hz);
+        const uint32_t frac  = (uint32_t)(rem * 1000000000u / hz % 1000u);
+
+        len = std::snprintf(line, sizeof(line),
+            ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%s\",\"ts\":%lu.%03u,\"pid\":1,\"tid\":1",
+            nm, kNames[r.ev], code, (unsigned long)us, (unsigned)frac);
+        if (ph == Phase::Instant)
+            len += std::snprintf(line + len, sizeof(line) - len, ",\"s\":\"t\"");
+        if (const char* key = valueKey(ev, ph))
+            len += std::snprintf(line + len, sizeof(line) - len,
+                                 ",\"args\":{\"%s\":%lu}", key, (unsigned long)r.value);
+        len += std::snprintf(line + len, sizeof(line) - len, "}");
+        ok = write(ctx, line, (uint32_t)len);
+    }
+
+    if (ok) {
+        len = std::snprintf(line, sizeof(line), "\n],\"displayTimeUnit\":\"ms\"}\n");
+        ok = write(ctx, line, (uint32_t)len);
+    }
+    gOn.store(wasOn, std::memory_order_relaxed);
+    return ok;
+}
+
+bool Trace::exportChromeFile(const char* path) {
+    if (!path) return false;
+    FILE* f = std::fopen(path, "w");
+    if (!f) return false;
+    bool ok = exportChrome(writeFile, f);
+    if (std::fclose(f) != 0) ok = false;
+    return ok;
+}
+
+#else
+
+void Trace::record(Ev, Phase, uint8_t, uint32_t) {}
+void Trace::setEnabled(bool) {}
+bool Trace::enabled() { return false; }
+void Trace::clear() {}
+uint32_t Trace::total() { return 0; }
+uint32_t Trace::size() { return 0; }
+bool Trace::exportChrome(WriteFn, void*) { return false; }
+bool Trace::exportChromeFile(const char*) { return false; }
+
+#endif
+
+} // namespace ae2
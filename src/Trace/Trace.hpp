@@ -0,0 +1,128 @@
+#pragma once
+/// @file Trace.hpp
+/// @brief Трасса конвейера: кольцо бинарных событий с метками времени и
+///        экспорт в Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+///
+/// Включается -DAE2_TRACE=1. Тогда AE2_TRACE_* в AudioMgr и FsAdapter
+/// пишут в статическое кольцо на AE2_TRACE_EVENTS записей (степень двойки,
+/// по умолчанию 1024 × 12 байт): начало/конец тика, decode с числом
+/// сэмплов, ожидание acquireWrite, заполнение ring, чтение карты, команды,
+/// события AudioMgr (смена источника, underrun, начало/конец трека).
+/// Старые записи перезаписываются — в кольце всегда последние N событий.
+/// Без флага макросы компилируются в ничто, кольцо не занимает RAM.
+///
+/// Запись без блокировок: слот берётся атомарным инкрементом головы, время —
+/// Profiler::now() (наносекунды на хосте, такты DWT на Cortex-M).
+/// Метка 32-битная: экспорт разворачивает переполнения по порядку записей,
+/// поэтому пауза между соседними событиями не должна превышать период
+/// счётчика (4,29 с на хосте, ~15 с на 288 МГц).
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef AE2_TRACE
+#  define AE2_TRACE 0
+#endif
+#ifndef AE2_TRACE_EVENTS
+#  define AE2_TRACE_EVENTS 1024
+#endif
+
+namespace ae2 {
+
+class Trace {
+public:
+    enum class Ev : uint8_t {
+        Tick,      ///< runOnce: команды + тик конвейера
+        Command,   ///< arg — AudioMgr::Cmd::Type
+        Decode,    ///< value в конце — сэмплов
+        Resample,  ///< value в конце — выходных сэмплов
+        Wait,      ///< acquireWrite: value в начале — запрошено, в конце — выдано
+        FsRead,    ///< fread FsAdapter: value в конце — байт
+        Open,      ///< открытие декодера (заголовки, оценка длительности)
+        RingFill,  ///< счётчик: сэмплов в ring перед тиком
+        Event,     ///< мгновенное: arg — AudioMgr::Event::Type, value — полезная нагрузка
+        Count
+    };
+    enum class Phase : uint8_t { Begin, End, Instant, Counter };
+
+    struct Record {
+        uint32_t ts;     ///< Profiler::now()
+        uint32_t value;
+        uint8_t  ev;     ///< Ev
+        uint8_t  phase;  ///< Phase
+        uint8_t  arg;
+        uint8_t  pad;
+    };
+    static_assert(sizeof(Record) == 12, "Record: 12 байт на событие");
+
+    static constexpr uint32_t kCapacity = AE2_TRACE_EVENTS;
+    static_assert((kCapacity & (kCapacity - 1)) == 0, "AE2_TRACE_EVENTS — степень двойки");
+    static constexpr bool kEnabled = AE2_TRACE != 0;
+    /// Байт RAM под кольцо (0 без AE2_TRACE).
+    static constexpr uint32_t kBytes = kEnabled ? kCapacity * (uint32_t)sizeof(Record) : 0;
+
+    /// Имена для arg: число команд AudioMgr::Cmd и событий AudioMgr::Event.
+    static constexpr uint32_t kCommandNames = 20;
+    static constexpr uint32_t kEventNames   = 7;
+
+    static void record(Ev ev, Phase phase, uint8_t arg = 0, uint32_t value = 0);
+
+    /// Остановить/возобновить запись (кольцо сохраняется). Экспорт
+    /// останавливает запись сам на время обхода.
+    static void setEnabled(bool on);
+    [[nodiscard]] static bool enabled();
+    static void clear();
+    /// Событий в кольце (≤ kCapacity) и всего записано с clear().
+    [[nodiscard]] static uint32_t size();
+    [[nodiscard]] static uint32_t total();
+
+    /// Приёмник текста экспорта. false — ошибка записи, экспорт прерывается.
+    using WriteFn = bool (*)(void* ctx, const char* data, uint32_t len);
+
+    /// Выгрузить кольцо в формате Chrome trace (JSON Object Format) порциями
+    /// по строке на событие. Концы без начала (начало уже перезаписано)
+    /// отбрасываются. Пустая трасса — валидный JSON без событий.
+    /// false — ошибка записи или сборка без AE2_TRACE.
+    static bool exportChrome(WriteFn write, void* ctx);
+    /// То же в файл (fopen).
+    static bool exportChromeFile(const char* path);
+
+    [[nodiscard]] static const char* name(Ev ev);
+
+    /// Begin в конструкторе, End с value в деструкторе.
+    class Span {
+    public:
+        explicit Span(Ev ev, uint8_t arg = 0, uint32_t value = 0) : ev_(ev), arg_(arg) {
+            record(ev, Phase::Begin, arg, value);
+        }
+        ~Span() { record(ev_, Phase::End, arg_, value); }
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+        uint32_t value = 0;  ///< уходит в End
+    private:
+        Ev      ev_;
+        uint8_t arg_;
+    };
+};
+
+} // namespace ae2
+
+#if AE2_TRACE
+#  define AE2_TRACE_SPAN(var, ev, ...) ::ae2::Trace::Span var(::ae2::Trace::Ev::ev, ##__VA_ARGS__)
+#  define AE2_TRACE_SET(var, v)        ((var).value = (uint32_t)(v))
+#  define AE2_TRACE_BEGIN(ev, arg, v) \
+       ::ae2::Trace::record(::ae2::Trace::Ev::ev, ::ae2::Trace::Phase::Begin, (uint8_t)(arg), (uint32_t)(v))
+#  define AE2_TRACE_END(ev, arg, v) \
+       ::ae2::Trace::record(::ae2::Trace::Ev::ev, ::ae2::Trace::Phase::End, (uint8_t)(arg), (uint32_t)(v))
+#  define AE2_TRACE_INSTANT(ev, arg, v) \
+       ::ae2::Trace::record(::ae2::Trace::Ev::ev, ::ae2::Trace::Phase::Instant, (uint8_t)(arg), (uint32_t)(v))
+#  define AE2_TRACE_COUNTER(ev, v) \
+       ::ae2::Trace::record(::ae2::Trace::Ev::ev, ::ae2::Trace::Phase::Counter, 0, (uint32_t)(v))
+#else
+#  define AE2_TRACE_SPAN(var, ev, ...) ((void)0)
+#  define AE2_TRACE_SET(var, v)        ((void)0)
+#  define AE2_TRACE_BEGIN(ev, arg, v)  ((void)0)
+#  define AE2_TRACE_END(ev, arg, v)    ((void)0)
+#  define AE2_TRACE_INSTANT(ev, arg, v) ((void)0)
+#  define AE2_TRACE_COUNTER(ev, v)     ((void)0)
+#endif
@@ -0,0 +1,88 @@
+/// @file AllocGuardTest.cpp
+/// @brief ae2_test_alloc: перехват operator new/delete при AE2_ALLOC_GUARD=1.
+///
+/// AllocGuard.cpp собирается прямо в тест с включённым флагом — библиотеке
+/// он для этого не нужен. Проверяются все формы new (обычная, [],
+/// nothrow, выровненная) внутри Scope и тишина вне его. Код возврата —
+/// число проваленных проверок.
+#include "Check.hpp"
+#include "AllocGuard/AllocGuard.hpp"
+
+#include <cstdint>
+#include <new>
+
+#if !AE2_ALLOC_GUARD
+#  error "ae2_test_alloc requires AE2_ALLOC_GUARD=1"
+#endif
+
+using namespace ae2;
+
+namespace {
+
+/// Указатель уходит наружу: пару new/delete нельзя выбросить оптимизатором.
+void* volatile gSink = nullptr;
+template<typename T> T* keep(T* p) { gSink = p; return p; }
+
+struct alignas(64) Wide {
+    uint8_t bytes[100];
+};
+
+/// new/delete вне Scope не считаются.
+void testOutsideScope() {
+    AllocGuard::resetStats();
+    delete keep(new int(1));
+    delete[] keep(new char[16]);
+    CHECK(AllocGuard::stats().allocs == 0);
+}
+
+/// Каждая форма new внутри Scope — одно нарушение со своим размером.
+void testInsideScope() {
+    AllocGuard::resetStats();
+    {
+        AllocGuard::Scope s;
+        int* a = keep(new int(1));
+        CHECK(AllocGuard::stats().lastBytes == sizeof(int));
+        char* b = keep(new char[24]);
+        CHECK(AllocGuard::stats().lastBytes == 24);
+        int* c = keep(new (std::nothrow) int(2));
+        delete a;
+        delete[] b;
+        delete c;
+    }
+    const auto st = AllocGuard::stats();
+    CHECK(st.allocs == 3);
+    CHECK(st.bytes == 2 * sizeof(int) + 24);
+    CHECK(st.scopes == 1);
+}
+
+/// Выровненный new тоже перехвачен, выравнивание соблюдено.
+void testAligned() {
+    AllocGuard::resetStats();
+    {
+        AllocGuard::Scope s;
+        Wide* w = keep(new Wide{});
+        Wide* v = keep(new Wide[3]);
+        Wide* n = keep(new (std::nothrow) Wide{});
+        CHECK(reinterpret_cast<uintptr_t>(w) % alignof(Wide) == 0);
+        CHECK(reinterpret_cast<uintptr_t>(v) % alignof(Wide) == 0);
+        CHECK(n && reinterpret_cast<uintptr_t>(n) % alignof(Wide) == 0);
+        w->bytes[99] = v[2].bytes[99] = 1;  /* блок целиком наш */
+        delete w;
+        delete[] v;
+        delete n;
+    }
+    const auto st = AllocGuard::stats();
+    CHECK(st.allocs == 3);
+    CHECK(st.bytes >= 5 * sizeof(Wide));
+}
+
+} // namespace
+
+int main() {
+    testOutsideScope();
+    testInsideScope();
+    testAligned();
+
+    std::printf("ae2_test_alloc: %d failure(s)\n", test::gFailures);
+    return test::gFailures;
+}
@@ -0,0 +1,20 @@
+#pragma once
+/// @file Check.hpp
+/// @brief Проверки хост-тестов: без фреймворка, провал — строка в stderr
+///        и счётчик; main возвращает число провалов.
+
+#include <cstdio>
+
+namespace ae2::test {
+
+inline int gFailures = 0;
+
+} // namespace ae2::test
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ae2::test::gFailures++;                                              \
+        }                                                                        \
+    } while (0)
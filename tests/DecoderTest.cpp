@@ -0,0 +1,160 @@
+/// @file DecoderTest.cpp
+/// @brief ae2_test_decoders: декодеры напрямую, без AudioMgr.
+///
+///   ae2_test_decoders [WORKDIR]
+///
+/// Декодер создаётся через CodecSet и гоняется порциями, как в AudioMgr.
+/// FLAC-фикстуры на каждую ветку декодера сверяются с исходным PCM.
+/// MP3-фикстура (тон) декодируется Helix и minimp3 в один и тот же звук с
+/// точностью до округления. Helix: заливка 0xFF (стёртая или добитая флеш) посреди потока
+/// пропускается, звук после неё доигрывается целиком. Фикстуры —
+/// синтетические (bench/Fixtures.cpp). Код возврата — число проваленных
+/// проверок.
+#include "Check.hpp"
+#include "Fixtures.hpp"
+
+#include "Decoders/CodecSet.hpp"
+#include "Decoders/DecoderFlac.hpp"
+#include "Decoders/DecoderMp3.hpp"
+#include "Decoders/DecoderMp3Mini.hpp"
+#include "FsAdapter/FsAdapter.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace ae2;
+
+namespace {
+
+std::map<std::string, std::string> gFiles;  ///< имя фикстуры → путь
+
+/// Порция декодирования — как AudioMgr::kDecodeChunk.
+constexpr uint32_t kChunk = 1024;
+
+alignas(kScratchAlign) uint8_t gScratch[std::max(DecoderMp3::kScratchBytes, DecoderMp3Mini::kScratchBytes)];
+uint8_t gFsBuf[4096];
+FsAdapter gFs(gFsBuf, sizeof(gFsBuf));
+
+/// Декодировать файл целиком набором set в out; seekSec — сначала seek.
+/// false — не открылся.
+template<typename Set>
+bool decodeAll(Set& set, const std::string& path, std::vector<s16>& out, uint32_t seekSec = 0) {
+    out.clear();
+    if (!gFs.open(path.c_str())) return false;
+    DecoderEnv env;
+    env.type    = CodecDetect::detect(gFs);
+    env.scratch = ScratchArena{gScratch, sizeof(gScratch)};
+    DecoderBase* dec = set.emplace(env);
+    const bool ok = dec && dec->open(gFs);
+    if (ok && seekSec) dec->seek(seekSec);
+    if (ok) {
+        s16 pcm[kChunk];
+        for (;;) {
+            const uint32_t n = set.decode(pcm, kChunk);
+            if (n == 0 && !dec->skipping()) break;
+            out.insert(out.end(), pcm, pcm + n);
+        }
+    }
+    set.reset();
+    gFs.close();
+    return ok;
+}
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+void writeFile(const std::string& path, const std::vector<uint8_t>& b) {
+    std::ofstream(path, std::ios::binary | std::ios::trunc)
+        .write(reinterpret_cast<const char*>(b.data()), (std::streamsize)b.size());
+}
+
+/// Допуск Helix против minimp3, LSB: fixed-point против float.
+constexpr int32_t kMp3Tolerance = 8;
+
+/// Поток, 256 КБ 0xFF, тот же поток: каждый 0xFF — sync-кандидат без
+/// валидного заголовка. Всё пропускается по лимиту на вызов, оба
+/// экземпляра звука доигрываются.
+void testMp3FillSkipped(const std::string& work) {
+    CodecSet<DecoderMp3> helix;
+    const std::string& src = gFiles["mp3-128k-stereo-44k"];
+    const std::vector<uint8_t> stream = readFile(src);
+    std::vector<uint8_t> bytes = stream;
+    bytes.insert(bytes.end(), 256 * 1024, 0xFF);
+    bytes.insert(bytes.end(), stream.begin(), stream.end());
+    const std::string padded = work + "/mp3-ff-fill.mp3";
+    writeFile(padded, bytes);
+
+    std::vector<s16> once, twice;
+    CHECK(decodeAll(helix, src, once));
+    CHECK(decodeAll(helix, padded, twice));
+    CHECK(!once.empty());
+    CHECK(twice.size() == 2 * once.size());
+}
+
+/// Тон MP3-фикстуры: оба бэкенда отдают одинаковую длину, звук не тишина,
+/// расхождение fixed-point Helix и float minimp3 — в пределах округления.
+void testMp3Backends() {
+    CodecSet<DecoderMp3>     helix;
+    CodecSet<DecoderMp3Mini> mini;
+    const std::string& src = gFiles["mp3-128k-stereo-44k"];
+    std::vector<s16> a, b;
+    CHECK(decodeAll(helix, src, a));
+    CHECK(decodeAll(mini, src, b));
+    CHECK(!a.empty());
+    CHECK(a.size() == b.size());
+
+    int32_t peak = 0, diff = 0;
+    for (size_t i = 0; i < std::min(a.size(), b.size()); ++i) {
+        peak = std::max(peak, std::abs((int32_t)a[i]));
+        diff = std::max(diff, std::abs((int32_t)a[i] - b[i]));
+    }
+    CHECK(peak > 1000);
+    CHECK(diff <= kMp3Tolerance);
+}
+
+/// FLAC без потерь: каждая фикстура writeFlacCases декодируется ровно в
+/// исходный PCM. Seek по SEEKTABLE (точки через 4 кадра) на 1 с — две
+/// цели кадра пропускаются целиком, в третьем skipTo_ отрезает начало.
+void testFlacCases(const std::string& work) {
+    CodecSet<DecoderFlac> flac;
+    const auto cases = bench::writeFlacCases(work);
+    CHECK(cases.size() == 9);
+    for (const auto& c : cases) {
+        std::vector<s16> out;
+        CHECK(decodeAll(flac, c.path, out));
+        const bool same = out == c.pcm;
+        CHECK(same);
+        if (!same) std::fprintf(stderr, "  mismatch: %s\n", c.name.c_str());
+
+        if (c.name == "flac-seektable") {
+            CHECK(decodeAll(flac, c.path, out, 1));
+            CHECK(std::equal(out.begin(), out.end(), c.pcm.begin() + 44100, c.pcm.end()));
+            CHECK(out.size() == c.pcm.size() - 44100);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::string work = argc > 1 ? argv[1] : "test-fixtures";
+    for (const auto& f : bench::writeSynthetic(work, 1)) gFiles[f.name] = f.path;
+    if (gFiles.empty()) {
+        std::fprintf(stderr, "cannot write fixtures to %s\n", work.c_str());
+        return 1;
+    }
+
+    testFlacCases(work);
+    testMp3Backends();
+    testMp3FillSkipped(work);
+
+    std::printf("ae2_test_decoders: %d failure(s)\n", test::gFailures);
+    return test::gFailures;
+}
@@ -0,0 +1,153 @@
+/// @file HelixSimdTest.cpp
+/// @brief ae2_test_helix_simd: SSE4.1-ядра Helix против C-версий.
+///
+///   ae2_test_helix_simd [WORKDIR]
+///
+/// Собирается с Helix под HELIX_SIMD и -msse4.1 (x86-64, GCC/Clang).
+/// PolyphaseMono, PolyphaseStereo и AntiAlias гоняются на случайных
+/// входах в обоих режимах MP3SetSimd — результат должен совпасть бит в
+/// бит. Затем MP3-фикстура (bench/Fixtures.cpp, тон) декодируется целиком
+/// с MP3SetSimd(0) и MP3SetSimd(1), PCM сравнивается. Код возврата —
+/// число проваленных проверок.
+#include "Check.hpp"
+#include "Fixtures.hpp"
+
+#include "Decoders/CodecSet.hpp"
+#include "Decoders/DecoderMp3.hpp"
+#include "FsAdapter/FsAdapter.hpp"
+
+extern "C" {
+#include "coder.h"
+}
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef HELIX_X86_SIMD
+#  error "ae2_test_helix_simd: Helix должен собираться с HELIX_SIMD и -msse4.1"
+#endif
+
+using namespace ae2;
+
+namespace {
+
+/// Случайных векторов на ядро.
+constexpr uint32_t kVectors = 20000;
+
+/* xorshift32, как в Fixtures.cpp: прогон воспроизводим */
+struct Rng {
+    uint32_t s = 0x2545F491u;
+    uint32_t next() { s ^= s << 13; s ^= s >> 17; s ^= s << 5; return s; }
+    /// Знаковое значение до 2^bits по модулю.
+    int32_t below(uint32_t bits) {
+        return bits ? (int32_t)(next() & ((1u << bits) - 1)) - (int32_t)(1u << (bits - 1)) : 0;
+    }
+};
+
+/* Масштаб входа — случайный по вектору: и тихие, и с насыщением выхода.
+ * vbuf — до 2^27 (16 64-битных произведений на Q31-коэффициенты не
+ * переполняют сумму), AntiAlias — до 2^29 (guard bit, как после dequant). */
+void fill(int32_t* v, uint32_t n, Rng& rng, uint32_t maxBits) {
+    const uint32_t bits = 1 + (rng.next() % maxBits);
+    for (uint32_t i = 0; i < n; ++i) v[i] = rng.below(bits);
+}
+
+void testPolyphase(bool stereo) {
+    Rng rng;
+    std::vector<int32_t> vbuf(VBUF_LENGTH);
+    short c[2 * NBANDS], sse[2 * NBANDS];
+    uint32_t bad = 0;
+    for (uint32_t i = 0; i < kVectors; ++i) {
+        fill(vbuf.data(), VBUF_LENGTH, rng, 27);
+        std::memset(c, 0, sizeof(c));
+        std::memset(sse, 0, sizeof(sse));
+        MP3SetSimd(0);
+        if (stereo) PolyphaseStereo(c, vbuf.data(), polyCoef);
+        else        PolyphaseMono(c, vbuf.data(), polyCoef);
+        MP3SetSimd(1);
+        if (stereo) PolyphaseStereo(sse, vbuf.data(), polyCoef);
+        else        PolyphaseMono(sse, vbuf.data(), polyCoef);
+        if (std::memcmp(c, sse, sizeof(c)) != 0) bad++;
+    }
+    CHECK(bad == 0);
+}
+
+void testAntiAlias() {
+    Rng rng;
+    int32_t c[MAX_NSAMP], sse[MAX_NSAMP];
+    uint32_t bad = 0;
+    for (uint32_t i = 0; i < kVectors; ++i) {
+        const int nBfly = 1 + (int)(rng.next() % 31);  /* до 32 блоков по 18 */
+        fill(c, MAX_NSAMP, rng, 29);
+        std::memcpy(sse, c, sizeof(c));
+        MP3SetSimd(0);
+        AntiAlias(c, nBfly);
+        MP3SetSimd(1);
+        AntiAlias(sse, nBfly);
+        if (std::memcmp(c, sse, sizeof(c)) != 0) bad++;
+    }
+    CHECK(bad == 0);
+}
+
+alignas(kScratchAlign) uint8_t gScratch[DecoderMp3::kScratchBytes];
+uint8_t gFsBuf[4096];
+FsAdapter gFs(gFsBuf, sizeof(gFsBuf));
+
+/// Декодировать MP3 целиком порциями по 1024. false — не открылся.
+bool decodeAll(const std::string& path, std::vector<s16>& out) {
+    out.clear();
+    if (!gFs.open(path.c_str())) return false;
+    CodecSet<DecoderMp3> helix;
+    DecoderEnv env;
+    env.type    = CodecDetect::detect(gFs);
+    env.scratch = ScratchArena{gScratch, sizeof(gScratch)};
+    DecoderBase* dec = helix.emplace(env);
+    const bool ok = dec && dec->open(gFs);
+    if (ok) {
+        s16 pcm[1024];
+        for (;;) {
+            const uint32_t n = helix.decode(pcm, 1024);
+            if (n == 0 && !dec->skipping()) break;
+            out.insert(out.end(), pcm, pcm + n);
+        }
+    }
+    helix.reset();
+    gFs.close();
+    return ok;
+}
+
+void testDecode(const std::string& path) {
+    std::vector<s16> c, sse;
+    CHECK(MP3SetSimd(0) == 0);
+    CHECK(decodeAll(path, c));
+    CHECK(MP3SetSimd(1) == 1);
+    CHECK(decodeAll(path, sse));
+    CHECK(!c.empty());
+    CHECK(c == sse);
+
+    bool silent = true;
+    for (s16 v : c) silent = silent && v == 0;
+    CHECK(!silent);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::string work = argc > 1 ? argv[1] : "test-fixtures";
+    std::string mp3;
+    for (const auto& f : bench::writeSynthetic(work, 1))
+        if (f.name == "mp3-128k-stereo-44k") mp3 = f.path;
+    if (mp3.empty()) {
+        std::fprintf(stderr, "cannot write fixtures to %s\n", work.c_str());
+        return 1;
+    }
+
+    testPolyphase(false);
+    testPolyphase(true);
+    testAntiAlias();
+    testDecode(mp3);
+
+    std::printf("ae2_test_helix_simd: %d failure(s)\n", test::gFailures);
+    return test::gFailures;
+}
@@ -0,0 +1,186 @@
+/// @file RenderTest.cpp
+/// @brief ae2_test_render: golden-хэши офлайн-рендера кодек × ресемплер.
+///
+///   ae2_test_render WORKDIR GOLDEN [--update]
+///
+/// Каждая синтетическая фикстура (bench/Fixtures.cpp) рендерится через C API
+/// (aeRenderToMemory) обоими алгоритмами ресемплера; плюс громкость,
+/// понижение частоты и headerless .alaw с форматом из опций. Результат —
+/// число сэмплов и FNV-1a по ним — сравнивается со строкой GOLDEN
+/// (tests/golden/render.txt). --update переписывает файл: после
+/// намеренной смены звука, с объяснением в коммите; строки MP3 другого
+/// бэкенда (-DAE2_MP3_MINIMP3) остаются как были — их обновляет его сборка. Код возврата — число
+/// проваленных проверок.
+#include "Check.hpp"
+#include "Fixtures.hpp"
+
+#include "AudioEngineV2/AudioEngine_C.h"
+
+#include <cinttypes>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Result {
+    uint32_t samples = 0;
+    uint64_t hash    = 0;
+};
+
+/// MP3-бэкенд сборки: Helix и minimp3 расходятся в младших битах, у
+/// MP3-фикстур golden-строки свои на каждый бэкенд.
+#if defined(AE2_MP3_MINIMP3) && AE2_MP3_MINIMP3
+constexpr const char* kMp3Backend = "minimp3";
+constexpr const char* kMp3Other   = "helix";
+#else
+constexpr const char* kMp3Backend = "helix";
+constexpr const char* kMp3Other   = "minimp3";
+#endif
+
+/// Ключ golden: "фикстура/вариант", у MP3 — "фикстура@бэкенд/вариант".
+std::string key(const std::string& fixture, const char* variant) {
+    if (fixture.compare(0, 4, "mp3-") == 0)
+        return fixture + "@" + kMp3Backend + "/" + variant;
+    return fixture + "/" + variant;
+}
+
+bool render(const std::string& path, const ae_render_options_t& opt, Result& out) {
+    static std::vector<int16_t> buf(1u << 20);
+    const char* paths[] = {path.c_str()};
+    uint32_t written = 0;
+    ae_render_stats_t st{};
+    if (!aeRenderToMemory(paths, 1, buf.data(), (uint32_t)buf.size(), &opt, &written, &st))
+        return false;
+    if (st.tracks != 1 || st.failed != 0 || written == 0) return false;
+    out.samples = written;
+    out.hash    = 14695981039346656037ull;
+    for (uint32_t i = 0; i < written; ++i)
+        out.hash = (out.hash ^ (uint16_t)buf[i]) * 1099511628211ull;
+    return true;
+}
+
+/// Headerless A-law: формат берётся только из опций рендера.
+std::string writeRawAlaw(const std::string& dir) {
+    const std::string path = dir + "/raw-stereo-16k.alaw";
+    std::vector<uint8_t> bytes(16000 * 2 / 2);  /* полсекунды стерео 16 кГц */
+    uint32_t x = 12345;
+    for (auto& b : bytes) {
+        x = x * 1103515245u + 12345u;
+        b = (uint8_t)(x >> 16);
+    }
+    std::ofstream(path, std::ios::binary | std::ios::trunc)
+        .write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+    return path;
+}
+
+std::map<std::string, Result> readGolden(const std::string& path) {
+    std::map<std::string, Result> g;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ls(line);
+        std::string k, hash;
+        Result r;
+        if (ls >> k >> r.samples >> hash) {
+            r.hash = std::stoull(hash, nullptr, 16);
+            g[k] = r;
+        }
+    }
+    return g;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: ae2_test_render WORKDIR GOLDEN [--update]\n");
+        return 1;
+    }
+    const std::string work   = argv[1];
+    const std::string golden = argv[2];
+    const bool update = argc > 3 && std::strcmp(argv[3], "--update") == 0;
+
+    const auto fixtures = ae2::bench::writeSynthetic(work, 1);
+    if (fixtures.empty()) {
+        std::fprintf(stderr, "cannot write fixtures to %s\n", work.c_str());
+        return 1;
+    }
+
+    struct Case {
+        std::string         key;
+        std::string         path;
+        ae_render_options_t opt;
+    };
+    std::vector<Case> cases;
+    ae_render_options_t base;
+    aeRenderOptionsInit(&base);
+    for (const auto& f : fixtures) {
+        ae_render_options_t o = base;
+        o.resample = AE_RESAMPLE_NEAREST;
+        cases.push_back({key(f.name, "nearest"), f.path, o});
+        o.resample = AE_RESAMPLE_LINEAR;
+        cases.push_back({key(f.name, "linear"), f.path, o});
+        if (f.name == "pcm16-stereo-44k") {
+            o.volume = 3;
+            cases.push_back({key(f.name, "linear-vol3"), f.path, o});
+        }
+        if (f.name == "flac-stereo-44k") {
+            o = base;
+            o.out_rate = 22050;
+            cases.push_back({key(f.name, "linear-22k"), f.path, o});
+        }
+    }
+    const std::string raw = writeRawAlaw(work);
+    for (ae_resample_t alg : {AE_RESAMPLE_NEAREST, AE_RESAMPLE_LINEAR}) {
+        ae_render_options_t o = base;
+        o.resample      = alg;
+        o.g711_rate     = 16000;
+        o.g711_channels = 2;
+        cases.push_back({key("raw-stereo-16k", alg == AE_RESAMPLE_LINEAR ? "linear" : "nearest"),
+                         raw, o});
+    }
+
+    const auto expected = readGolden(golden);
+    std::map<std::string, Result> fresh;
+    for (const auto& c : cases) {
+        Result r;
+        const bool ok = render(c.path, c.opt, r);
+        CHECK(ok);
+        if (!ok) {
+            std::fprintf(stderr, "  render failed: %s\n", c.key.c_str());
+            continue;
+        }
+        fresh[c.key] = r;
+        if (update) continue;
+        const auto it = expected.find(c.key);
+        const bool match = it != expected.end() && it->second.samples == r.samples &&
+                           it->second.hash == r.hash;
+        CHECK(match);
+        if (!match)
+            std::fprintf(stderr, "  mismatch: %s %" PRIu32 " %016" PRIx64 "\n",
+                         c.key.c_str(), r.samples, r.hash);
+    }
+
+    if (update) {
+        /* Строки другого MP3-бэкенда этой сборкой не проверить — сохраняем */
+        const std::string other = std::string("@") + kMp3Other + "/";
+        for (const auto& [k, r] : expected)
+            if (k.find(other) != std::string::npos) fresh.emplace(k, r);
+        std::ofstream out(golden, std::ios::trunc);
+        out << "# ae2_test_render: fixture/variant samples fnv1a64 (--update переписывает)\n";
+        for (const auto& [k, r] : fresh) {
+            char line[160];
+            std::snprintf(line, sizeof(line), "%s %" PRIu32 " %016" PRIx64 "\n",
+                          k.c_str(), r.samples, r.hash);
+            out << line;
+        }
+        std::printf("ae2_test_render: wrote %zu entries to %s\n", fresh.size(), golden.c_str());
+    }
+    std::printf("ae2_test_render: %d failure(s)\n", ae2::test::gFailures);
+    return ae2::test::gFailures;
+}
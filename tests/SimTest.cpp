@@ -0,0 +1,428 @@
+/// @file SimTest.cpp
+/// @brief ae2_test_sim: AudioMgr на виртуальных часах (AE2_HW_SIM).
+///
+///   ae2_test_sim [WORKDIR]
+///
+/// Сценарии идут подряд на одном синглтоне AudioMgr, каждый с пустой
+/// очередью: конец очереди, underrun от медленного носителя, смена частоты
+/// DAC между треками и посреди трека, сброс кэша PCM посреди трека из него,
+/// события через callback, плейлист из каталога и .m3u (подряд и shuffle)
+/// и из непроигрываемых путей, старт shuffle до конца подсчёта, бюджет памяти и отсутствие аллокаций на hot
+/// path. Фикстуры — синтетические (bench/Fixtures.cpp), по секунде. Код
+/// возврата — число проваленных проверок.
+#include "Check.hpp"
+#include "Fixtures.hpp"
+
+#include "AudioEngineV2/AudioMgr.hpp"
+#include "AudioHw/AudioHw.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#if !AE2_HW_SIM
+#  error "ae2_test_sim requires AE2_HW_SIM=1"
+#endif
+
+using namespace ae2;
+
+namespace {
+
+std::map<std::string, std::string> gFiles;  ///< имя фикстуры → путь
+
+/// Что «услышал» DAC.
+struct Recorder {
+    uint64_t samples  = 0;
+    uint64_t nonZero  = 0;
+    uint64_t hash     = 14695981039346656037ull;  ///< FNV-1a по сэмплам
+    std::vector<uint32_t> rates;  ///< частоты по порядку, без повторов
+
+    static void record(void* ctx, const s16* pcm, uint32_t n, uint32_t rate) {
+        auto* r = static_cast<Recorder*>(ctx);
+        r->samples += n;
+        for (uint32_t i = 0; i < n; ++i) {
+            r->nonZero += pcm[i] != 0;
+            r->hash = (r->hash ^ (uint16_t)pcm[i]) * 1099511628211ull;
+        }
+        if (r->rates.empty() || r->rates.back() != rate) r->rates.push_back(rate);
+    }
+};
+
+struct Events {
+    uint32_t started    = 0;
+    uint32_t endedEof   = 0;
+    uint32_t endedOther = 0;
+    uint32_t underruns  = 0;
+    bool     queueEnded = false;
+
+    void drain(AudioMgr& mgr) {
+        AudioMgr::Event ev{};
+        while (mgr.waitEvent(ev, 0)) {
+            switch (ev.type) {
+                case AudioMgr::Event::TrackStarted: started++; break;
+                case AudioMgr::Event::TrackEnded:
+                    (ev.ended.reason == AudioMgr::Event::EndOfFile ? endedEof : endedOther)++;
+                    break;
+                case AudioMgr::Event::Underrun:   underruns++; break;
+                case AudioMgr::Event::QueueEnded: queueEnded = true; break;
+                default: break;
+            }
+        }
+    }
+};
+
+/// Один шаг = итерация таска + 1 мс виртуального времени.
+void step(AudioMgr& mgr, Events& ev, uint32_t ms) {
+    auto& hw = AudioHw::instance();
+    for (uint32_t i = 0; i < ms; ++i) {
+        mgr.runOnce();
+        hw.simAdvance(1);
+        ev.drain(mgr);
+    }
+}
+
+/// Крутить, пока очередь не кончится (или limitMs); @return прошедшие мс.
+uint32_t runToEnd(AudioMgr& mgr, Events& ev, uint32_t limitMs) {
+    uint32_t ms = 0;
+    while (!ev.queueEnded && ms < limitMs) { step(mgr, ev, 1); ms++; }
+    step(mgr, ev, 100);  /* хвост ring доигрывает */
+    return ms;
+}
+
+/// Пустая очередь, Fixed 128 кГц, чистые часы и счётчики событий.
+void reset(AudioMgr& mgr, Recorder& rec, const AudioHw::SimConfig& extra = {}) {
+    Events ev;
+    AudioHw::instance().simConfigure({});  /* Recorder прошлого сценария уже снят со стека */
+    mgr.clearQueue();
+    mgr.setRatePolicy(AudioMgr::RatePolicy::Fixed);
+    mgr.setSampleRate(128000);
+    step(mgr, ev, 50);
+    rec = Recorder{};
+    AudioHw::SimConfig cfg = extra;
+    cfg.record    = &Recorder::record;
+    cfg.recordCtx = &rec;
+    AudioHw::instance().simConfigure(cfg);
+    (void)mgr.pipelineStats(true);
+}
+
+/* ── Сценарии ── */
+
+/// Три кодека подряд: каждый доигрывает до конца, очередь кончается,
+/// DAC получает длительность всех файлов без underrun.
+void testEndOfQueue(AudioMgr& mgr) {
+    Recorder rec;
+    reset(mgr, rec);
+    const uint32_t u0 = AudioHw::instance().underruns();
+
+    for (const char* f : {"pcm16-mono-44k", "flac-stereo-44k", "ima-stereo-44k"})
+        mgr.addFile(gFiles[f].c_str());
+    mgr.play();
+    Events ev;
+    runToEnd(mgr, ev, 10000);
+
+    CHECK(ev.started == 3);
+    CHECK(ev.endedEof == 3);
+    CHECK(ev.endedOther == 0);
+    CHECK(ev.queueEnded);
+    CHECK(AudioHw::instance().underruns() == u0);
+    /* 3 секунды на 128 кГц; IMA-фикстура короче на неполный блок */
+    CHECK(rec.samples >= 3 * 128000 * 95 / 100);
+    CHECK(rec.nonZero > 3 * 128000 * 9 / 10);
+    CHECK(!mgr.playerStatus().playing);
+}
+
+/// Карта дважды «задумывается» дольше запаса ring: два underrun, второй
+/// удваивает предбуфер; трек всё равно доигрывает до конца.
+void testSlowStorageUnderrun(AudioMgr& mgr) {
+    AudioHw::SimConfig cfg;
+    cfg.readStall = [](void*, uint32_t read) -> uint32_t {
+        return (read == 6 || read == 12) ? 150u : 0u;  /* ring — 64 мс на 128 кГц */
+    };
+    Recorder rec;
+    reset(mgr, rec, cfg);
+    auto& hw = AudioHw::instance();
+    hw.setPrebuffer(AudioHw::kDefaultPrebufferMs, AudioHw::kDefaultMaxPrebufferMs);
+    const uint32_t u0 = hw.underruns();
+
+    mgr.addFile(gFiles["pcm16-mono-44k"].c_str());
+    mgr.play();
+    Events ev;
+    runToEnd(mgr, ev, 5000);
+
+    const auto sim  = hw.simStats();
+    const auto pipe = mgr.pipelineStats(true);
+    CHECK(sim.stallMs == 300);
+    CHECK(hw.underruns() - u0 == 2);
+    CHECK(ev.underruns == 2);
+    CHECK(pipe.underruns == 2);
+    CHECK(hw.prebufferMs() == 2 * AudioHw::kDefaultPrebufferMs);
+    CHECK(ev.endedEof == 1);
+    CHECK(ev.queueEnded);
+    /* Звук после underrun продолжился: вся секунда дошла до DAC */
+    CHECK(rec.nonZero > 128000 * 9 / 10);
+    hw.setPrebuffer(AudioHw::kDefaultPrebufferMs, AudioHw::kDefaultMaxPrebufferMs);
+}
+
+/// NativeMultiple: DAC идёт за частотой трека (44.1 → 88.2, 48 → 96,
+/// 8 → 128 кГц); смена частоты — не underrun.
+void testRateSwitch(AudioMgr& mgr) {
+    Recorder rec;
+    reset(mgr, rec);
+    const uint32_t u0 = AudioHw::instance().underruns();
+
+    mgr.setRatePolicy(AudioMgr::RatePolicy::NativeMultiple);
+    for (const char* f : {"pcm16-mono-44k", "pcm24-stereo-48k", "alaw-mono-8k"})
+        mgr.addFile(gFiles[f].c_str());
+    mgr.play();
+    Events ev;
+    runToEnd(mgr, ev, 10000);
+
+    std::vector<uint32_t> played;
+    for (uint32_t r : rec.rates)
+        if (played.empty() || played.back() != r) played.push_back(r);
+    /* Первой может мелькнуть частота, на которой DAC стоял до трека */
+    if (!played.empty() && played.front() == 128000) played.erase(played.begin());
+    CHECK((played == std::vector<uint32_t>{88200, 96000, 128000}));
+    CHECK(ev.endedEof == 3);
+    CHECK(AudioHw::instance().underruns() == u0);
+    CHECK(AudioHw::instance().sampleRate() == 128000);
+}
+
+/// Смена частоты DAC посреди трека: недоресемплированный остаток входа
+/// доигрывается на новой частоте, ни один сэмпл файла не теряется.
+void testRateChangeKeepsResidual(AudioMgr& mgr) {
+    Recorder rec;
+    reset(mgr, rec);
+    mgr.addFile(gFiles["pcm16-mono-44k"].c_str());
+    mgr.play();
+    Events ev;
+    uint32_t rate = 128000;
+    for (uint32_t ms = 0; !ev.queueEnded && ms < 5000; ++ms) {
+        step(mgr, ev, 1);
+        if (rec.samples > 0 && ms % 37 == 0) {  /* почаще, чтобы попасть на остаток */
+            rate = rate == 128000 ? 96000 : 128000;
+            mgr.setSampleRate(rate);
+        }
+    }
+    const auto pipe = mgr.pipelineStats(true);
+    CHECK(ev.endedEof == 1);
+    CHECK(pipe.samplesIn == 44100);
+    mgr.setSampleRate(128000);
+}
+
+/// Трек из кэша PCM играет прямо из блока; invalidate соседней записи
+/// (сдвиг блока) и clear() посреди трека не портят его звук.
+void testPcmCacheDropWhilePlaying(AudioMgr& mgr) {
+    static s16 block[256 * 1024];
+    AudioMgr::PcmCacheConfig cc;
+    cc.mem          = block;
+    cc.bytes        = sizeof(block);
+    cc.maxFileBytes = 512 * 1024;
+    mgr.setPcmCache(cc);
+
+    const std::string a = gFiles["alaw-mono-8k"];      /* короче b: сдвиг b накрывает читаемое */
+    const std::string b = gFiles["pcm24-stereo-48k"];  /* лежит в блоке после a */
+    auto play = [&](void (*during)(AudioMgr&, const std::string&)) {
+        Recorder rec;
+        reset(mgr, rec);
+        mgr.addFile(b.c_str());
+        mgr.play();
+        Events ev;
+        /* Ожидание ring двигает часы: «середина трека» — по выводу DAC */
+        while (rec.samples < 128000 / 4) step(mgr, ev, 1);
+        if (during) during(mgr, a);
+        runToEnd(mgr, ev, 5000);
+        CHECK(ev.endedEof == 1);
+        return rec.hash;
+    };
+
+    Recorder rec;
+    reset(mgr, rec);
+    mgr.addFile(a.c_str());
+    mgr.addFile(b.c_str());
+    mgr.play();
+    Events ev;
+    runToEnd(mgr, ev, 5000);
+    CHECK(mgr.pcmCacheStats().fills == 2);
+
+    const uint64_t ref = play(nullptr);
+    CHECK(mgr.pcmCacheStats().hits == 1);
+    CHECK(play([](AudioMgr& m, const std::string& p) { m.invalidatePcmCache(p.c_str()); }) == ref);
+    CHECK(mgr.pcmCacheStats().entries == 1);
+    CHECK(play([](AudioMgr& m, const std::string&) { m.invalidatePcmCache(); }) == ref);
+    CHECK(mgr.pcmCacheStats().entries == 0);
+    CHECK(mgr.pcmCacheStats().used == 0);
+
+    mgr.setPcmCache({});
+}
+
+/// С callback события идут только в него; кольцо waitEvent пусто.
+void testEventCallback(AudioMgr& mgr) {
+    Recorder rec;
+    reset(mgr, rec);
+    static Events viaCb;
+    viaCb = Events{};
+    mgr.setEventCb([](const AudioMgr::Event& e, void* ctx) {
+        auto* ev = static_cast<Events*>(ctx);
+        if (e.type == AudioMgr::Event::TrackStarted) ev->started++;
+        if (e.type == AudioMgr::Event::QueueEnded)   ev->queueEnded = true;
+    }, &viaCb);
+    mgr.addFile(gFiles["alaw-mono-8k"].c_str());
+    mgr.play();
+    Events viaQueue;
+    for (uint32_t ms = 0; !viaCb.queueEnded && ms < 5000; ++ms) step(mgr, viaQueue, 1);
+    mgr.setEventCb(nullptr, nullptr);
+
+    CHECK(viaCb.started == 1);
+    CHECK(viaCb.queueEnded);
+    CHECK(viaQueue.started == 0);
+    CHECK(!viaQueue.queueEnded);
+}
+
+/// Статический бюджет памяти согласован сам с собой; с AE2_ALLOC_GUARD
+/// прогон всех сценариев не дал ни одной аллокации на hot path.
+void testMemoryBudget() {
+    const auto b = AudioMgr::memoryBudget();
+    CHECK(b.codecCount >= 2);  /* WAV PCM и RamPcm есть всегда */
+    CHECK(b.codecCount <= AudioMgr::MemBudget::kMaxCodecs);
+    uint32_t maxScratch = 0;
+    for (uint32_t i = 0; i < b.codecCount; ++i) {
+        CHECK(b.codecs[i].name != nullptr);
+        CHECK(b.codecs[i].object <= b.decoderUsed);
+        if (b.codecs[i].scratch > maxScratch) maxScratch = b.codecs[i].scratch;
+    }
+    CHECK(maxScratch == b.scratchUsed);
+    CHECK(b.decoderUsed <= b.decoderMem);
+    CHECK(b.scratchUsed <= b.decoderScratch);
+    CHECK(b.decoderStack < b.audioTaskStack);
+    CHECK(b.decoderMem + b.decoderScratch + b.decodeBuf + b.fsBuf + b.fsAdapter +
+          b.pathPool + b.playlist + b.resampler + b.queues + b.pcmCache <= b.audioMgr);
+    CHECK(b.ring <= b.audioHw);
+
+    const auto hot = AudioMgr::hotAllocStats();
+    if (hot.enabled) {
+        CHECK(hot.ticks > 0);
+        CHECK(hot.allocs == 0);
+    }
+}
+
+/// Каталог и .m3u из трёх фикстур: каждый режим доигрывает все треки по
+/// одному разу и заканчивается QueueEnded.
+void testPlaylist(AudioMgr& mgr, const std::string& work) {
+    const char* names[] = {"alaw-mono-8k", "ulaw-stereo-8k", "pcm16-mono-44k"};
+    const std::string dir = work + "/playlist";
+    ::mkdir(dir.c_str(), 0755);
+    std::ofstream m3u(work + "/playlist.m3u", std::ios::trunc);
+    m3u << "#EXTM3U\r\n";
+    for (const char* n : names) {
+        const std::string dst = dir + "/" + n + ".wav";
+        std::ifstream in(gFiles[n], std::ios::binary);
+        std::ofstream(dst, std::ios::binary | std::ios::trunc) << in.rdbuf();
+        m3u << dst << "\r\n";
+    }
+    m3u.close();
+    ::mkdir((dir + "/sub").c_str(), 0755);  /* подкаталоги пропускаются */
+
+    struct Mode { std::string path; bool shuffle; };
+    for (const Mode& m : {Mode{dir, false}, Mode{dir, true}, Mode{work + "/playlist.m3u", false},
+                          Mode{work + "/playlist.m3u", true}}) {
+        Recorder rec;
+        reset(mgr, rec);
+        mgr.playPlaylist(m.path.c_str(), m.shuffle, 7);
+        Events ev;
+        runToEnd(mgr, ev, 10000);
+        CHECK(ev.started == 3);
+        CHECK(ev.endedEof == 3);
+        CHECK(ev.endedOther == 0);
+        CHECK(ev.queueEnded);
+        CHECK(rec.samples >= 3 * 128000 * 95 / 100);
+    }
+}
+
+/// .m3u из 200 несуществующих путей и одной фикстуры: неоткрывшиеся
+/// пропускаются порциями за несколько итераций (стек таска не растёт с
+/// длиной плейлиста), трек в конце доигрывает.
+void testPlaylistUnplayable(AudioMgr& mgr, const std::string& work) {
+    constexpr uint32_t kMissing = 200;
+    const std::string path = work + "/missing.m3u";
+    std::ofstream m3u(path, std::ios::trunc);
+    for (uint32_t i = 0; i < kMissing; ++i) m3u << work << "/missing-" << i << ".wav\n";
+    m3u << gFiles["pcm16-mono-44k"] << "\n";
+    m3u.close();
+
+    Recorder rec;
+    reset(mgr, rec);
+    mgr.playPlaylist(path.c_str(), false, 0);
+    Events ev;
+    uint32_t maxPerStep = 0;
+    for (uint32_t ms = 0; !ev.queueEnded && ms < 10000; ++ms) {
+        const uint32_t before = ev.endedOther;
+        step(mgr, ev, 1);
+        maxPerStep = std::max(maxPerStep, ev.endedOther - before);
+    }
+    step(mgr, ev, 100);
+    CHECK(ev.endedOther == kMissing);
+    CHECK(maxPerStep > 0 && maxPerStep <= 16);
+    CHECK(ev.started == 1);
+    CHECK(ev.endedEof == 1);
+    CHECK(rec.samples >= 128000 * 95 / 100);
+}
+
+/// Shuffle каталога из 20 треков и 4 непроигрываемых файлов: первый
+/// трек стартует до конца подсчёта длины, каждый трек играет ровно один
+/// раз, мусор уходит в OpenFailed.
+void testShuffleStartsBeforeCount(AudioMgr& mgr, const std::string& work) {
+    const std::string dir = work + "/shuffle";
+    ::mkdir(dir.c_str(), 0755);
+    for (int i = 0; i < 20; ++i) {
+        std::ifstream in(gFiles["alaw-mono-8k"], std::ios::binary);
+        std::ofstream(dir + "/t" + std::to_string(i) + ".wav", std::ios::binary | std::ios::trunc)
+            << in.rdbuf();
+    }
+    for (int i = 0; i < 4; ++i)
+        std::ofstream(dir + "/x" + std::to_string(i) + ".wav", std::ios::trunc) << "not a riff file";
+
+    Recorder rec;
+    reset(mgr, rec);
+    mgr.playPlaylist(dir.c_str(), true, 3);
+    Events ev;
+    step(mgr, ev, 2);
+    CHECK(ev.started + ev.endedOther > 0);  /* 24 элемента — три порции подсчёта */
+    runToEnd(mgr, ev, 60000);
+    CHECK(ev.started == 20);
+    CHECK(ev.endedEof == 20);
+    CHECK(ev.endedOther == 4);
+    CHECK(ev.queueEnded);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::string work = argc > 1 ? argv[1] : "test-fixtures";
+    for (const auto& f : bench::writeSynthetic(work, 1)) gFiles[f.name] = f.path;
+    if (gFiles.empty()) {
+        std::fprintf(stderr, "cannot write fixtures to %s\n", work.c_str());
+        return 1;
+    }
+
+    auto& mgr = AudioMgr::instance();
+    mgr.requestActivate(SrcId::Player);
+
+    testEndOfQueue(mgr);
+    testSlowStorageUnderrun(mgr);
+    testRateSwitch(mgr);
+    testRateChangeKeepsResidual(mgr);
+    testPcmCacheDropWhilePlaying(mgr);
+    testEventCallback(mgr);
+    testPlaylist(mgr, work);
+    testPlaylistUnplayable(mgr, work);
+    testShuffleStartsBeforeCount(mgr, work);
+    testMemoryBudget();
+
+    std::printf("ae2_test_sim: %d failure(s)\n", test::gFailures);
+    return test::gFailures;
+}
@@ -356,6 +356,14 @@ int MP3Decode(HMP3Decoder hMP3Decoder, unsigned char **inbuf, int *bytesLeft, sh
 		*inbuf += mp3DecInfo->nSlots;
 		*bytesLeft -= (mp3DecInfo->nSlots);
 	} else {
+		/* invalid header/side info combination (e.g. low bitrate with stereo side info) - 
+		 *   negative frame size would reach memcpy below, skip the frame instead
+		 */
+		if (mp3DecInfo->nSlots < 0) {
+			MP3ClearBadFrame(mp3DecInfo, outbuf);
+			return ERR_MP3_INVALID_FRAMEHEADER;
+		}
+
 		/* out of data - assume last or truncated frame */
 		if (mp3DecInfo->nSlots > *bytesLeft) {
 			MP3ClearBadFrame(mp3DecInfo, outbuf);
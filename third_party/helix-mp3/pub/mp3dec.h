@@ -125,6 +125,11 @@ void MP3GetLastFrameInfo(HMP3Decoder hMP3Decoder, MP3FrameInfo *mp3FrameInfo);
 int MP3GetNextFrameInfo(HMP3Decoder hMP3Decoder, MP3FrameInfo *mp3FrameInfo, unsigned char *buf);
 int MP3FindSyncWord(unsigned char *buf, int nBytes);
 
+/* SSE4.1 polyphase/antialias на x86-64 (сборка с -DHELIX_SIMD -msse4.1 и
+ * real/simdx86.c; там включены по умолчанию). Вывод не зависит от режима.
+ * Возвращает действующий режим: 0 — C (сборка без HELIX_SIMD). */
+int MP3SetSimd(int enable);
+
 #ifdef __cplusplus
 }
 #endif
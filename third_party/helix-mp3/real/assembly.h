@@ -435,7 +435,9 @@ static __inline Word64 SAR64(Word64 x, int n)
 
 #elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
 
-/* Generic C fallback для хостовой сборки (x86/x86_64) */
+/* Хост x86/x86_64: GCC сводит MULSHIFT32/MADD64 к одному imul (64-битное
+ * произведение, старшая половина), CLZ — к bsr/lzcnt. Горячие циклы
+ * polyphase и antialias на x86-64 — SSE4.1 в simdx86.c */
 typedef long long Word64;
 
 static __inline int MULSHIFT32(int x, int y)
@@ -100,6 +100,11 @@
 #define PolyphaseMono		STATNAME(PolyphaseMono)
 #define PolyphaseStereo		STATNAME(PolyphaseStereo)
 #define FDCT32				STATNAME(FDCT32)
+#define SimdEnabled			STATNAME(SimdEnabled)
+#define PolyphaseMonoSse	STATNAME(PolyphaseMonoSse)
+#define PolyphaseStereoSse	STATNAME(PolyphaseStereoSse)
+#define AntiAliasSse		STATNAME(AntiAliasSse)
+#define AntiAlias			STATNAME(AntiAlias)
 
 #define	ISFMpeg1			STATNAME(ISFMpeg1)
 #define	ISFMpeg2			STATNAME(ISFMpeg2)
@@ -295,6 +300,22 @@ void PolyphaseStereo(short *pcm, int *vbuf, const int *coefBase);
 }
 #endif
 
+/* simdx86.c: SSE4.1-ядра для хоста x86-64 (GCC/Clang). Только по явному
+ * -DHELIX_SIMD в сборке с -msse4.1 — тогда simdx86.c должен быть в списке
+ * исходников; без флага декодер целиком на C и simdx86.c не нужен.
+ * MP3SetSimd() переключает путь при выполнении. Результат бит-в-бит как у
+ * C-версий: те же 64-битные произведения и суммы, по две-четыре за инструкцию. */
+#if defined(HELIX_SIMD) && defined(__SSE4_1__) && defined(__x86_64__) && defined(__GNUC__)
+#define HELIX_X86_SIMD	1
+int SimdEnabled(void);
+void PolyphaseMonoSse(short *pcm, int *vbuf, const int *coefBase);
+void PolyphaseStereoSse(short *pcm, int *vbuf, const int *coefBase);
+void AntiAliasSse(int *x, int nBfly);
+#endif
+
+/* imdct.c: как Polyphase*, переключается MP3SetSimd() */
+void AntiAlias(int *x, int nBfly);
+
 /* trigtabs.c */
 extern const int imdctWin[4][36];
 extern const int ISFMpeg1[2][7];
@@ -417,8 +417,9 @@ int DecodeHuffman(MP3DecInfo *mp3DecInfo, unsigned char *buf, int *bitOffset, in
 		}
 		r2Start = MAX_NSAMP;	/* short blocks don't have region 2 */
 	} else {
-		r1Start = fh->sfBand->l[sis->region0Count + 1];
-		r2Start = fh->sfBand->l[sis->region0Count + 1 + sis->region1Count + 1];
+		/* corrupt side info can index past l[22] - clamp (region end is clamped to nBigvals anyway) */
+		r1Start = fh->sfBand->l[MIN(sis->region0Count + 1, 22)];
+		r2Start = fh->sfBand->l[MIN(sis->region0Count + 1 + sis->region1Count + 1, 22)];
 	}
 
 	/* offset rEnd index by 1 so first region = rEnd[1] - rEnd[0], etc. */
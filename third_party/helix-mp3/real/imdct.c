@@ -70,11 +70,19 @@
  *                 gain from AntiAlias < 2.0)
  **************************************************************************************/
 // a little bit faster in RAM (< 1 ms per block)
-static void AntiAlias(int *x, int nBfly)
+// не static: ae2_test_helix_simd сверяет C- и SSE-путь (см. coder.h)
+void AntiAlias(int *x, int nBfly)
 {
 	int k, a0, b0, c0, c1;
 	const int *c;
 
+#ifdef HELIX_X86_SIMD
+	if (SimdEnabled()) {
+		AntiAliasSse(x, nBfly);
+		return;
+	}
+#endif
+
 	/* csa = Q31 */
 	for (k = nBfly; k > 0; k--) {
 		c = csa[0];
@@ -117,6 +117,13 @@ void PolyphaseMono(short *pcm, int *vbuf, const int *coefBase)
 	int vLo, vHi, c1, c2;
 	Word64 sum1L, sum2L, rndVal;
 
+#ifdef HELIX_X86_SIMD
+	if (SimdEnabled()) {
+		PolyphaseMonoSse(pcm, vbuf, coefBase);
+		return;
+	}
+#endif
+
 	rndVal = (Word64)( 1 << (DEF_NFRACBITS - 1 + (32 - CSHIFT)) );
 
 	/* special case, output sample 0 */
@@ -230,6 +237,13 @@ void PolyphaseStereo(short *pcm, int *vbuf, const int *coefBase)
 	int vLo, vHi, c1, c2;
 	Word64 sum1L, sum2L, sum1R, sum2R, rndVal;
 
+#ifdef HELIX_X86_SIMD
+	if (SimdEnabled()) {
+		PolyphaseStereoSse(pcm, vbuf, coefBase);
+		return;
+	}
+#endif
+
 	rndVal = (Word64)( 1 << (DEF_NFRACBITS - 1 + (32 - CSHIFT)) );
 
 	/* special case, output sample 0 */
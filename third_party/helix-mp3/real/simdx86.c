@@ -0,0 +1,233 @@
+/**************************************************************************************
+ * Fixed-point MP3 decoder
+ *
+ * simdx86.c - SSE4.1 versions of PolyphaseMono/PolyphaseStereo (polyphase.c) and
+ *   AntiAlias (imdct.c) for x86-64 hosts, built with -DHELIX_SIMD -msse4.1
+ *
+ * Результат бит-в-бит как у C-версий: _mm_mul_epi32 даёт те же знаковые
+ *   64-битные произведения, что MADD64, а сложение по модулю 2^64 не зависит
+ *   от порядка. MULSHIFT32 — старшие 32 бита того же произведения.
+ *   Включается только явно (HELIX_SIMD и __SSE4_1__, см. coder.h): вся
+ *   сборка уже рассчитана на SSE4.1, проверка CPUID не нужна.
+ **************************************************************************************/
+
+#include "coder.h"
+#include "assembly.h"
+#include "mp3dec.h"
+
+#ifdef HELIX_X86_SIMD
+
+#include <smmintrin.h>
+
+static int simdMode = 1;
+
+int SimdEnabled(void)
+{
+	return simdMode;
+}
+
+int MP3SetSimd(int enable)
+{
+	simdMode = enable ? 1 : 0;
+	return simdMode;
+}
+
+/* как в polyphase.c */
+#define DEF_NFRACBITS	(DQ_FRACBITS_OUT - 2 - 2 - 15)
+#define CSHIFT	12
+
+static __inline short ClipToShort(int x, int fracBits)
+{
+	int sign;
+
+	x >>= fracBits;
+	sign = x >> 31;
+	if (sign != (x >> 15))
+		x = sign ^ ((1 << 15) - 1);
+
+	return (short)x;
+}
+
+static __inline short PcmOut(Word64 sum)
+{
+	return ClipToShort((int)SAR64(sum, (32-CSHIFT)), DEF_NFRACBITS);
+}
+
+/* сумма двух 64-битных полос */
+static __inline Word64 HSum64(__m128i v)
+{
+	return (Word64)_mm_cvtsi128_si64(v) + (Word64)_mm_extract_epi64(v, 1);
+}
+
+/* [v[0], v[0], v[1], v[1]]: v[0] и v[1] в чётных полосах для _mm_mul_epi32 */
+static __inline __m128i LoadPair(const int *v)
+{
+	return _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i *)v), _MM_SHUFFLE(1, 1, 0, 0));
+}
+
+/* [v[1], v[1], v[0], v[0]] — то же в обратном порядке */
+static __inline __m128i LoadPairRev(const int *v)
+{
+	return _mm_shuffle_epi32(_mm_loadl_epi64((const __m128i *)v), _MM_SHUFFLE(0, 0, 1, 1));
+}
+
+/* MC0M/MC2M для отсчётов x, x+1: coef = [c1(x), c2(x), c1(x+1), c2(x+1)]
+ *   s1 += vLo*c1 - vHi*c2,  s2 += vLo*c2 + vHi*c1 (s2 == NULL — только s1) */
+static __inline void Mac2(__m128i *s1, __m128i *s2, const int *vb, const int *coef, int x)
+{
+	__m128i lo = LoadPair(vb + x);
+	__m128i hi = LoadPairRev(vb + 22 - x);
+	__m128i c1 = _mm_loadu_si128((const __m128i *)(coef + 2*x));
+	__m128i c2 = _mm_srli_epi64(c1, 32);
+
+	*s1 = _mm_add_epi64(*s1, _mm_sub_epi64(_mm_mul_epi32(lo, c1), _mm_mul_epi32(hi, c2)));
+	if (s2)
+		*s2 = _mm_add_epi64(*s2, _mm_add_epi64(_mm_mul_epi32(lo, c2), _mm_mul_epi32(hi, c1)));
+}
+
+/* MC1M для отсчётов x, x+1: s += vLo*c1, коэффициенты подряд */
+static __inline void Mac1(__m128i *s, const int *vb, const int *coef, int x)
+{
+	*s = _mm_add_epi64(*s, _mm_mul_epi32(LoadPair(vb + x), LoadPair(coef + x)));
+}
+
+void PolyphaseMonoSse(short *pcm, int *vbuf, const int *coefBase)
+{
+	int i, x;
+	const int *coef;
+	int *vb1;
+	__m128i s1, s2;
+	Word64 rndVal;
+
+	rndVal = (Word64)( 1 << (DEF_NFRACBITS - 1 + (32 - CSHIFT)) );
+
+	/* special case, output sample 0 */
+	s1 = _mm_setzero_si128();
+	for (x = 0; x < 8; x += 2)
+		Mac2(&s1, NULL, vbuf, coefBase, x);
+	pcm[0] = PcmOut(rndVal + HSum64(s1));
+
+	/* special case, output sample 16 */
+	s1 = _mm_setzero_si128();
+	for (x = 0; x < 8; x += 2)
+		Mac1(&s1, vbuf + 64*16, coefBase + 256, x);
+	pcm[16] = PcmOut(rndVal + HSum64(s1));
+
+	/* main convolution loop: s1 = samples 1, 2, 3, ... 15   s2 = samples 31, 30, ... 17 */
+	coef = coefBase + 16;
+	vb1 = vbuf + 64;
+	pcm++;
+
+	for (i = 15; i > 0; i--) {
+		s1 = s2 = _mm_setzero_si128();
+		for (x = 0; x < 8; x += 2)
+			Mac2(&s1, &s2, vb1, coef, x);
+		coef += 16;
+		vb1 += 64;
+		pcm[0]   = PcmOut(rndVal + HSum64(s1));
+		pcm[2*i] = PcmOut(rndVal + HSum64(s2));
+		pcm++;
+	}
+}
+
+void PolyphaseStereoSse(short *pcm, int *vbuf, const int *coefBase)
+{
+	int i, x;
+	const int *coef;
+	int *vb1;
+	__m128i s1L, s2L, s1R, s2R;
+	Word64 rndVal;
+
+	rndVal = (Word64)( 1 << (DEF_NFRACBITS - 1 + (32 - CSHIFT)) );
+
+	/* special case, output sample 0 */
+	s1L = s1R = _mm_setzero_si128();
+	for (x = 0; x < 8; x += 2) {
+		Mac2(&s1L, NULL, vbuf,      coefBase, x);
+		Mac2(&s1R, NULL, vbuf + 32, coefBase, x);
+	}
+	pcm[0] = PcmOut(rndVal + HSum64(s1L));
+	pcm[1] = PcmOut(rndVal + HSum64(s1R));
+
+	/* special case, output sample 16 */
+	s1L = s1R = _mm_setzero_si128();
+	for (x = 0; x < 8; x += 2) {
+		Mac1(&s1L, vbuf + 64*16,      coefBase + 256, x);
+		Mac1(&s1R, vbuf + 64*16 + 32, coefBase + 256, x);
+	}
+	pcm[2*16 + 0] = PcmOut(rndVal + HSum64(s1L));
+	pcm[2*16 + 1] = PcmOut(rndVal + HSum64(s1R));
+
+	/* main convolution loop: s1 = samples 1, 2, 3, ... 15   s2 = samples 31, 30, ... 17 */
+	coef = coefBase + 16;
+	vb1 = vbuf + 64;
+	pcm += 2;
+
+	for (i = 15; i > 0; i--) {
+		s1L = s2L = s1R = s2R = _mm_setzero_si128();
+		for (x = 0; x < 8; x += 2) {
+			Mac2(&s1L, &s2L, vb1,      coef, x);
+			Mac2(&s1R, &s2R, vb1 + 32, coef, x);
+		}
+		coef += 16;
+		vb1 += 64;
+		pcm[0]         = PcmOut(rndVal + HSum64(s1L));
+		pcm[1]         = PcmOut(rndVal + HSum64(s1R));
+		pcm[2*2*i + 0] = PcmOut(rndVal + HSum64(s2L));
+		pcm[2*2*i + 1] = PcmOut(rndVal + HSum64(s2R));
+		pcm += 2;
+	}
+}
+
+/* MULSHIFT32 по четырём полосам */
+static __inline __m128i MulShift32x4(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epi32(a, b);
+	__m128i odd  = _mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_blend_epi16(_mm_srli_epi64(even, 32), odd, 0xCC);
+}
+
+static __inline __m128i Reverse(__m128i v)
+{
+	return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+/* AntiAlias (imdct.c): 8 бабочек на границу блоков, по четыре за раз */
+void AntiAliasSse(int *x, int nBfly)
+{
+	int k, h;
+	__m128i cs[2], ca[2];
+
+	/* csa[i] = {CSi, CAi} -> CS[0..7], CA[0..7] */
+	for (h = 0; h < 2; h++) {
+		__m128 p0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)csa[4*h + 0]));
+		__m128 p1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)csa[4*h + 2]));
+		cs[h] = _mm_castps_si128(_mm_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0)));
+		ca[h] = _mm_castps_si128(_mm_shuffle_ps(p0, p1, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+
+	for (k = nBfly; k > 0; k--) {
+		x += 18;
+		for (h = 0; h < 2; h++) {
+			/* a = x[-1-i], b = x[i], i = 4h..4h+3 */
+			int *pa = x - 4 - 4*h;
+			int *pb = x + 4*h;
+			__m128i a = Reverse(_mm_loadu_si128((const __m128i *)pa));
+			__m128i b = _mm_loadu_si128((const __m128i *)pb);
+			__m128i na = _mm_sub_epi32(MulShift32x4(cs[h], a), MulShift32x4(ca[h], b));
+			__m128i nb = _mm_add_epi32(MulShift32x4(cs[h], b), MulShift32x4(ca[h], a));
+			_mm_storeu_si128((__m128i *)pa, Reverse(_mm_slli_epi32(na, 1)));
+			_mm_storeu_si128((__m128i *)pb, _mm_slli_epi32(nb, 1));
+		}
+	}
+}
+
+#else
+
+int MP3SetSimd(int enable)
+{
+	(void)enable;
+	return 0;
+}
+
+#endif	/* HELIX_X86_SIMD */